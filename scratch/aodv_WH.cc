@@ -101,6 +101,8 @@ private:
 
   //追加部分
   AodvHelper aodv;
+  //ワームホールのトンネル（WH1とWH2の間）
+  Ptr<WormholeAttackHelper> wormhole;
   PointToPointHelper point;
 
   YansWifiPhyHelper wifiPhy;
@@ -526,17 +528,13 @@ AodvExample::CreateDevices ()
   wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue ("OfdmRate6Mbps"), "RtsCtsThreshold", UintegerValue (0));
   devices = wifi.Install (wifiPhy, wifiMac, nodes); 
 
-  PointToPointHelper pointToPoint;
-  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
-  pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
-
-  // NetDeviceContainer devices;
-  mal_devices = pointToPoint.Install (malicious);
+  wormhole = CreateObject<WormholeAttackHelper> ();
+  mal_devices = wormhole->Install (malicious);
 
   if (pcap)
     {
       wifiPhy.EnablePcapAll (std::string ("aodv"));
-      pointToPoint.EnablePcapAll (std::string ("point-to-point"));
+      wormhole->EnablePcap (std::string ("point-to-point"));
     }
 }
 
@@ -546,6 +544,7 @@ AodvExample::InstallInternetStack ()
 
   // you can configure AODV attributes here using aodv.Set(name, value)
   InternetStackHelper stack;
+  aodv.SetWormholeOracle (wormhole->GetOracle ());
   stack.SetRoutingHelper (aodv); // has effect on the next Install ()
   stack.Install (nodes);
 
@@ -555,8 +554,8 @@ AodvExample::InstallInternetStack ()
   address.SetBase ("10.0.0.0", "255.0.0.0","0.0.0.1");
   interfaces = address.Assign (devices);
 
-   address.SetBase ("10.1.2.0", "255.255.255.0", "0.0.0.1");
-   Ipv4InterfaceContainer mal_ifcont = address.Assign (mal_devices);
+  //トンネルのアドレスを割り当て，検知の正解データに登録する
+  wormhole->AssignAddresses ();
 
   if (printRoutes)
     {
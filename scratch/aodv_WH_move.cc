@@ -71,6 +71,9 @@ public:
 
   int Getiteration() const { return iteration; }
 
+  //シミュレーション全体の検知統計を返す関数
+  Ptr<aodv::DetectionStatistics> GetStatistics () const { return statistics; }
+
   AodvExample ();
   /**
    * \brief Configure script parameters
@@ -125,7 +128,12 @@ private:
   // int rand = std::rand(); // 1から1000のランダムな整数を生成
 
   //追加部分
+  //全ノードで共有する検知統計
+  Ptr<aodv::DetectionStatistics> statistics;
+
   AodvHelper aodv;
+  //ワームホールのトンネル（WH1とWH2の間）
+  Ptr<WormholeAttackHelper> wormhole;
   PointToPointHelper point;
 
   YansWifiPhyHelper wifiPhy;
@@ -237,92 +245,8 @@ int main (int argc, char **argv)
 
 
   //----------------------   ログ取得   --------------------
-
-  //各メッセージのバイト数を保存する変数
-  double RREQ_num = 0;
-  double RREP_num = 0;
-  double WHD_Message_num = 0;
-  double WHR_Message_num = 0;
-
-  ///通常ノードを対象とした判定回数
-  double NJ_num = 0;
-  //WHノードを対象とした判定回数
-  double WHJ_num = 0;
-  //WHノードを誤検知した回数
-  double WHDM_num = 0;
-  //正常なノードをWHノードと誤検知した回数
-  double DM_num = 0;
-  //経路作成時間の合計
-  Time RT_num = Time(0);
-  //経路作成時間を計測した回数
-  int time_count = 0;
-
-  Time min_time = Time(0);
-  Time max_time = Time(0);
-
-
-    //ログ取得
-    // 各ノードのAODVルーティングプロトコルインスタンスを取得し、トレースを設定
-    for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it)
-    {
-        Ptr<Node> node = *it;
-        RREQ_num = RREQ_num + node->GetRREQ();
-        RREP_num = RREP_num + node->GetRREP();
-        WHD_Message_num = WHD_Message_num + node->GetWHC();
-        WHR_Message_num = WHR_Message_num + node->GetWHE();
-        //DC_num = DC_num + node->GetDetCount();   //検知を行った回数
-
-         //通常ノードを対象とした検知回数
-        NJ_num = NJ_num + node->Get_Nomal_Node_Judge_Count();
-        //WHノードを対象とした検知回数
-        WHJ_num = WHJ_num + node->Get_WHJudge_Count();
-        //WHノードを正常ノードとご検知した回数
-        WHDM_num = WHDM_num + node->Get_WHDetection_miss_Count();
-
-        std::vector<uint32_t> send_id = node->GetSendID();
-        std::vector<uint32_t> recv_id = node->GetRecvID();
-
-        //送信したIDと受信したIDを比較し，受信IDが存在しなかった場合，正常ノードを誤検知したと判定
-        for(size_t i = 0; i < send_id.size(); ++i)
-        {
-            auto find = std::find(recv_id.begin(), recv_id.end(), send_id[i]);
-
-            if(find == recv_id.end() /*&& i != send_id.size() - 1*/)
-            {
-                //送信したIDのメッセージを受信していない場合、誤検知としてカウント
-                DM_num = DM_num + 1;
-            }
-        }
-
-        //経路作成時間の合計を取得
-        for(size_t i = 0; i < node->Get_Routing_Time().size(); i++)
-        {
-            RT_num = RT_num + node->Get_Routing_Time()[i];
-
-            //最小の経路作成時間を取得
-            if(min_time == Time(0))
-            {
-                min_time = node->Get_Routing_Time()[i];
-            }
-            else
-            {
-                min_time = std::min(min_time, node->Get_Routing_Time()[i]);
-            }
-
-            //最大の経路作成時間を取得
-            if(max_time == Time(0))
-            {
-                max_time = node->Get_Routing_Time()[i];
-            }
-            else
-            {
-                max_time = std::max(max_time, node->Get_Routing_Time()[i]);
-            }
-        }
-
-        //経路作成時間を計測した回数
-        time_count = time_count + node->Get_Routing_Time_Count();
-    }
+  //各ノードの値はシミュレーション中に集計済みなので，ここではノードを走査しない
+  aodv::DetectionSummary summary = test.GetStatistics ()->GetSummary ();
 
     //結果を保存するためのファイルに書き込み
     std::ofstream ofs(test.GetResultFile(), std::ios::trunc);
@@ -333,33 +257,33 @@ int main (int argc, char **argv)
     }
 
     ofs << "シード値：" << test.Getiteration() << std::endl;
-    ofs << "RREQの合計バイト数：" << RREQ_num << std::endl;
-    ofs << "RREPの合計バイト数：" << RREP_num << std::endl;
-    ofs << "WHDの合計バイト数：" << WHD_Message_num << std::endl;
-    ofs << "WHRの合計バイト数：" << WHR_Message_num  << "\n" << std::endl;
-
-    ofs << "通常ノードを対象とした判定回数：" << NJ_num << std::endl;
-    ofs << "WHノードを対象とした判定回数：" << WHJ_num << std::endl;
-    ofs << "WHノードを正常に検知した回数：" << WHJ_num - WHDM_num << std::endl;
-    ofs << "正常なノードをWHノードと誤検知した回数：" << DM_num << std::endl;
-    ofs << "経路作成時間の合計：" << RT_num.GetSeconds() << std::endl;
-    ofs << "経路作成時間を計測した回数：" << time_count << "\n" << std::endl;
+    ofs << "RREQの合計バイト数：" << summary.rreqBytes << std::endl;
+    ofs << "RREPの合計バイト数：" << summary.rrepBytes << std::endl;
+    ofs << "WHDの合計バイト数：" << summary.whcsBytes << std::endl;
+    ofs << "WHRの合計バイト数：" << summary.whceBytes  << "\n" << std::endl;
+
+    ofs << "通常ノードを対象とした判定回数：" << summary.normalJudgements << std::endl;
+    ofs << "WHノードを対象とした判定回数：" << summary.wormholeJudgements << std::endl;
+    ofs << "WHノードを正常に検知した回数：" << summary.wormholesDetected << std::endl;
+    ofs << "正常なノードをWHノードと誤検知した回数：" << summary.falsePositives << std::endl;
+    ofs << "経路作成時間の合計：" << summary.routeSetupTotal.GetSeconds() << std::endl;
+    ofs << "経路作成時間を計測した回数：" << summary.routeSetups << "\n" << std::endl;
 
     ofs << "---------------------------------------------------------------\n" << std::endl;
 
-    ofs << "WH攻撃の検知率："<< (WHJ_num - WHDM_num) / WHJ_num << std::endl;
-    ofs << "通常ノードをWH攻撃と誤検知した割合：" << DM_num / NJ_num << std::endl;
-    ofs << "1回の判定にかかる検知コスト：" << (WHD_Message_num + WHR_Message_num) / (NJ_num + WHJ_num) << std::endl;
+    ofs << "WH攻撃の検知率："<< summary.detectionRate << std::endl;
+    ofs << "通常ノードをWH攻撃と誤検知した割合：" << summary.falsePositiveRate << std::endl;
+    ofs << "1回の判定にかかる検知コスト：" << summary.costPerJudgement << std::endl;
 
-    if(time_count == 0)
+    if(summary.routeSetups == 0)
     {
         ofs << "RREPがとどいていません。" << std::endl;
     }
     else
     {
-        ofs << "経路作成時間の平均：" << RT_num.GetSeconds() / time_count << std::endl;
-        ofs << "経路作成時間の最小値：" << min_time << std::endl;
-        ofs << "経路作成時間の最大値：" << max_time << std::endl;
+        ofs << "経路作成時間の平均：" << summary.routeSetupMean.GetSeconds() << std::endl;
+        ofs << "経路作成時間の最小値：" << summary.routeSetupMin << std::endl;
+        ofs << "経路作成時間の最大値：" << summary.routeSetupMax << std::endl;
     }
 
 
@@ -609,17 +533,13 @@ AodvExample::CreateDevices ()
   wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue ("OfdmRate6Mbps"), "RtsCtsThreshold", UintegerValue (0));
   devices = wifi.Install (wifiPhy, wifiMac, nodes); 
 
-  PointToPointHelper pointToPoint;
-  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
-  pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
-
-  // NetDeviceContainer devices;
-  mal_devices = pointToPoint.Install (malicious);
+  wormhole = CreateObject<WormholeAttackHelper> ();
+  mal_devices = wormhole->Install (malicious);
 
   if (pcap)
     {
       wifiPhy.EnablePcapAll (std::string ("aodv"));
-      pointToPoint.EnablePcapAll (std::string ("point-to-point"));
+      wormhole->EnablePcap (std::string ("point-to-point"));
     }
 }
 
@@ -628,7 +548,9 @@ AodvExample::InstallInternetStack ()
 {
 
   // you can configure AODV attributes here using aodv.Set(name, value)
+  statistics = aodv.EnableDetectionStatistics ();
   InternetStackHelper stack;
+  aodv.SetWormholeOracle (wormhole->GetOracle ());
   stack.SetRoutingHelper (aodv); // has effect on the next Install ()
   stack.Install (nodes);
 
@@ -638,8 +560,8 @@ AodvExample::InstallInternetStack ()
   address.SetBase ("10.0.0.0", "255.0.0.0","0.0.0.1");
   interfaces = address.Assign (devices);
 
-   address.SetBase ("10.1.2.0", "255.255.255.0", "0.0.0.1");
-   Ipv4InterfaceContainer mal_ifcont = address.Assign (mal_devices);
+  //トンネルのアドレスを割り当て，検知の正解データに登録する
+  wormhole->AssignAddresses ();
 
   if (printRoutes)
     {
@@ -0,0 +1,692 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 IITP RAS
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * 検知実験（aodv_WH_3）のシナリオ本体．
+ * aodv_WH_3 と aodv_WH_sweep の両方からインクルードして使う．
+ */
+
+#ifndef AODV_WH_SCENARIO_H
+#define AODV_WH_SCENARIO_H
+
+#include <iostream>
+#include <cmath>
+#include "ns3/aodv-module.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/v4ping-helper.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/netanim-module.h"
+#ifdef NS3_MTP
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
+#include <random>
+#include <fstream>
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * \ingroup aodv-examples
+ * \ingroup examples
+ * \brief Test script.
+ * 
+ * This script creates 1-dimensional grid topology and then ping last node from the first one:
+ * 
+ * [10.0.0.1] <-- step --> [10.0.0.2] <-- step --> [10.0.0.3] <-- step --> [10.0.0.4]
+ * 
+ * ping 10.0.0.4
+ *
+ * When 1/3 of simulation time has elapsed, one of the nodes is moved out of
+ * range, thereby breaking the topology.  By default, this will result in
+ * only 34 of 100 pings being received.  If the step size is reduced
+ * to cover the gap, then all pings can be received.
+ */
+class AodvExample 
+{
+public:
+
+  //保存用のファイルを返す関数
+  std::string GetResultFile() const { return result_file; }
+
+  int Getiteration() const { return iteration; }
+
+  //シミュレーション全体の検知統計を返す関数
+  Ptr<aodv::DetectionStatistics> GetStatistics () const { return statistics; }
+
+  //スイープ実行用：コマンドラインを介さずにパラメータを設定する関数
+  void SetSize (uint32_t s) { size = s; }
+  void SetWHSize (int s) { WH_size = s; }
+  void SetEndDistance (int d) { end_distance = d; }
+  void SetTotalTime (double t) { totalTime = t; }
+  void SetResultFile (std::string f) { result_file = f; }
+  void SetIteration (int i) { iteration = i; }
+  void SetPcap (bool p) { pcap = p; }
+  void SetDetectionLog (std::string f) { detection_log = f; }
+  void SetThreads (uint32_t t) { threads = t; }
+  //バッチ実行用のプロファイル（アニメーション・pcap・経路表示・ping表示を無効化）
+  void SetBatch (bool b) { batch = b; if (b) { pcap = false; printRoutes = false; } }
+
+  AodvExample ();
+  /**
+   * \brief Configure script parameters
+   * \param argc is the command line argument count
+   * \param argv is the command line arguments
+   * \return true on successful configuration
+  */
+  bool Configure (int argc, char **argv);
+  /// Run simulation
+  void Run ();
+  /**
+   * Report results
+   * \param os the output stream
+   */
+  void Report (std::ostream & os);
+
+private:
+
+  // parameters
+  /// Number of nodes
+  uint32_t size;
+  // parameters
+  /// Number of around nodes
+  uint32_t size_a;
+  /// Distance between nodes, meters
+  double step;
+  /// Simulation time, seconds
+  double totalTime;
+  /// Write per-device PCAP traces if true
+  bool pcap;
+  /// Print routes if true
+  bool printRoutes;
+
+  //結果を保存するファイル
+  std::string result_file;
+
+  //結果を保存するモード
+  int result_mode;
+
+  //WHリンクの長さ
+  int WH_size;
+
+  //検知待機時間
+  double wait_time;
+
+  //エンド間の距離
+  int end_distance;
+
+  //シード値を決定するためのイテレーション
+  int iteration;
+
+  //検知イベントログの出力先（空の場合は記録しない）
+  std::string detection_log;
+
+  //AODVのバイナリイベントログの出力先（空の場合は記録しない）
+  std::string binlog;
+
+  //並列実行のスレッド数（0の場合は通常の逐次シミュレータ）
+  uint32_t threads;
+
+  //バッチ実行（トレース出力を一切行わない）
+  bool batch;
+
+  //アニメーション（NetAnim）の出力先
+  std::string anim_file;
+  //アニメーションに記録するパケットの割合（0〜1）
+  double anim_sample;
+  //AODVの制御パケットのみをアニメーションに記録する
+  bool anim_control;
+  //アニメーションをgzip圧縮して出力する
+  bool anim_gzip;
+  //アニメーション（バッチ実行時は作成しない）
+  AnimationInterface *anim;
+
+  // int rand = std::rand(); // 1から1000のランダムな整数を生成
+
+  //全ノードで共有する検知統計
+  Ptr<aodv::DetectionStatistics> statistics;
+
+  //ワームホール（トンネル数などは ns3::WormholeAttackHelper の属性で指定する）
+  Ptr<WormholeAttackHelper> wormhole;
+
+  //追加部分
+  AodvHelper aodv;
+  PointToPointHelper point;
+
+  YansWifiPhyHelper wifiPhy;
+
+  // network
+  /// nodes used in the example
+  
+ 
+  //追加部分
+  NodeContainer not_malicious;
+  NodeContainer malicious;
+  //ここまで
+
+  /// devices used in the example
+  NetDeviceContainer devices, mal_devices;
+  /// interfaces used in the example
+  Ipv4InterfaceContainer interfaces;
+
+private:
+  /// Create the nodes
+  void CreateNodes ();
+  /// Create the devices
+  void CreateDevices ();
+  /// Create the network
+  void InstallInternetStack ();
+  /// Create the simulation applications
+  void InstallApplications ();
+  /// ノード作成前に並列シミュレータを選択し，パーティションを設定する
+  void SetupParallel ();
+  /// デバイス作成後に先読み時間（最小伝搬遅延）を設定する
+  void SetLookahead ();
+  /**
+   * トンネルの端点のノードIDを返す（0本目はノード1, 2，以降はノード4, 5, 6, 7, ...．ノード3は協力者）
+   * \param tunnel トンネルの番号
+   * \param side 端点（0または1）
+   * \return ノードID
+   */
+  static uint32_t TunnelEndpoint (uint32_t tunnel, uint32_t side) { return tunnel == 0 ? 1 + side : 2 + 2 * tunnel + side; }
+};
+
+NodeContainer nodes;
+
+//AODVの制御パケット（TypeHeaderを持つパケット）かどうかを判定する
+static bool
+IsAodvControlPacket (Ptr<const Packet> p)
+{
+  PacketMetadata::ItemIterator i = p->BeginItem ();
+  while (i.HasNext ())
+    {
+      PacketMetadata::Item item = i.Next ();
+      if (item.type == PacketMetadata::Item::HEADER && item.tid == aodv::TypeHeader::GetTypeId ())
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+AodvExample::AodvExample () :
+  size (300),
+  size_a (5),
+  step (50),
+  totalTime (20),
+  pcap (true),
+  printRoutes (false),
+  result_file("deff/p-log5.txt"), //結果を保存するファイル
+  WH_size(250),
+  // wait_time(0.5), //検知待機時間
+  end_distance(600), //エンド間の距離
+  iteration(1), //イテレーション
+  threads(0),
+  batch(false),
+  anim_file("wormhole.xml"),
+  anim_sample(1.0),
+  anim_control(false),
+  anim_gzip(false),
+  anim(0)
+{
+}
+
+bool
+AodvExample::Configure (int argc, char **argv)
+{
+  // Enable AODV logs by default. Comment this if too noisy
+  // LogComponentEnable("AodvRoutingProtocol", LOG_LEVEL_ALL);
+  // LogComponentEnable ("UdpEchoClientApplication", LOG_LEVEL_ALL);
+  // LogComponentEnable ("UdpEchoServerApplication", LOG_LEVEL_ALL);
+
+  CommandLine cmd;
+
+  cmd.AddValue ("pcap", "Write PCAP traces.", pcap);
+  cmd.AddValue ("printRoutes", "Print routing table dumps.", printRoutes);
+  cmd.AddValue ("size", "Number of nodes.", size);
+  cmd.AddValue ("time", "Simulation time, s.", totalTime);
+  cmd.AddValue ("step", "Grid step, m", step);
+
+  cmd.AddValue("result_file", "result file", result_file); //結果表示ようのファイル名を取得
+  cmd.AddValue("WH_size", "WH size", WH_size); //WHの長さ
+  //cmd.AddValue("wait_time", "Detection wait time", wait_time); //検知待機時間
+  cmd.AddValue("end_distance", "end distance", end_distance); //エンド間の距離
+  cmd.AddValue("iteration", "iteration", iteration); //イテレーション
+  cmd.AddValue("detection_log", "Detection event log file (.bin for binary, disabled if empty)", detection_log); //検知イベントログ
+  cmd.AddValue("binlog", "AODV binary event log file, decoded by decode-binary-log (disabled if empty)", binlog); //バイナリイベントログ
+  cmd.AddValue("threads", "Number of simulation threads (0: sequential, needs --enable-mtp)", threads); //並列実行のスレッド数
+  cmd.AddValue("tunnels", "ns3::WormholeAttackHelper::Tunnels"); //ワームホールのトンネル数
+  cmd.AddValue("whcs_aggregation", "ns3::aodv::RoutingProtocol::WHCheckAggregation"); //WHCSをまとめて送信
+  cmd.AddValue("passive_detection", "ns3::aodv::RoutingProtocol::PassiveDetection"); //疑わしいリンクだけWHCSで検知
+  cmd.AddValue("compact_encoding", "ns3::aodv::RoutingProtocol::CompactEncoding"); //WHCS・WHCEを圧縮形式で送信
+  cmd.AddValue("link_cache", "ns3::YansWifiChannel::PairwiseCache"); //リンクごとの受信電力と遅延をキャッシュ
+  cmd.AddValue("batch", "Batch profile: no animation, pcap, route dumps nor ping output", batch); //バッチ実行
+  cmd.AddValue("anim_file", "NetAnim output file", anim_file); //アニメーションの出力先
+  cmd.AddValue("anim_sample", "Fraction of the packets written to the animation", anim_sample); //記録するパケットの割合
+  cmd.AddValue("anim_control", "Write only AODV control packets to the animation", anim_control); //制御パケットのみ記録
+  cmd.AddValue("anim_gzip", "Compress the animation with gzip", anim_gzip); //gzip圧縮
+
+  //取得した値を確認
+  std::cout << "result_file: " << result_file << std::endl;
+  std::cout << "WH_size: " << WH_size << std::endl;
+
+  if(end_distance < WH_size + 100)
+  {
+    std::cerr << "エンド間の距離がWHリンクの長さよりも短いです。" << std::endl;
+    return false;
+  }
+
+  // int rand = std::rand() ; // 1から1000のランダムな整数を生成
+  std::random_device randomseed;
+  int rand = randomseed();
+  SeedManager::SetSeed (rand);
+
+  std::cout << "シード値: " << rand << std::endl;
+
+  // sleep(100);
+
+  cmd.Parse (argc, argv);
+  SetBatch (batch);
+  return true;
+}
+
+void
+AodvExample::Run ()
+{
+//  Config::SetDefault ("ns3::WifiRemoteStationManager::RtsCtsThreshold", UintegerValue (1)); // enable rts cts all the time.
+  wormhole = CreateObject<WormholeAttackHelper> ();
+  SetupParallel ();
+  CreateNodes ();
+  printf("ノードを作成\n");
+  CreateDevices ();
+  printf("デバイスを作成\n");
+  SetLookahead ();
+  InstallInternetStack ();
+  InstallApplications ();
+
+  //AODVのイベントをスレッドごとのリングに記録し，終了後にまとめて書き出す
+  if (!binlog.empty ())
+    {
+      BinaryLog::Enable ("AodvRoutingProtocol");
+    }
+
+  //トレースはデバイスに接続されるので，全デバイスの作成後にアニメーションを作成する
+  //（シミュレーション終了までトレースが接続されるのでメンバとして保持する）
+  if (!batch)
+    {
+      anim = new AnimationInterface (anim_file);
+      anim->EnablePacketMetadata (true);
+      anim->EnableCompression (anim_gzip);
+      anim->SetPacketSampling (anim_sample);
+      if (anim_control)
+        {
+          anim->SetPacketFilter (MakeCallback (&IsAodvControlPacket));
+        }
+    }
+
+  std::cout << "Starting simulation for " << totalTime << " s ...\n";
+
+  Simulator::Stop (Seconds (totalTime));
+
+  //追加部分
+  //FlowMonitorHelper flowMonitor;
+  // auto monitor = flowMonitor.InstallAll();
+
+  //追加部分
+  //AsciiTraceHelper ascii;
+  // aodv.EnablePcapAll ("test_aodv");
+  //point.EnableAsciiAll (ascii.CreateFileStream("test_point.tr"));
+
+   //traceファイルの設定
+    // AsciiTraceHelper ascii;
+    // Ptr<OutputStreamWrapper> stream;  // stream:=(ファイルストリーム).
+
+    // // 初回のときにストリーム作成．
+    // if(!stream) {
+    //     std::string filename = "packet1.tr";
+    //     stream = ascii.CreateFileStream(filename,std::ios::app);
+    // }
+
+    // //trに書き込む
+    // *stream->GetStream()<< Node_ID<<" "<<sourceid << " "<<sourcetime<<" "<<sourcepos.x <<" "<<sourcepos.y<<" "<<beforehopid <<" "<<beforehoptime << " " <<beforehoppos.x <<" " << beforehoppos.y <<" " <<senderid << " "<<sendertime<<" " << senderpos.x << " "<<senderpos.y << " "<< msg <<std::endl;     // パケットの中身．
+
+    // Packet::EnableChecking();
+    // Packet::EnablePrinting();
+
+  //  FlowMonitorHelper flowMonitor;
+  //   auto monitor = flowMonitor.InstallAll();
+
+  //   wifiPhy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
+  //   wifiPhy.EnablePcapAll(/*m_prefix + */"-packet");
+  //   wifiPhy.EnableAsciiAll(/*m_prefix +*/  "-packet");
+
+    // AsciiTraceHelper asc;
+    // Ipv4RoutingHelper::PrintRoutingTableAllEvery(Seconds(1.0), asc.CreateFileStream(/*m_prefix + */"-rtable.tr"));
+
+  
+
+
+  Simulator::Run ();
+  //トレースを切り離してファイルを閉じる
+  delete anim;
+  anim = 0;
+  if (!binlog.empty () && !BinaryLog::Dump (binlog))
+    {
+      std::cerr << "バイナリログを書き出せません: " << binlog << std::endl;
+    }
+  Simulator::Destroy ();
+
+
+
+  // monitor->CheckForLostPackets ();
+  // Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowmon.GetClassifier ());
+  // FlowMonitor::FlowStatsContainer stats = monitor->GetFlowStats ();
+  // for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+  //   {
+  //     Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow (i->first);
+
+  //     std::cout << "Flow " << i->first  << " (" << t.sourceAddress << " -> " << t.destinationAddress << ")\n";
+  //     std::cout << "  Tx Packets: " << i->second.txPackets << "\n";
+  //     std::cout << "  Tx Bytes:   " << i->second.txBytes << "\n";
+  //     std::cout << "  TxOffered:  " << i->second.txBytes * 8.0 / 9.0 / 1000 / 1000  << " Mbps\n";
+  //     std::cout << "  Rx Packets: " << i->second.rxPackets << "\n";
+  //     std::cout << "  Rx Bytes:   " << i->second.rxBytes << "\n";
+  //     std::cout << "  Throughput: " << i->second.rxBytes * 8.0 / 9.0 / 1000 / 1000  << " Mbps\n";
+  //   }
+}
+
+void
+AodvExample::Report (std::ostream &)
+{ 
+}
+
+void
+AodvExample::SetupParallel ()
+{
+  if (threads == 0)
+    {
+      return;
+    }
+#ifdef NS3_MTP
+  //Simulator の最初の呼び出しより前に実装を切り替える
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (threads));
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+
+  //トンネルの端点は先読み時間より短い遅延のイベントを交換するため，
+  //ノード作成前（ノードID = 作成順）に同じパーティションへ割り当てる
+  UintegerValue tunnels;
+  wormhole->GetAttribute ("Tunnels", tunnels);
+  for (uint32_t k = 0; k < tunnels.Get (); ++k)
+    {
+      impl->SetPartition (TunnelEndpoint (k, 1), impl->GetPartition (TunnelEndpoint (k, 0)));
+    }
+  std::cout << "Parallel simulation with " << impl->GetNPartitions () << " threads" << std::endl;
+#else
+  std::cerr << "--threads を使うには --enable-mtp を付けて configure してください。逐次実行します。" << std::endl;
+  threads = 0;
+#endif
+}
+
+void
+AodvExample::SetLookahead ()
+{
+#ifdef NS3_MTP
+  if (threads == 0)
+    {
+      return;
+    }
+  //無線区間の最小伝搬遅延が，パーティション間のイベントの最小遅延となる
+  Ptr<YansWifiChannel> channel = DynamicCast<YansWifiChannel> (devices.Get (0)->GetChannel ());
+  Time lookahead = std::max (channel->GetMinDelay (), TimeStep (1));
+  Simulator::GetImplementation ()->SetAttribute ("Lookahead", TimeValue (lookahead));
+  std::cout << "Lookahead: " << lookahead.As (Time::NS) << std::endl;
+#endif
+}
+
+void
+AodvExample::CreateNodes ()
+{
+
+  //ルートノードの作製
+  std::cout << "Creating " << (unsigned)size << " nodes " << step << " m apart.\n";
+  nodes.Create (size);
+  // Name nodes
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      std::ostringstream os;
+      os << "node-" << i;
+      Names::Add (os.str (), nodes.Get (i));
+    }
+  // Create static grid
+  // MobilityHelper mobility;
+  // mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+  //                                "MinX", DoubleValue (0.0),
+  //                                "MinY", DoubleValue (0.0),
+  //                                "DeltaX", DoubleValue (step),
+  //                                "DeltaY", DoubleValue (10000),
+  //                                "GridWidth", UintegerValue (size),
+  //                                "LayoutType", StringValue ("RowFirst"));
+  // mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  // mobility.Install (nodes);
+
+ MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+                                  "X", StringValue("ns3::UniformRandomVariable[Min=0|Max=800]"),
+                                  "Y", StringValue("ns3::UniformRandomVariable[Min=0|Max=800]")
+                                 ); 
+  
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+  
+//   not_malicious.Add(nodes.Get(0));        //src
+//   not_malicious.Add(nodes.Get(size-1));  //dst
+  // not_malicious.Add(nodes.Get(3));
+  // not_malicious.Add(nodes.Get(4));
+  // not_malicious.Add(nodes.Get(5));
+//   malicious.Add(nodes.Get(1)); //WH1
+//   malicious.Add(nodes.Get(2));//WH2
+
+  AnimationInterface::SetConstantPosition (nodes.Get (0), 0, 400);
+  AnimationInterface::SetConstantPosition (nodes.Get (size-1), end_distance, 400);
+
+  //WHノードを配置
+  //AnimationInterface::SetConstantPosition (nodes.Get (1), 280, 280);
+  AnimationInterface::SetConstantPosition (nodes.Get (1), end_distance - WH_size - 110, 250);
+  AnimationInterface::SetConstantPosition (nodes.Get (2), end_distance - 110, 400);
+  //協力者ノードを配置
+  AnimationInterface::SetConstantPosition (nodes.Get (3), end_distance - 100, 400); //協力者1
+
+  //トンネルの端点（0本目はWH1, WH2）
+  UintegerValue tunnels;
+  wormhole->GetAttribute ("Tunnels", tunnels);
+  NS_ABORT_MSG_IF (tunnels.Get () > 0 && TunnelEndpoint (tunnels.Get () - 1, 1) >= size - 1,
+                   "Not enough nodes for " << tunnels.Get () << " tunnels");
+  for (uint32_t k = 0; k < tunnels.Get (); ++k)
+    {
+      malicious.Add (nodes.Get (TunnelEndpoint (k, 0)));
+      malicious.Add (nodes.Get (TunnelEndpoint (k, 1)));
+    }
+
+}
+
+void
+AodvExample::CreateDevices ()
+{
+  WifiMacHelper wifiMac;
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
+  wifiPhy.SetChannel (wifiChannel.Create ());
+
+  //送信電力と受信電力を設定
+  //送信電力と受信電力を設定
+  wifiPhy.Set("TxPowerStart", DoubleValue(24.7)); // 送信電力 20 dBm
+  wifiPhy.Set("TxPowerEnd", DoubleValue(24.7));
+
+  WifiHelper wifi;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager", "DataMode", StringValue ("OfdmRate6Mbps"), "RtsCtsThreshold", UintegerValue (0));
+  devices = wifi.Install (wifiPhy, wifiMac, nodes); 
+
+  //ワームホールのトンネル
+  mal_devices = wormhole->Install (malicious);
+
+  if (pcap)
+    {
+      wifiPhy.EnablePcapAll (std::string ("aodv"));
+      wormhole->EnablePcap (std::string ("point-to-point"));
+    }
+}
+
+void
+AodvExample::InstallInternetStack ()
+{
+
+  // you can configure AODV attributes here using aodv.Set(name, value)
+  if (!detection_log.empty ())
+    {
+      bool binary = detection_log.size () > 4
+        && detection_log.compare (detection_log.size () - 4, 4, ".bin") == 0;
+      aodv.EnableDetectionLog (detection_log, binary);
+    }
+  statistics = aodv.EnableDetectionStatistics ();
+  aodv.SetWormholeOracle (wormhole->GetOracle ());
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (aodv); // has effect on the next Install ()
+  stack.Install (nodes);
+
+  InternetStackHelper stack2;
+  //IDstack2.Install (malicious);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.0.0.0","0.0.0.1");
+  interfaces = address.Assign (devices);
+
+  //トンネルのアドレスを割り当て，検知の正解データに登録する
+  wormhole->AssignAddresses ();
+
+  if (printRoutes)
+    {
+      Ptr<OutputStreamWrapper> routingStream = Create<OutputStreamWrapper> ("aodv.routes", std::ios::out);
+      aodv.PrintRoutingTableAllAt (Seconds (8), routingStream);
+    }
+}
+
+void
+AodvExample::InstallApplications ()
+{
+  // UdpEchohelper udpecho (interfaces.GetAddress (size - 1));
+  // udpecho.SetAttribute ("Verbode", BooleanValue (true));
+  
+  // ApplicationContainer u = udpecho.Install (nodes.Get (0));
+  // p.Start (Seconds (0));
+  // p.Stop (Seconds (totalTime) - Seconds (0.001));
+
+  V4PingHelper ping (interfaces.GetAddress (size - 1));
+  ping.SetAttribute ("Verbose", BooleanValue (!batch));
+
+  ApplicationContainer p = ping.Install (nodes.Get (0));
+  p.Start (Seconds (0));
+  p.Stop (Seconds (totalTime) - Seconds (0.001));
+
+  // move node away
+  Ptr<Node> node = nodes.Get (size/2);
+  Ptr<MobilityModel> mob = node->GetObject<MobilityModel> ();
+  Simulator::Schedule (Seconds (totalTime/3), &MobilityModel::SetPosition, mob, Vector (1e5, 1e5, 1e5));
+}
+
+
+/**
+ * シミュレーション終了後に検知統計の集計結果を結果ファイルに書き込む
+ * \param test 実行したシナリオ
+ * \return 0: 成功, 1: 結果ファイルを開けなかった
+ */
+int
+WriteResult (const AodvExample &test)
+{
+  //----------------------   ログ取得   --------------------
+  //各ノードの値はシミュレーション中に集計済みなので，ここではノードを走査しない
+  aodv::DetectionSummary summary = test.GetStatistics ()->GetSummary ();
+
+    //結果を保存するためのファイルに書き込み
+    std::ofstream ofs(test.GetResultFile(), std::ios::trunc);
+
+    if (!ofs) {
+        std::cerr << "Error opening file!" << std::endl;
+        return 1;
+    }
+
+    ofs << "シード値：" << test.Getiteration() << std::endl;
+    ofs << "RREQの合計バイト数：" << summary.rreqBytes << std::endl;
+    ofs << "RREPの合計バイト数：" << summary.rrepBytes << std::endl;
+    ofs << "WHDの合計バイト数：" << summary.whcsBytes << std::endl;
+    ofs << "WHRの合計バイト数：" << summary.whceBytes  << "\n" << std::endl;
+
+    ofs << "通常ノードを対象とした判定回数：" << summary.normalJudgements << std::endl;
+    ofs << "WHノードを対象とした判定回数：" << summary.wormholeJudgements << std::endl;
+    ofs << "WHノードを正常に検知した回数：" << summary.wormholesDetected << std::endl;
+    ofs << "正常なノードをWHノードと誤検知した回数：" << summary.falsePositives << std::endl;
+    ofs << "経路作成時間の合計：" << summary.routeSetupTotal.GetSeconds() << std::endl;
+    ofs << "経路作成時間を計測した回数：" << summary.routeSetups << "\n" << std::endl;
+
+    ofs << "---------------------------------------------------------------\n" << std::endl;
+
+    ofs << "WH攻撃の検知率："<< summary.detectionRate << std::endl;
+    ofs << "通常ノードをWH攻撃と誤検知した割合：" << summary.falsePositiveRate << std::endl;
+    ofs << "1回の判定にかかる検知コスト：" << summary.costPerJudgement << std::endl;
+
+    if(summary.routeSetups == 0)
+    {
+        ofs << "RREPがとどいていません。" << std::endl;
+    }
+    else
+    {
+        ofs << "経路作成時間の平均：" << summary.routeSetupMean.GetSeconds() << std::endl;
+        ofs << "経路作成時間の最小値：" << summary.routeSetupMin << std::endl;
+        ofs << "経路作成時間の最大値：" << summary.routeSetupMax << std::endl;
+        ofs << "経路作成時間のp50：" << summary.routeSetupP50.GetSeconds() << std::endl;
+        ofs << "経路作成時間のp90：" << summary.routeSetupP90.GetSeconds() << std::endl;
+        ofs << "経路作成時間のp99：" << summary.routeSetupP99.GetSeconds() << std::endl;
+        ofs << "経路作成時間のp999：" << summary.routeSetupP999.GetSeconds() << std::endl;
+    }
+
+    //WHCSの送信からWHCEの受信までの時間（検知完了までの時間）
+    ofs << "WHCEが返ってきた判定回数：" << summary.checksCompleted << std::endl;
+    if(summary.checksCompleted != 0)
+    {
+        ofs << "検知完了時間の平均：" << summary.checkLatencyMean.GetSeconds() << std::endl;
+        ofs << "検知完了時間のp50：" << summary.checkLatencyP50.GetSeconds() << std::endl;
+        ofs << "検知完了時間のp90：" << summary.checkLatencyP90.GetSeconds() << std::endl;
+        ofs << "検知完了時間のp99：" << summary.checkLatencyP99.GetSeconds() << std::endl;
+        ofs << "検知完了時間のp999：" << summary.checkLatencyP999.GetSeconds() << std::endl;
+        ofs << "検知完了時間の最大値：" << summary.checkLatencyMax.GetSeconds() << std::endl;
+    }
+    //パッシブ検知でWHCSを送らずに判定した回数（判定回数に含まれる）
+    if(summary.uncheckedJudgements != 0)
+    {
+        ofs << "WHCSを送らずに判定した回数：" << summary.uncheckedJudgements << std::endl;
+    }
+
+  return 0;
+}
+
+#endif /* AODV_WH_SCENARIO_H */
@@ -0,0 +1,328 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * aodv_WH_test.sh / aodv_WH_result.sh のパラメータスイープを1プロセスから実行する．
+ *
+ * ns-3 のシミュレータはプロセス内で1つしか持てないため，各試行は fork した
+ * 子プロセスで実行する．waf の起動は1回だけで，同時に実行する試行数は
+ * --jobs（既定値はマシンのコア数）で決まる．
+ *
+ * 例：
+ *   ./waf --run "aodv_WH_sweep --sizes=600 --WH_sizes=150,200,250,300,350
+ *                --end_distances=500,600,700,800 --runs=20 --time=40"
+ *
+ * 結果の配置は従来のシェルスクリプトと同じ（<out>/node_<size>/<size>_WH<w>/packet_num_<i>.txt）．
+ * --tunnels でワームホールのトンネル数を複数指定した場合は，1本以外のトンネル数の結果を
+ * <out>/node_<size>_K<k>/ 以下に置く．
+ * 加えて，1試行につき1行の記録を <out>/sweep.csv に出力する．
+ */
+
+#include "aodv_WH_scenario.h"
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("AodvWHSweep");
+
+/// 1回の試行の設定
+struct SweepJob
+{
+  uint32_t size;            ///< ノード数
+  int whSize;               ///< WHリンクの長さ
+  int endDistance;          ///< エンド間の距離
+  int iteration;            ///< イテレーション（RNGのラン番号にも使う）
+  uint32_t tunnels;         ///< ワームホールのトンネル数
+  std::string resultFile;   ///< 評価結果を出力するファイル
+  std::string workDir;      ///< pcap やログなど，試行ごとの副産物を置くディレクトリ
+};
+
+/// "150,200,250" のようなカンマ区切りの文字列を数値のリストに変換する
+static std::vector<int>
+ParseList (const std::string &s)
+{
+  std::vector<int> values;
+  std::istringstream iss (s);
+  std::string token;
+  while (std::getline (iss, token, ','))
+    {
+      if (!token.empty ())
+        {
+          values.push_back (std::atoi (token.c_str ()));
+        }
+    }
+  return values;
+}
+
+/// ディレクトリを作成する（既に存在する場合は何もしない）
+static void
+MakeDir (const std::string &path)
+{
+  std::string partial;
+  std::istringstream iss (path);
+  std::string token;
+  if (!path.empty () && path[0] == '/')
+    {
+      partial = "/";
+    }
+  while (std::getline (iss, token, '/'))
+    {
+      if (token.empty ())
+        {
+          continue;
+        }
+      partial += token + "/";
+      if (mkdir (partial.c_str (), 0755) != 0 && errno != EEXIST)
+        {
+          NS_FATAL_ERROR ("Unable to create directory " << partial << ": " << std::strerror (errno));
+        }
+    }
+}
+
+static bool
+DirExists (const std::string &path)
+{
+  struct stat st;
+  return stat (path.c_str (), &st) == 0 && S_ISDIR (st.st_mode);
+}
+
+/**
+ * 子プロセスで1回の試行を実行する．戻らない．
+ * \param job 試行の設定
+ * \param seed RNG のシード値（全試行で共通）
+ * \param time シミュレーション時間
+ * \param pcap pcap を出力するかどうか
+ * \param detectionLog 検知イベントログ（作業ディレクトリの detection.bin）を出力するかどうか
+ */
+static void
+RunJob (const SweepJob &job, uint32_t seed, double time, bool pcap, bool detectionLog)
+{
+  //wormhole.xml や pcap が他の試行と衝突しないように作業ディレクトリを分ける
+  if (chdir (job.workDir.c_str ()) != 0)
+    {
+      _exit (2);
+    }
+  int fd = open ("log.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd >= 0)
+    {
+      dup2 (fd, STDOUT_FILENO);
+      dup2 (fd, STDERR_FILENO);
+      close (fd);
+    }
+
+  //試行ごとにRNGのラン番号を分ける
+  SeedManager::SetSeed (seed);
+  SeedManager::SetRun (job.iteration);
+  Config::SetDefault ("ns3::WormholeAttackHelper::Tunnels", UintegerValue (job.tunnels));
+
+  AodvExample test;
+  test.SetSize (job.size);
+  test.SetWHSize (job.whSize);
+  test.SetEndDistance (job.endDistance);
+  test.SetTotalTime (time);
+  test.SetResultFile (job.resultFile);
+  test.SetIteration (job.iteration);
+  test.SetBatch (true);
+  test.SetPcap (pcap);
+  if (detectionLog)
+    {
+      test.SetDetectionLog ("detection.bin");
+    }
+  test.Run ();
+  int rc = WriteResult (test);
+
+  std::cout.flush ();
+  std::cerr.flush ();
+  fflush (0);
+  _exit (rc);
+}
+
+int
+main (int argc, char **argv)
+{
+  std::string sizes = "600";
+  std::string whSizes = "150,200,250,300,350";
+  std::string endDistances = "500,600,700,800";
+  std::string tunnelCounts = "1";
+  int defaultWHSize = 250;
+  int defaultEndDistance = 600;
+  uint32_t runs = 20;
+  double time = 40;
+  uint32_t jobs = 0;
+  uint32_t seed = 1;
+  bool pcap = false;
+  bool detectionLog = false;
+  std::string outBase = "p-log";
+
+  CommandLine cmd;
+  cmd.AddValue ("sizes", "Comma separated list of node counts.", sizes);
+  cmd.AddValue ("WH_sizes", "Comma separated list of WH link lengths (end_distance fixed).", whSizes);
+  cmd.AddValue ("end_distances", "Comma separated list of end distances (WH_size fixed).", endDistances);
+  cmd.AddValue ("tunnels", "Comma separated list of wormhole tunnel counts.", tunnelCounts);
+  cmd.AddValue ("WH_size", "WH link length used while sweeping end_distances.", defaultWHSize);
+  cmd.AddValue ("end_distance", "End distance used while sweeping WH_sizes.", defaultEndDistance);
+  cmd.AddValue ("runs", "Number of iterations per configuration.", runs);
+  cmd.AddValue ("time", "Simulation time, s.", time);
+  cmd.AddValue ("jobs", "Number of concurrent runs (0 = number of cores).", jobs);
+  cmd.AddValue ("seed", "RNG seed shared by all runs; the run number is the iteration.", seed);
+  cmd.AddValue ("pcap", "Write PCAP traces for every run.", pcap);
+  cmd.AddValue ("detection_log", "Write a binary detection event log for every run.", detectionLog);
+  cmd.AddValue ("out", "Base name of the result directory.", outBase);
+  cmd.Parse (argc, argv);
+
+  if (jobs == 0)
+    {
+      jobs = std::max (1u, std::thread::hardware_concurrency ());
+    }
+
+  //同名のディレクトリが存在する限り末尾に番号を付けて更新
+  std::string outDir = outBase;
+  for (int counter = 1; DirExists (outDir); ++counter)
+    {
+      outDir = outBase + "_" + std::to_string (counter);
+    }
+  char cwd[4096];
+  if (getcwd (cwd, sizeof (cwd)) == 0)
+    {
+      NS_FATAL_ERROR ("getcwd failed");
+    }
+  std::string absOut = std::string (cwd) + "/" + outDir;
+
+  //シェルスクリプトと同じ順番で試行を並べる
+  std::vector<SweepJob> queue;
+  for (int size : ParseList (sizes))
+    {
+      for (int k : ParseList (tunnelCounts))
+        {
+          uint32_t tunnels = static_cast<uint32_t> (k);
+          std::string nodeDir = absOut + "/node_" + std::to_string (size) + (k == 1 ? "" : "_K" + std::to_string (k));
+          for (int wh : ParseList (whSizes))
+            {
+              std::string dir = nodeDir + "/" + std::to_string (size) + "_WH" + std::to_string (wh);
+              for (uint32_t i = 1; i <= runs; ++i)
+                {
+                  SweepJob job = {static_cast<uint32_t> (size), wh, defaultEndDistance, static_cast<int> (i), tunnels,
+                                  dir + "/packet_num_" + std::to_string (i) + ".txt",
+                                  dir + "/run_" + std::to_string (i)};
+                  queue.push_back (job);
+                }
+            }
+          for (int distance : ParseList (endDistances))
+            {
+              std::string dir = nodeDir + "/" + std::to_string (size) + "_end_distance" + std::to_string (distance);
+              for (uint32_t i = 1; i <= runs; ++i)
+                {
+                  SweepJob job = {static_cast<uint32_t> (size), defaultWHSize, distance, static_cast<int> (i), tunnels,
+                                  dir + "/packet_num_" + std::to_string (i) + ".txt",
+                                  dir + "/run_" + std::to_string (i)};
+                  queue.push_back (job);
+                }
+            }
+        }
+    }
+
+  MakeDir (absOut);
+  std::ofstream csv (absOut + "/sweep.csv");
+  csv << "size,tunnels,WH_size,end_distance,iteration,rng_run,status,wall_s,result_file" << std::endl;
+
+  std::cout << "Running " << queue.size () << " simulations on " << jobs << " workers, results in "
+            << outDir << std::endl;
+
+  typedef std::chrono::steady_clock Clock;
+  struct Running
+  {
+    size_t job;
+    Clock::time_point start;
+  };
+  std::map<pid_t, Running> running;
+  size_t next = 0;
+  uint32_t failed = 0;
+  while (next < queue.size () || !running.empty ())
+    {
+      if (next < queue.size () && running.size () < jobs)
+        {
+          const SweepJob &job = queue[next];
+          if (job.endDistance < job.whSize + 100)
+            {
+              //AodvExample::Configure と同じ条件で実行できない組み合わせを除外する
+              std::cerr << "エンド間の距離がWHリンクの長さよりも短いです。 size=" << job.size
+                        << " WH_size=" << job.whSize << " end_distance=" << job.endDistance << std::endl;
+              csv << job.size << "," << job.tunnels << "," << job.whSize << "," << job.endDistance << "," << job.iteration
+                  << "," << job.iteration << ",skipped,0," << job.resultFile << std::endl;
+              ++next;
+              continue;
+            }
+          MakeDir (job.workDir);
+          std::cout.flush ();
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("fork failed: " << std::strerror (errno));
+            }
+          if (pid == 0)
+            {
+              RunJob (job, seed, time, pcap, detectionLog);
+            }
+          Running r = {next, Clock::now ()};
+          running[pid] = r;
+          ++next;
+          continue;
+        }
+
+      int status = 0;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("waitpid failed: " << std::strerror (errno));
+        }
+      std::map<pid_t, Running>::iterator it = running.find (pid);
+      if (it == running.end ())
+        {
+          continue;
+        }
+      const SweepJob &job = queue[it->second.job];
+      double wall = std::chrono::duration<double> (Clock::now () - it->second.start).count ();
+      bool ok = WIFEXITED (status) && WEXITSTATUS (status) == 0;
+      if (!ok)
+        {
+          ++failed;
+          std::cerr << "Simulation failed for size=" << job.size << ", WH_size=" << job.whSize
+                    << ", end_distance=" << job.endDistance << ", iteration=" << job.iteration
+                    << " (see " << job.workDir << "/log.txt)" << std::endl;
+        }
+      csv << job.size << "," << job.tunnels << "," << job.whSize << "," << job.endDistance << "," << job.iteration << ","
+          << job.iteration << "," << (ok ? "ok" : "failed") << "," << wall << "," << job.resultFile
+          << std::endl;
+      std::cout << "[" << (next - running.size () + 1) << "/" << queue.size () << "] size=" << job.size
+                << " tunnels=" << job.tunnels
+                << " WH_size=" << job.whSize << " end_distance=" << job.endDistance
+                << " iteration=" << job.iteration << " " << wall << " s" << std::endl;
+      running.erase (it);
+    }
+
+  csv.close ();
+  std::cout << "All simulations completed. Results saved in " << outDir << "." << std::endl;
+  return failed == 0 ? 0 : 1;
+}
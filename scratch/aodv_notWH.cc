@@ -80,6 +80,9 @@ public:
    */
   void Report (std::ostream & os);
 
+  //シミュレーション全体の検知統計を返す関数
+  Ptr<aodv::DetectionStatistics> GetStatistics () const { return statistics; }
+
 private:
 
   // parameters
@@ -100,6 +103,9 @@ private:
   uint32_t network_size;
 
   //追加部分
+  //全ノードで共有する検知統計
+  Ptr<aodv::DetectionStatistics> statistics;
+
   AodvHelper aodv;
   //PointToPointHelper point;
 
@@ -218,25 +224,13 @@ int main (int argc, char **argv)
 
   test.Run ();
 
-  int RREQ_num = 0;
-  int RREP_num = 0;
-  int WHC_num = 0;
-  int WHE_num = 0;
-  int DC_num = 0;
-
-  //ログ取得
-  // 各ノードのAODVルーティングプロトコルインスタンスを取得し、トレースを設定
-  for (NodeContainer::Iterator it = nodes.Begin(); it != nodes.End(); ++it)
-  {
-      Ptr<Node> node = *it;
-      RREQ_num = RREQ_num + node->GetRREQ();
-      RREP_num = RREP_num + node->GetRREP();
-      WHC_num = WHC_num + node->GetWHC();
-      WHE_num = WHE_num + node->GetWHE();
-      DC_num = DC_num + node->GetDetCount();
-
-      //printf("node id: %d サイズ：　%d\n", node->GetId(), node->GetWHC());
-  }
+  //ログ取得（各ノードの値はシミュレーション中に集計済み）
+  aodv::DetectionSummary summary = test.GetStatistics ()->GetSummary ();
+  uint64_t RREQ_num = summary.rreqBytes;
+  uint64_t RREP_num = summary.rrepBytes;
+  uint64_t WHC_num = summary.whcsBytes;
+  uint64_t WHE_num = summary.whceBytes;
+  uint64_t DC_num = summary.checks;
 
   std::ofstream p_size(filename,std::ios::app);
   if(!p_size.is_open())
@@ -484,6 +478,7 @@ AodvExample::InstallInternetStack ()
 {
 
   // you can configure AODV attributes here using aodv.Set(name, value)
+  statistics = aodv.EnableDetectionStatistics ();
   InternetStackHelper stack;
   stack.SetRoutingHelper (aodv); // has effect on the next Install ()
   stack.Install (nodes);
@@ -23,6 +23,9 @@
 #include "ns3/names.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-list-routing.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/enum.h"
 
 namespace ns3
 {
@@ -93,4 +96,29 @@ AodvHelper::AssignStreams (NodeContainer c, int64_t stream)
   return (currentStream - stream);
 }
 
+Ptr<aodv::DetectionEventLog>
+AodvHelper::EnableDetectionLog (std::string filename, bool binary)
+{
+  Ptr<aodv::DetectionEventLog> log = CreateObject<aodv::DetectionEventLog> ();
+  log->SetAttribute ("FileName", StringValue (filename));
+  log->SetAttribute ("Format", EnumValue (binary ? aodv::DetectionEventLog::BINARY
+                                                 : aodv::DetectionEventLog::CSV));
+  m_agentFactory.Set ("DetectionLog", PointerValue (log));
+  return log;
+}
+
+Ptr<aodv::DetectionStatistics>
+AodvHelper::EnableDetectionStatistics (void)
+{
+  Ptr<aodv::DetectionStatistics> stats = CreateObject<aodv::DetectionStatistics> ();
+  m_agentFactory.Set ("DetectionStatistics", PointerValue (stats));
+  return stats;
+}
+
+void
+AodvHelper::SetWormholeOracle (Ptr<aodv::WormholeOracle> oracle)
+{
+  m_agentFactory.Set ("WormholeOracle", PointerValue (oracle));
+}
+
 }
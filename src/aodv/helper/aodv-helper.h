@@ -21,6 +21,9 @@
 #include "ns3/node.h"
 #include "ns3/node-container.h"
 #include "ns3/ipv4-routing-helper.h"
+#include "ns3/aodv-detection-log.h"
+#include "ns3/aodv-detection-statistics.h"
+#include "ns3/aodv-wormhole-oracle.h"
 
 namespace ns3 {
 /**
@@ -70,6 +73,32 @@ public:
    * \return このヘルパーによって割り当てられたストリームインデックスの数
    */
   int64_t AssignStreams (NodeContainer c, int64_t stream);
+  /**
+   * 検知イベントログ（RREQ/RREP/WHCS/WHCE の送受信記録）を有効にします。
+   * 作成したログは，この後に Install されるすべてのノードで共有されます。
+   * ログはメモリ上に蓄積され，一定数に達したときとシミュレーション終了時にまとめて書き出されます。
+   *
+   * \param filename 出力するファイル名
+   * \param binary true の場合はバイナリ形式，false の場合は CSV 形式で出力する
+   * \return 作成した検知イベントログ
+   */
+  Ptr<aodv::DetectionEventLog> EnableDetectionLog (std::string filename, bool binary = false);
+  /**
+   * 検知統計（メッセージのバイト数，判定回数，誤検知，経路作成時間）の集計を有効にします。
+   * 作成した集計オブジェクトは，この後に Install されるすべてのノードで共有され，
+   * シミュレーション終了後に GetSummary で検知率などを取得できます。
+   *
+   * \return 作成した検知統計
+   */
+  Ptr<aodv::DetectionStatistics> EnableDetectionStatistics (void);
+  /**
+   * ワームホールのトンネルの正解データを設定します（WormholeAttackHelper::GetOracle）。
+   * この後に Install されるすべてのノードで共有され，WHCS の判定対象がトンネルかどうかの判別と，
+   * トンネルのアドレスから端点ノードのアドレスへの変換に使われます。
+   *
+   * \param oracle トンネルの正解データ
+   */
+  void SetWormholeOracle (Ptr<aodv::WormholeOracle> oracle);
 
 private:
   /** AODV ルーティングオブジェクトを作成するファクトリ。 */
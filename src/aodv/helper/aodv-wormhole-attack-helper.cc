@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "aodv-wormhole-attack-helper.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE ("AodvWormholeAttackHelper");
+
+NS_OBJECT_ENSURE_REGISTERED (WormholeAttackHelper);
+
+TypeId
+WormholeAttackHelper::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::WormholeAttackHelper")
+    .SetParent<Object> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<WormholeAttackHelper> ()
+    .AddAttribute ("Tunnels",
+                   "Number of tunnels created by Install (NodeContainer).",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&WormholeAttackHelper::m_tunnels),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LinkType",
+                   "Link between the endpoints of a tunnel.",
+                   EnumValue (POINT_TO_POINT),
+                   MakeEnumAccessor (&WormholeAttackHelper::m_linkType),
+                   MakeEnumChecker (POINT_TO_POINT, "PointToPoint",
+                                    OUT_OF_BAND, "OutOfBand"))
+    .AddAttribute ("DataRate",
+                   "Data rate of a PointToPoint tunnel.",
+                   DataRateValue (DataRate ("5Mbps")),
+                   MakeDataRateAccessor (&WormholeAttackHelper::m_dataRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Delay",
+                   "Delay of a PointToPoint tunnel.",
+                   TimeValue (MilliSeconds (2)),
+                   MakeTimeAccessor (&WormholeAttackHelper::m_delay),
+                   MakeTimeChecker ())
+    .AddAttribute ("NetworkBase",
+                   "Network of the first tunnel, the next tunnels use the next networks.",
+                   Ipv4AddressValue ("10.1.2.0"),
+                   MakeIpv4AddressAccessor (&WormholeAttackHelper::m_networkBase),
+                   MakeIpv4AddressChecker ())
+    .AddAttribute ("NetworkMask",
+                   "Network mask of a tunnel.",
+                   Ipv4MaskValue ("255.255.255.0"),
+                   MakeIpv4MaskAccessor (&WormholeAttackHelper::m_networkMask),
+                   MakeIpv4MaskChecker ())
+  ;
+  return tid;
+}
+
+WormholeAttackHelper::WormholeAttackHelper ()
+  : m_assigned (0),
+    m_oracle (CreateObject<aodv::WormholeOracle> ())
+{
+}
+
+void
+WormholeAttackHelper::DoDispose (void)
+{
+  m_devices = NetDeviceContainer ();
+  m_oracle = 0;
+  Object::DoDispose ();
+}
+
+NetDeviceContainer
+WormholeAttackHelper::Install (NodeContainer endpoints)
+{
+  NS_LOG_FUNCTION (this << m_tunnels);
+  NS_ABORT_MSG_IF (endpoints.GetN () < 2 * m_tunnels,
+                   endpoints.GetN () << " endpoints for " << m_tunnels << " tunnels");
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < m_tunnels; ++i)
+    {
+      devices.Add (Install (endpoints.Get (2 * i), endpoints.Get (2 * i + 1)));
+    }
+  return devices;
+}
+
+NetDeviceContainer
+WormholeAttackHelper::Install (Ptr<Node> first, Ptr<Node> second)
+{
+  NS_LOG_FUNCTION (this << first->GetId () << second->GetId ());
+  NetDeviceContainer devices;
+  if (m_linkType == POINT_TO_POINT)
+    {
+      PointToPointHelper pointToPoint;
+      pointToPoint.SetDeviceAttribute ("DataRate", DataRateValue (m_dataRate));
+      pointToPoint.SetChannelAttribute ("Delay", TimeValue (m_delay));
+      devices = pointToPoint.Install (first, second);
+    }
+  else
+    {
+      SimpleNetDeviceHelper outOfBand;
+      outOfBand.SetChannelAttribute ("Delay", TimeValue (Seconds (0)));
+      outOfBand.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (0)));
+      outOfBand.SetNetDevicePointToPointMode (true);
+      devices = outOfBand.Install (NodeContainer (first, second));
+    }
+  m_devices.Add (devices);
+  return devices;
+}
+
+bool
+WormholeAttackHelper::IsTunnelDevice (Ptr<NetDevice> device) const
+{
+  for (NetDeviceContainer::Iterator i = m_devices.Begin (); i != m_devices.End (); ++i)
+    {
+      if (*i == device)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+Ipv4Address
+WormholeAttackHelper::GetPrimaryAddress (Ptr<Node> node) const
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ABORT_MSG_UNLESS (ipv4, "Node " << node->GetId () << " has no internet stack");
+  // interface 0 is the loopback
+  for (uint32_t i = 1; i < ipv4->GetNInterfaces (); ++i)
+    {
+      if (!IsTunnelDevice (ipv4->GetNetDevice (i)) && ipv4->GetNAddresses (i) > 0)
+        {
+          return ipv4->GetAddress (i, 0).GetLocal ();
+        }
+    }
+  NS_FATAL_ERROR ("Node " << node->GetId () << " has no address besides its tunnels");
+  return Ipv4Address ();
+}
+
+Ipv4InterfaceContainer
+WormholeAttackHelper::AssignAddresses (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ipv4AddressHelper address (m_networkBase, m_networkMask);
+  for (uint32_t i = 0; i < m_assigned; ++i)
+    {
+      address.NewNetwork ();
+    }
+  Ipv4InterfaceContainer interfaces;
+  for (; m_assigned < m_devices.GetN () / 2; ++m_assigned)
+    {
+      NetDeviceContainer tunnel (m_devices.Get (2 * m_assigned), m_devices.Get (2 * m_assigned + 1));
+      Ipv4InterfaceContainer ifaces = address.Assign (tunnel);
+      address.NewNetwork ();
+      Ipv4Address first = GetPrimaryAddress (tunnel.Get (0)->GetNode ());
+      Ipv4Address second = GetPrimaryAddress (tunnel.Get (1)->GetNode ());
+      m_oracle->AddTunnel (first, second);
+      m_oracle->AddAlias (ifaces.GetAddress (0), first);
+      m_oracle->AddAlias (ifaces.GetAddress (1), second);
+      NS_LOG_INFO ("Tunnel " << m_assigned << ": " << first << " (" << ifaces.GetAddress (0) << ") - "
+                             << second << " (" << ifaces.GetAddress (1) << ")");
+      interfaces.Add (ifaces);
+    }
+  return interfaces;
+}
+
+Ptr<aodv::WormholeOracle>
+WormholeAttackHelper::GetOracle (void) const
+{
+  return m_oracle;
+}
+
+uint32_t
+WormholeAttackHelper::GetNTunnels (void) const
+{
+  return m_devices.GetN () / 2;
+}
+
+void
+WormholeAttackHelper::EnablePcap (std::string prefix)
+{
+  if (m_linkType != POINT_TO_POINT)
+    {
+      NS_LOG_WARN ("No pcap output for OutOfBand tunnels");
+      return;
+    }
+  PointToPointHelper pointToPoint;
+  pointToPoint.EnablePcap (prefix, m_devices);
+}
+
+}
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AODV_WORMHOLE_ATTACK_HELPER_H
+#define AODV_WORMHOLE_ATTACK_HELPER_H
+
+#include "ns3/object.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/aodv-wormhole-oracle.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup aodv
+ * \brief ワームホール攻撃（攻撃ノード間のトンネル）を配置するヘルパークラスです。
+ *
+ * 属性 Tunnels で指定した K 本のトンネルを，ポイントツーポイントリンクまたは
+ * 遅延ゼロの帯域外リンクで作成し，各トンネルを検知の正解データ
+ * （aodv::WormholeOracle）に登録します。属性は Config::SetDefault や
+ * コマンドライン（--ns3::WormholeAttackHelper::Tunnels=4 など）から変更できます。
+ *
+ * 使い方：
+ * 1. 無線デバイスの作成後に Install でトンネルを作成する
+ * 2. AodvHelper::SetWormholeOracle で GetOracle を各ノードに渡してから InternetStackHelper::Install を呼ぶ
+ * 3. 無線インターフェースへのアドレス割り当て後に AssignAddresses を呼ぶ
+ */
+class WormholeAttackHelper : public Object
+{
+public:
+  /// トンネルのリンクの種類
+  enum LinkType
+  {
+    POINT_TO_POINT, //!< 属性 DataRate と Delay を使うポイントツーポイントリンク
+    OUT_OF_BAND     //!< 帯域無制限・遅延ゼロの帯域外リンク
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  WormholeAttackHelper ();
+
+  /**
+   * Tunnels 本のトンネルを作成します。i 本目のトンネルは endpoints の 2i 番目と 2i+1 番目のノードを結びます。
+   *
+   * \param endpoints トンネルの端点のノード（2 * Tunnels 個以上）
+   * \return 作成したデバイス（トンネルごとに2つ）
+   */
+  NetDeviceContainer Install (NodeContainer endpoints);
+  /**
+   * 1本のトンネルを作成します。
+   *
+   * \param first トンネルの一方の端点
+   * \param second トンネルのもう一方の端点
+   * \return 作成したデバイス
+   */
+  NetDeviceContainer Install (Ptr<Node> first, Ptr<Node> second);
+  /**
+   * アドレスが未割り当てのトンネルに，NetworkBase から順にトンネルごとのサブネットを割り当て，
+   * トンネルとトンネルインターフェースのアドレスを正解データに登録します。
+   * 端点のノードの主アドレスは，トンネル以外で最初のインターフェースのアドレスです。
+   *
+   * \return 割り当てたインターフェース（トンネルごとに2つ）
+   */
+  Ipv4InterfaceContainer AssignAddresses (void);
+  /**
+   * \return トンネルの正解データ
+   */
+  Ptr<aodv::WormholeOracle> GetOracle (void) const;
+  /**
+   * \return 作成したトンネルの数
+   */
+  uint32_t GetNTunnels (void) const;
+  /**
+   * トンネルの pcap 出力を有効にします（POINT_TO_POINT のみ）。
+   *
+   * \param prefix ファイル名のプレフィックス
+   */
+  void EnablePcap (std::string prefix);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \param node ノード
+   * \return トンネル以外で最初のインターフェースのアドレス
+   */
+  Ipv4Address GetPrimaryAddress (Ptr<Node> node) const;
+  /**
+   * \param device デバイス
+   * \return device がトンネルのデバイスであれば true
+   */
+  bool IsTunnelDevice (Ptr<NetDevice> device) const;
+
+  uint32_t m_tunnels;                ///< Install (NodeContainer) で作成するトンネルの数
+  LinkType m_linkType;               ///< トンネルのリンクの種類
+  DataRate m_dataRate;               ///< ポイントツーポイントリンクの伝送速度
+  Time m_delay;                      ///< ポイントツーポイントリンクの遅延
+  Ipv4Address m_networkBase;         ///< 最初のトンネルのネットワークアドレス
+  Ipv4Mask m_networkMask;            ///< トンネルのネットワークマスク
+  NetDeviceContainer m_devices;      ///< 作成したデバイス（トンネルごとに2つ）
+  uint32_t m_assigned;               ///< アドレスを割り当てたトンネルの数
+  Ptr<aodv::WormholeOracle> m_oracle; ///< トンネルの正解データ
+};
+
+}
+
+#endif /* AODV_WORMHOLE_ATTACK_HELPER_H */
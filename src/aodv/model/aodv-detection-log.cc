@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "aodv-detection-log.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include <cstring>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AodvDetectionLog");
+
+namespace aodv {
+NS_OBJECT_ENSURE_REGISTERED (DetectionEventLog);
+
+namespace {
+/// Names of DetectionEvent::Type used by the CSV sink
+const char * const g_typeNames[] = {
+  "RREQ_SEND", "RREQ_RECV", "RREP_SEND", "RREP_RECV",
+  "WHCS_SEND", "WHCS_RECV", "WHCE_SEND", "WHCE_RECV"
+};
+
+/// Append the raw bytes of \p v to \p buf
+template <typename T>
+char *
+Put (char *buf, T v)
+{
+  std::memcpy (buf, &v, sizeof (T));
+  return buf + sizeof (T);
+}
+} // namespace
+
+TypeId
+DetectionEventLog::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::aodv::DetectionEventLog")
+    .SetParent<Object> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<DetectionEventLog> ()
+    .AddAttribute ("FileName", "Output file of the detection event log.",
+                   StringValue ("aodv-detection.csv"),
+                   MakeStringAccessor (&DetectionEventLog::m_fileName),
+                   MakeStringChecker ())
+    .AddAttribute ("Format", "Output format of the detection event log.",
+                   EnumValue (DetectionEventLog::CSV),
+                   MakeEnumAccessor (&DetectionEventLog::m_format),
+                   MakeEnumChecker (DetectionEventLog::CSV, "Csv",
+                                    DetectionEventLog::BINARY, "Binary"))
+    .AddAttribute ("FlushThreshold", "Number of buffered events which triggers a write to the file.",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&DetectionEventLog::m_flushThreshold),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+DetectionEventLog::DetectionEventLog ()
+  : m_format (CSV),
+    m_flushThreshold (65536),
+    m_nRecorded (0),
+    m_destroyScheduled (false)
+{
+}
+
+DetectionEventLog::~DetectionEventLog ()
+{
+  Flush ();
+}
+
+void
+DetectionEventLog::DoDispose ()
+{
+  Flush ();
+  m_out.close ();
+  Object::DoDispose ();
+}
+
+void
+DetectionEventLog::Record (DetectionEvent::Type type, uint32_t node, uint32_t id, uint32_t rreqId,
+                           uint8_t hopCount, Ipv4Address origin, Ipv4Address fir, Ipv4Address second)
+{
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  if (!m_destroyScheduled)
+    {
+      // 最後にバッファに残ったイベントはシミュレーション終了時に書き出す
+      Simulator::ScheduleDestroy (&DetectionEventLog::Flush, Ptr<DetectionEventLog> (this));
+      m_destroyScheduled = true;
+    }
+  if (m_buffer.capacity () == 0)
+    {
+      m_buffer.reserve (m_flushThreshold);
+    }
+  DetectionEvent ev;
+  ev.time = Simulator::Now ().GetNanoSeconds ();
+  ev.node = node;
+  ev.type = type;
+  ev.hopCount = hopCount;
+  ev.id = id;
+  ev.rreqId = rreqId;
+  ev.origin = origin.Get ();
+  ev.fir = fir.Get ();
+  ev.second = second.Get ();
+  m_buffer.push_back (ev);
+  ++m_nRecorded;
+  if (m_buffer.size () >= m_flushThreshold)
+    {
+      DoFlush ();
+    }
+}
+
+void
+DetectionEventLog::Flush ()
+{
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  DoFlush ();
+}
+
+void
+DetectionEventLog::Open ()
+{
+  NS_LOG_FUNCTION (this << m_fileName);
+  if (m_format == BINARY)
+    {
+      m_out.open (m_fileName.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+      uint32_t recordSize = BINARY_RECORD_SIZE;
+      m_out.write ("AODVDLOG", 8);
+      m_out.write (reinterpret_cast<const char *> (&recordSize), sizeof (recordSize));
+    }
+  else
+    {
+      m_out.open (m_fileName.c_str (), std::ios::out | std::ios::trunc);
+      m_out << "time_ns,node,type,hop,id,rreq_id,origin,fir,second\n";
+    }
+  if (!m_out.is_open ())
+    {
+      NS_FATAL_ERROR ("Unable to open detection event log " << m_fileName);
+    }
+}
+
+void
+DetectionEventLog::DoFlush ()
+{
+  if (m_buffer.empty ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_buffer.size ());
+  if (!m_out.is_open ())
+    {
+      Open ();
+    }
+  if (m_format == BINARY)
+    {
+      std::vector<char> block (m_buffer.size () * BINARY_RECORD_SIZE);
+      char *p = block.data ();
+      for (std::vector<DetectionEvent>::const_iterator i = m_buffer.begin (); i != m_buffer.end (); ++i)
+        {
+          p = Put (p, i->time);
+          p = Put (p, i->node);
+          p = Put (p, i->type);
+          p = Put (p, i->hopCount);
+          p = Put (p, i->id);
+          p = Put (p, i->rreqId);
+          p = Put (p, i->origin);
+          p = Put (p, i->fir);
+          p = Put (p, i->second);
+        }
+      m_out.write (block.data (), block.size ());
+    }
+  else
+    {
+      std::ostringstream block;
+      for (std::vector<DetectionEvent>::const_iterator i = m_buffer.begin (); i != m_buffer.end (); ++i)
+        {
+          block << i->time << ',' << i->node << ',' << g_typeNames[i->type] << ','
+                << static_cast<uint32_t> (i->hopCount) << ',' << i->id << ',' << i->rreqId << ','
+                << Ipv4Address (i->origin) << ',' << Ipv4Address (i->fir) << ','
+                << Ipv4Address (i->second) << '\n';
+        }
+      m_out << block.str ();
+    }
+  m_out.flush ();
+  m_buffer.clear ();
+}
+
+} // namespace aodv
+} // namespace ns3
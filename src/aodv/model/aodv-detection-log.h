@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AODV_DETECTION_LOG_H
+#define AODV_DETECTION_LOG_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/core-config.h"
+#ifdef NS3_MTP
+#include "ns3/system-mutex.h"
+#endif
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv
+ *
+ * \brief One record of the detection event log.
+ */
+struct DetectionEvent
+{
+  /// Event type
+  enum Type
+  {
+    RREQ_SEND = 0, //!< RREQ originated
+    RREQ_RECV = 1, //!< RREQ received
+    RREP_SEND = 2, //!< RREP originated
+    RREP_RECV = 3, //!< RREP received
+    WHCS_SEND = 4, //!< WHCS (wormhole check start) originated
+    WHCS_RECV = 5, //!< WHCS received
+    WHCE_SEND = 6, //!< WHCE (wormhole check end) originated
+    WHCE_RECV = 7  //!< WHCE received
+  };
+
+  int64_t time;      ///< Simulation time in nanoseconds
+  uint32_t node;     ///< Node id
+  uint8_t type;      ///< Event type, see Type
+  uint8_t hopCount;  ///< Hop count carried in the message
+  uint32_t id;       ///< Message id (RREQ, RREP, WHCS or WHCE id)
+  uint32_t rreqId;   ///< RREQ id the message refers to (RREP only)
+  uint32_t origin;   ///< Origin address of the message
+  uint32_t fir;      ///< First hop of the checked link (WHCS only)
+  uint32_t second;   ///< Second hop of the checked link (WHCS only)
+};
+
+/**
+ * \ingroup aodv
+ *
+ * \brief In-memory recorder of the control messages relevant to wormhole detection.
+ *
+ * One instance is shared by all RoutingProtocol objects of a simulation.
+ * Events are kept in memory and written to the sink in one block either when
+ * FlushThreshold events are buffered or when the simulation is destroyed.
+ *
+ * The CSV sink writes a header line followed by one line per event.  The
+ * binary sink writes the 8 byte magic "AODVDLOG", a uint32_t record size and
+ * then the packed records in host byte order with the field layout of
+ * DetectionEvent (time, node, type, hopCount, id, rreqId, origin, fir, second).
+ *
+ * With the multithreaded simulator (NS3_MTP) Record and Flush are
+ * serialized by a mutex; events of different threads may then appear out
+ * of time order in the file.
+ */
+class DetectionEventLog : public Object
+{
+public:
+  /// Sink format
+  enum Format
+  {
+    CSV,   //!< Comma separated text
+    BINARY //!< Packed binary records
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  DetectionEventLog ();
+  ~DetectionEventLog ();
+
+  /**
+   * Buffer an event, flushing the buffer if the threshold is reached
+   * \param type the event type
+   * \param node the node id
+   * \param id the message id
+   * \param rreqId the RREQ id the message refers to
+   * \param hopCount the hop count carried in the message
+   * \param origin the origin address of the message
+   * \param fir the first hop of the checked link
+   * \param second the second hop of the checked link
+   */
+  void Record (DetectionEvent::Type type, uint32_t node, uint32_t id, uint32_t rreqId,
+               uint8_t hopCount, Ipv4Address origin, Ipv4Address fir = Ipv4Address::GetAny (),
+               Ipv4Address second = Ipv4Address::GetAny ());
+  /// Write all buffered events to the sink
+  void Flush ();
+  /**
+   * \returns the number of events recorded since the log was created
+   */
+  uint64_t GetNRecorded () const
+  {
+    return m_nRecorded;
+  }
+  /**
+   * \returns the events buffered and not yet flushed
+   */
+  const std::vector<DetectionEvent> & GetBuffered () const
+  {
+    return m_buffer;
+  }
+
+  /// Size in bytes of one binary record
+  static const uint32_t BINARY_RECORD_SIZE = 34;
+
+protected:
+  virtual void DoDispose ();
+
+private:
+  /// Open the sink and write the file header
+  void Open ();
+  /// Write all buffered events to the sink, the caller holds the mutex
+  void DoFlush ();
+
+  std::string m_fileName;              ///< Output file name
+  Format m_format;                     ///< Output format
+  uint32_t m_flushThreshold;           ///< Number of buffered events triggering a flush
+  std::vector<DetectionEvent> m_buffer; ///< Events not yet written
+  std::ofstream m_out;                 ///< Output stream, opened on the first flush
+  uint64_t m_nRecorded;                ///< Events recorded so far
+  bool m_destroyScheduled;             ///< Whether the final flush is scheduled
+#ifdef NS3_MTP
+  SystemMutex m_mutex;                 ///< Serializes the recording threads
+#endif
+};
+
+} // namespace aodv
+} // namespace ns3
+
+#endif /* AODV_DETECTION_LOG_H */
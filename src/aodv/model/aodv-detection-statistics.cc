@@ -0,0 +1,327 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "aodv-detection-statistics.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AodvDetectionStatistics");
+
+namespace aodv {
+NS_OBJECT_ENSURE_REGISTERED (DetectionStatistics);
+
+#ifdef NS3_MTP
+/// Lock the statistics mutex in the scope of the macro
+#define DETECTION_STATISTICS_LOCK CriticalSection cs (m_mutex)
+#else
+/// Nothing to lock in the sequential simulator
+#define DETECTION_STATISTICS_LOCK
+#endif
+
+DetectionNodeCounters::DetectionNodeCounters ()
+  : rreqBytes (0),
+    rrepBytes (0),
+    whcsBytes (0),
+    whceBytes (0),
+    checks (0),
+    normalJudgements (0),
+    wormholeJudgements (0),
+    wormholeMisses (0),
+    uncheckedJudgements (0),
+    routeSetups (0),
+    checksCompleted (0)
+{
+}
+
+TypeId
+DetectionStatistics::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::aodv::DetectionStatistics")
+    .SetParent<Object> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<DetectionStatistics> ()
+    .AddAttribute ("LatencyPrecision",
+                   "Number of significant bits of the buckets of the latency histograms, "
+                   "the relative error of a percentile is at most 2^(1-LatencyPrecision).",
+                   UintegerValue (6),
+                   MakeUintegerAccessor (&DetectionStatistics::SetLatencyPrecision,
+                                         &DetectionStatistics::GetLatencyPrecision),
+                   MakeUintegerChecker<uint32_t> (1, 16))
+  ;
+  return tid;
+}
+
+DetectionStatistics::DetectionStatistics ()
+{
+  Reset ();
+}
+
+void
+DetectionStatistics::Reset ()
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes.clear ();
+  m_pending.clear ();
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      m_bytes[i] = 0;
+    }
+  m_checks = 0;
+  m_normalJudgements = 0;
+  m_wormholeJudgements = 0;
+  m_wormholeMisses = 0;
+  m_uncheckedJudgements = 0;
+  m_routeSetups = 0;
+  m_routeSetupSum = Time (0);
+  m_routeSetupMin = Time (0);
+  m_routeSetupMax = Time (0);
+  m_routeSetupLatency.Reset ();
+  m_checkLatency.Reset ();
+}
+
+void
+DetectionStatistics::SetLatencyPrecision (uint32_t precision)
+{
+  DETECTION_STATISTICS_LOCK;
+  m_routeSetupLatency.SetPrecision (precision);
+  m_checkLatency.SetPrecision (precision);
+}
+
+uint32_t
+DetectionStatistics::GetLatencyPrecision () const
+{
+  return m_routeSetupLatency.GetPrecision ();
+}
+
+DetectionNodeCounters &
+DetectionStatistics::GetCounters (uint32_t node)
+{
+  if (node >= m_nodes.size ())
+    {
+      m_nodes.resize (node + 1);
+    }
+  return m_nodes[node];
+}
+
+void
+DetectionStatistics::MessageSent (uint32_t node, Message message, uint32_t bytes)
+{
+  DETECTION_STATISTICS_LOCK;
+  DetectionNodeCounters &c = GetCounters (node);
+  switch (message)
+    {
+    case RREQ:
+      c.rreqBytes += bytes;
+      break;
+    case RREP:
+      c.rrepBytes += bytes;
+      break;
+    case WHCS:
+      c.whcsBytes += bytes;
+      break;
+    case WHCE:
+      c.whceBytes += bytes;
+      break;
+    }
+  m_bytes[message] += bytes;
+}
+
+void
+DetectionStatistics::CheckStarted (uint32_t node)
+{
+  DETECTION_STATISTICS_LOCK;
+  GetCounters (node).checks++;
+  m_checks++;
+}
+
+void
+DetectionStatistics::JudgementSent (uint32_t node, uint32_t id, bool wormhole)
+{
+  DETECTION_STATISTICS_LOCK;
+  DetectionNodeCounters &c = GetCounters (node);
+  if (wormhole)
+    {
+      c.wormholeJudgements++;
+      m_wormholeJudgements++;
+    }
+  else
+    {
+      c.normalJudgements++;
+      m_normalJudgements++;
+      m_pending.insert (MakeKey (node, id));
+    }
+}
+
+void
+DetectionStatistics::JudgementAnswered (uint32_t node, uint32_t id, bool wormhole)
+{
+  DETECTION_STATISTICS_LOCK;
+  if (wormhole)
+    {
+      // the WHCE came back through the tunnel: the wormhole was judged normal
+      GetCounters (node).wormholeMisses++;
+      m_wormholeMisses++;
+    }
+  else
+    {
+      m_pending.erase (MakeKey (node, id));
+    }
+}
+
+void
+DetectionStatistics::JudgementSkipped (uint32_t node, bool wormhole)
+{
+  DETECTION_STATISTICS_LOCK;
+  DetectionNodeCounters &c = GetCounters (node);
+  c.uncheckedJudgements++;
+  m_uncheckedJudgements++;
+  if (wormhole)
+    {
+      c.wormholeJudgements++;
+      c.wormholeMisses++;
+      m_wormholeJudgements++;
+      m_wormholeMisses++;
+    }
+  else
+    {
+      c.normalJudgements++;
+      m_normalJudgements++;
+    }
+}
+
+void
+DetectionStatistics::RouteEstablished (uint32_t node, Time setupTime)
+{
+  DETECTION_STATISTICS_LOCK;
+  GetCounters (node).routeSetups++;
+  if (m_routeSetups == 0 || setupTime < m_routeSetupMin)
+    {
+      m_routeSetupMin = setupTime;
+    }
+  if (m_routeSetups == 0 || setupTime > m_routeSetupMax)
+    {
+      m_routeSetupMax = setupTime;
+    }
+  m_routeSetupSum += setupTime;
+  m_routeSetups++;
+  m_routeSetupLatency.Record (setupTime);
+}
+
+void
+DetectionStatistics::CheckCompleted (uint32_t node, Time latency)
+{
+  DETECTION_STATISTICS_LOCK;
+  GetCounters (node).checksCompleted++;
+  m_checkLatency.Record (latency);
+}
+
+DetectionNodeCounters
+DetectionStatistics::GetNodeCounters (uint32_t node) const
+{
+  DETECTION_STATISTICS_LOCK;
+  return node < m_nodes.size () ? m_nodes[node] : DetectionNodeCounters ();
+}
+
+DetectionSummary
+DetectionStatistics::GetSummary () const
+{
+  DETECTION_STATISTICS_LOCK;
+  DetectionSummary s;
+  s.rreqBytes = m_bytes[RREQ];
+  s.rrepBytes = m_bytes[RREP];
+  s.whcsBytes = m_bytes[WHCS];
+  s.whceBytes = m_bytes[WHCE];
+  s.checks = m_checks;
+  s.normalJudgements = m_normalJudgements;
+  s.wormholeJudgements = m_wormholeJudgements;
+  s.wormholesDetected = m_wormholeJudgements - m_wormholeMisses;
+  s.falsePositives = m_pending.size ();
+  s.uncheckedJudgements = m_uncheckedJudgements;
+  uint64_t judgements = m_normalJudgements + m_wormholeJudgements;
+  s.detectionRate = m_wormholeJudgements ? double (s.wormholesDetected) / m_wormholeJudgements : 0;
+  s.falsePositiveRate = m_normalJudgements ? double (s.falsePositives) / m_normalJudgements : 0;
+  s.costPerJudgement = judgements ? double (s.whcsBytes + s.whceBytes) / judgements : 0;
+  s.routeSetups = m_routeSetups;
+  s.routeSetupTotal = m_routeSetupSum;
+  s.routeSetupMin = m_routeSetupMin;
+  s.routeSetupMax = m_routeSetupMax;
+  s.routeSetupMean = m_routeSetups ? m_routeSetupSum / m_routeSetups : Time (0);
+  s.routeSetupP50 = m_routeSetupLatency.GetPercentile (50);
+  s.routeSetupP90 = m_routeSetupLatency.GetPercentile (90);
+  s.routeSetupP99 = m_routeSetupLatency.GetPercentile (99);
+  s.routeSetupP999 = m_routeSetupLatency.GetPercentile (99.9);
+  s.checksCompleted = m_checkLatency.GetCount ();
+  s.checkLatencyMean = m_checkLatency.GetMean ();
+  s.checkLatencyP50 = m_checkLatency.GetPercentile (50);
+  s.checkLatencyP90 = m_checkLatency.GetPercentile (90);
+  s.checkLatencyP99 = m_checkLatency.GetPercentile (99);
+  s.checkLatencyP999 = m_checkLatency.GetPercentile (99.9);
+  s.checkLatencyMax = m_checkLatency.GetMax ();
+  return s;
+}
+
+LatencyHistogram
+DetectionStatistics::GetRouteSetupLatency () const
+{
+  DETECTION_STATISTICS_LOCK;
+  return m_routeSetupLatency;
+}
+
+LatencyHistogram
+DetectionStatistics::GetCheckLatency () const
+{
+  DETECTION_STATISTICS_LOCK;
+  return m_checkLatency;
+}
+
+std::ostream &
+operator<< (std::ostream &os, const DetectionSummary &summary)
+{
+  os << "rreq_bytes: " << summary.rreqBytes << std::endl
+     << "rrep_bytes: " << summary.rrepBytes << std::endl
+     << "whcs_bytes: " << summary.whcsBytes << std::endl
+     << "whce_bytes: " << summary.whceBytes << std::endl
+     << "checks: " << summary.checks << std::endl
+     << "normal_judgements: " << summary.normalJudgements << std::endl
+     << "wormhole_judgements: " << summary.wormholeJudgements << std::endl
+     << "wormholes_detected: " << summary.wormholesDetected << std::endl
+     << "false_positives: " << summary.falsePositives << std::endl
+     << "unchecked_judgements: " << summary.uncheckedJudgements << std::endl
+     << "detection_rate: " << summary.detectionRate << std::endl
+     << "false_positive_rate: " << summary.falsePositiveRate << std::endl
+     << "cost_per_judgement: " << summary.costPerJudgement << std::endl
+     << "route_setups: " << summary.routeSetups << std::endl
+     << "route_setup_total: " << summary.routeSetupTotal.GetSeconds () << std::endl
+     << "route_setup_min: " << summary.routeSetupMin.GetSeconds () << std::endl
+     << "route_setup_mean: " << summary.routeSetupMean.GetSeconds () << std::endl
+     << "route_setup_max: " << summary.routeSetupMax.GetSeconds () << std::endl
+     << "route_setup_p50: " << summary.routeSetupP50.GetSeconds () << std::endl
+     << "route_setup_p90: " << summary.routeSetupP90.GetSeconds () << std::endl
+     << "route_setup_p99: " << summary.routeSetupP99.GetSeconds () << std::endl
+     << "route_setup_p999: " << summary.routeSetupP999.GetSeconds () << std::endl
+     << "checks_completed: " << summary.checksCompleted << std::endl
+     << "check_latency_mean: " << summary.checkLatencyMean.GetSeconds () << std::endl
+     << "check_latency_p50: " << summary.checkLatencyP50.GetSeconds () << std::endl
+     << "check_latency_p90: " << summary.checkLatencyP90.GetSeconds () << std::endl
+     << "check_latency_p99: " << summary.checkLatencyP99.GetSeconds () << std::endl
+     << "check_latency_p999: " << summary.checkLatencyP999.GetSeconds () << std::endl
+     << "check_latency_max: " << summary.checkLatencyMax.GetSeconds () << std::endl;
+  return os;
+}
+
+} // namespace aodv
+} // namespace ns3
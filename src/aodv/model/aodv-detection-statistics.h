@@ -0,0 +1,252 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AODV_DETECTION_STATISTICS_H
+#define AODV_DETECTION_STATISTICS_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/core-config.h"
+#include "aodv-latency-histogram.h"
+#ifdef NS3_MTP
+#include "ns3/system-mutex.h"
+#endif
+#include <ostream>
+#include <unordered_set>
+#include <vector>
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv
+ *
+ * \brief Wormhole detection counters of one node.
+ */
+struct DetectionNodeCounters
+{
+  DetectionNodeCounters ();
+
+  uint64_t rreqBytes;           ///< Bytes of RREQ sent
+  uint64_t rrepBytes;           ///< Bytes of RREP sent
+  uint64_t whcsBytes;           ///< Bytes of WHCS (wormhole check start) sent
+  uint64_t whceBytes;           ///< Bytes of WHCE (wormhole check end) sent
+  uint32_t checks;              ///< Checks started
+  uint32_t normalJudgements;    ///< Judgements of a normal link
+  uint32_t wormholeJudgements;  ///< Judgements of a wormhole link
+  uint32_t wormholeMisses;      ///< Wormhole links judged normal
+  uint32_t uncheckedJudgements; ///< Links judged normal without a check
+  uint32_t routeSetups;         ///< Routes set up with a measured setup time
+  uint32_t checksCompleted;     ///< Checks whose WHCE came back
+};
+
+/**
+ * \ingroup aodv
+ *
+ * \brief Aggregated result of a simulation, see DetectionStatistics::GetSummary.
+ */
+struct DetectionSummary
+{
+  uint64_t rreqBytes;            ///< Bytes of RREQ sent by all nodes
+  uint64_t rrepBytes;            ///< Bytes of RREP sent by all nodes
+  uint64_t whcsBytes;            ///< Bytes of WHCS sent by all nodes
+  uint64_t whceBytes;            ///< Bytes of WHCE sent by all nodes
+  uint64_t checks;               ///< Checks started by all nodes
+  uint64_t normalJudgements;     ///< Judgements of a normal link
+  uint64_t wormholeJudgements;   ///< Judgements of a wormhole link
+  uint64_t wormholesDetected;    ///< Wormhole links judged as wormhole
+  uint64_t falsePositives;       ///< Normal links whose check got no WHCE back
+  uint64_t uncheckedJudgements;  ///< Links judged normal without a check, counted in the judgements
+  double detectionRate;          ///< wormholesDetected / wormholeJudgements
+  double falsePositiveRate;      ///< falsePositives / normalJudgements
+  double costPerJudgement;       ///< (whcsBytes + whceBytes) / judgements
+  uint64_t routeSetups;          ///< Number of route setup times
+  Time routeSetupTotal;          ///< Sum of the route setup times
+  Time routeSetupMin;            ///< Smallest route setup time
+  Time routeSetupMean;           ///< Mean route setup time
+  Time routeSetupMax;            ///< Largest route setup time
+  Time routeSetupP50;            ///< Median route setup time
+  Time routeSetupP90;            ///< 90th percentile of the route setup time
+  Time routeSetupP99;            ///< 99th percentile of the route setup time
+  Time routeSetupP999;           ///< 99.9th percentile of the route setup time
+  uint64_t checksCompleted;      ///< Checks whose WHCE came back to the originator
+  Time checkLatencyMean;         ///< Mean time between the WHCS and the WHCE
+  Time checkLatencyP50;          ///< Median time between the WHCS and the WHCE
+  Time checkLatencyP90;          ///< 90th percentile of the time between the WHCS and the WHCE
+  Time checkLatencyP99;          ///< 99th percentile of the time between the WHCS and the WHCE
+  Time checkLatencyP999;         ///< 99.9th percentile of the time between the WHCS and the WHCE
+  Time checkLatencyMax;          ///< Largest time between the WHCS and the WHCE
+};
+
+/**
+ * \ingroup aodv
+ *
+ * \brief Per-simulation collector of the wormhole detection statistics.
+ *
+ * One instance is shared by all RoutingProtocol objects of a simulation
+ * (see AodvHelper::EnableDetectionStatistics).  The counters of each node
+ * are kept in a vector indexed by node id, the running totals and the
+ * route setup time extremes are updated as events are reported, so that
+ * GetSummary is O(1).  The checks of normal links waiting for their WHCE
+ * are kept in a hash set; a check never answered counts as a false
+ * positive.  The links the passive detection judges normal without a
+ * check count as judgements too, and as misses for the wormholes, so
+ * that the rates of both modes are over the same links.  The route setup times and the check latencies of all nodes
+ * are also counted in two LatencyHistogram, which give their percentiles
+ * without keeping the samples.
+ */
+class DetectionStatistics : public Object
+{
+public:
+  /// Control message types
+  enum Message
+  {
+    RREQ, //!< Route request
+    RREP, //!< Route reply
+    WHCS, //!< Wormhole check start
+    WHCE  //!< Wormhole check end
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  DetectionStatistics ();
+
+  /**
+   * Count a control message sent by a node
+   * \param node the node id
+   * \param message the message type
+   * \param bytes the message size
+   */
+  void MessageSent (uint32_t node, Message message, uint32_t bytes);
+  /**
+   * Count a check started by a node
+   * \param node the node id
+   */
+  void CheckStarted (uint32_t node);
+  /**
+   * Count a judgement sent by a node
+   * \param node the node id
+   * \param id the WHCS id
+   * \param wormhole whether the checked link is a wormhole
+   */
+  void JudgementSent (uint32_t node, uint32_t id, bool wormhole);
+  /**
+   * Count the WHCE answering a judgement of a node
+   * \param node the node id
+   * \param id the WHCS id
+   * \param wormhole whether the checked link is a wormhole
+   */
+  void JudgementAnswered (uint32_t node, uint32_t id, bool wormhole);
+  /**
+   * Count a link judged normal by a node without a check, by the passive
+   * detection.  It counts as a judgement, and as a miss for a wormhole.
+   * \param node the node id
+   * \param wormhole whether the link is a wormhole
+   */
+  void JudgementSkipped (uint32_t node, bool wormhole);
+  /**
+   * Count a route set up by a node
+   * \param node the node id
+   * \param setupTime the time between the RREQ and the RREP
+   */
+  void RouteEstablished (uint32_t node, Time setupTime);
+  /**
+   * Count the WHCE of a check coming back to the originator
+   * \param node the node id of the originator
+   * \param latency the time between the WHCS and the WHCE
+   */
+  void CheckCompleted (uint32_t node, Time latency);
+
+  /**
+   * \param node the node id
+   * \returns the counters of the node
+   */
+  DetectionNodeCounters GetNodeCounters (uint32_t node) const;
+  /**
+   * \returns the statistics aggregated over all nodes
+   */
+  DetectionSummary GetSummary () const;
+  /**
+   * \returns the route setup times of all nodes
+   */
+  LatencyHistogram GetRouteSetupLatency () const;
+  /**
+   * \returns the check latencies (WHCS to WHCE) of all nodes
+   */
+  LatencyHistogram GetCheckLatency () const;
+  /// Clear all counters
+  void Reset ();
+
+private:
+  /**
+   * \param node the node id
+   * \returns the counters of the node, created if needed
+   */
+  DetectionNodeCounters & GetCounters (uint32_t node);
+  /**
+   * \param node the node id
+   * \param id the WHCS id
+   * \returns the key of the check in m_pending
+   */
+  static uint64_t MakeKey (uint32_t node, uint32_t id)
+  {
+    return (static_cast<uint64_t> (node) << 32) | id;
+  }
+  /**
+   * Set the precision of the latency histograms, clears them
+   * \param precision the number of significant bits of the buckets
+   */
+  void SetLatencyPrecision (uint32_t precision);
+  /**
+   * \returns the precision of the latency histograms
+   */
+  uint32_t GetLatencyPrecision () const;
+
+  std::vector<DetectionNodeCounters> m_nodes; ///< Counters indexed by node id
+  std::unordered_set<uint64_t> m_pending;     ///< Checks of normal links waiting for their WHCE
+  uint64_t m_bytes[4];                        ///< Total bytes per Message
+  uint64_t m_checks;                          ///< Total checks started
+  uint64_t m_normalJudgements;                ///< Total judgements of normal links
+  uint64_t m_wormholeJudgements;              ///< Total judgements of wormhole links
+  uint64_t m_wormholeMisses;                  ///< Total wormhole links judged normal
+  uint64_t m_uncheckedJudgements;             ///< Total links judged normal without a check
+  uint64_t m_routeSetups;                     ///< Number of route setup times
+  Time m_routeSetupSum;                       ///< Sum of the route setup times
+  Time m_routeSetupMin;                       ///< Smallest route setup time
+  Time m_routeSetupMax;                       ///< Largest route setup time
+  LatencyHistogram m_routeSetupLatency;       ///< Route setup times
+  LatencyHistogram m_checkLatency;            ///< Times between the WHCS and the WHCE
+#ifdef NS3_MTP
+  mutable SystemMutex m_mutex;                ///< Serializes the reporting threads
+#endif
+};
+
+/**
+ * \brief Print the summary, one "name: value" line per field
+ * \param os the output stream
+ * \param summary the summary
+ * \returns the output stream
+ */
+std::ostream & operator<< (std::ostream &os, const DetectionSummary &summary);
+
+} // namespace aodv
+} // namespace ns3
+
+#endif /* AODV_DETECTION_STATISTICS_H */
@@ -31,6 +31,9 @@
 
 #include "ns3/ipv4-address.h"
 #include "ns3/simulator.h"
+#include <functional>
+#include <queue>
+#include <unordered_set>
 #include <vector>
 
 namespace ns3 {
@@ -39,6 +42,10 @@ namespace aodv {
  * \ingroup aodv
  *
  * \brief Unique packets identification cache used for simple duplicate detection.
+ *
+ * Entries are kept in a hash set keyed on (address, id) for constant time
+ * lookup.  Expiry is driven by a queue ordered by expiration time, so a purge
+ * only touches the entries which actually expired.
  */
 class IdCache
 {
@@ -80,34 +87,38 @@ public:
     return m_lifetime;
   }
 private:
-  /// Unique packet ID
+  /**
+   * Build the cache key of a (context, id) pair. The ID is supposed to be
+   * unique in single address context (e.g. sender address).
+   * \param addr the IP address
+   * \param id the ID
+   * \returns the key
+   */
+  static uint64_t MakeKey (Ipv4Address addr, uint32_t id)
+  {
+    return (static_cast<uint64_t> (addr.Get ()) << 32) | id;
+  }
+  /// Unique packet ID waiting for expiration
   struct UniqueId
   {
-    /// ID is supposed to be unique in single address context (e.g. sender address)
-    Ipv4Address m_context;
-    /// The id
-    uint32_t m_id;
+    /// Key built by MakeKey
+    uint64_t m_key;
     /// When record will expire
     Time m_expire;
-  };
-  /**
-   * \brief IsExpired structure
-   */
-  struct IsExpired
-  {
     /**
-     * \brief Check if the entry is expired
-     *
-     * \param u UniqueId entry
-     * \return true if expired, false otherwise
+     * \brief Order by expiration time
+     * \param o the other entry
+     * \return true if this entry expires later than \p o
      */
-    bool operator() (const struct UniqueId & u) const
+    bool operator> (const UniqueId & o) const
     {
-      return (u.m_expire < Simulator::Now ());
+      return m_expire > o.m_expire;
     }
   };
   /// Already seen IDs
-  std::vector<UniqueId> m_idCache;
+  std::unordered_set<uint64_t> m_idCache;
+  /// Already seen IDs, earliest expiration first. Holds exactly one element per entry of m_idCache.
+  std::priority_queue<UniqueId, std::vector<UniqueId>, std::greater<UniqueId> > m_expiry;
   /// Default lifetime for ID records
   Time m_lifetime;
 };
@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "aodv-latency-histogram.h"
+#include "ns3/assert.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+namespace aodv {
+
+LatencyHistogram::LatencyHistogram (uint32_t precision)
+{
+  SetPrecision (precision);
+}
+
+void
+LatencyHistogram::SetPrecision (uint32_t precision)
+{
+  NS_ASSERT_MSG (precision >= 1 && precision <= 16, "Precision " << precision << " out of [1, 16]");
+  m_precision = precision;
+  m_counts.clear ();
+  Reset ();
+}
+
+uint32_t
+LatencyHistogram::GetPrecision () const
+{
+  return m_precision;
+}
+
+uint32_t
+LatencyHistogram::GetIndex (uint64_t value) const
+{
+  uint64_t full = 1ULL << m_precision;
+  if (value < full)
+    {
+      return value;
+    }
+  uint64_t half = full >> 1;
+  uint32_t msb = 63 - __builtin_clzll (value);
+  uint32_t shift = msb - m_precision + 1;
+  return full + (shift - 1) * half + ((value >> shift) - half);
+}
+
+uint64_t
+LatencyHistogram::GetHighestEquivalent (uint32_t index) const
+{
+  uint64_t full = 1ULL << m_precision;
+  if (index < full)
+    {
+      return index;
+    }
+  uint64_t half = full >> 1;
+  uint64_t k = index - full;
+  uint32_t shift = k / half + 1;
+  uint64_t sub = k % half + half;
+  // wraps to the largest uint64_t for the last bucket
+  return ((sub + 1) << shift) - 1;
+}
+
+void
+LatencyHistogram::Record (Time latency)
+{
+  if (m_counts.empty ())
+    {
+      uint64_t full = 1ULL << m_precision;
+      m_counts.assign (full + (64 - m_precision) * (full >> 1), 0);
+    }
+  int64_t ns = latency.GetNanoSeconds ();
+  uint64_t value = ns > 0 ? ns : 0;
+  m_counts[GetIndex (value)]++;
+  if (m_count == 0 || value < m_min)
+    {
+      m_min = value;
+    }
+  if (m_count == 0 || value > m_max)
+    {
+      m_max = value;
+    }
+  m_sum += value;
+  m_count++;
+}
+
+void
+LatencyHistogram::Merge (const LatencyHistogram &other)
+{
+  NS_ASSERT_MSG (other.m_precision == m_precision, "Merging histograms of different precisions");
+  if (other.m_count == 0)
+    {
+      return;
+    }
+  if (m_counts.empty ())
+    {
+      m_counts.assign (other.m_counts.size (), 0);
+    }
+  for (uint32_t i = 0; i < m_counts.size (); ++i)
+    {
+      m_counts[i] += other.m_counts[i];
+    }
+  m_min = m_count ? std::min (m_min, other.m_min) : other.m_min;
+  m_max = m_count ? std::max (m_max, other.m_max) : other.m_max;
+  m_sum += other.m_sum;
+  m_count += other.m_count;
+}
+
+void
+LatencyHistogram::Reset ()
+{
+  std::fill (m_counts.begin (), m_counts.end (), 0);
+  m_count = 0;
+  m_sum = 0;
+  m_min = 0;
+  m_max = 0;
+}
+
+uint64_t
+LatencyHistogram::GetCount () const
+{
+  return m_count;
+}
+
+Time
+LatencyHistogram::GetMin () const
+{
+  return NanoSeconds (m_min);
+}
+
+Time
+LatencyHistogram::GetMax () const
+{
+  return NanoSeconds (m_max);
+}
+
+Time
+LatencyHistogram::GetMean () const
+{
+  return NanoSeconds (m_count ? m_sum / m_count : 0);
+}
+
+Time
+LatencyHistogram::GetPercentile (double percentile) const
+{
+  if (m_count == 0)
+    {
+      return Time (0);
+    }
+  percentile = std::min (std::max (percentile, 0.0), 100.0);
+  uint64_t rank = std::max<uint64_t> (1, std::ceil (percentile / 100 * m_count));
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < m_counts.size (); ++i)
+    {
+      seen += m_counts[i];
+      if (seen >= rank)
+        {
+          return NanoSeconds (std::max (m_min, std::min (GetHighestEquivalent (i), m_max)));
+        }
+    }
+  return NanoSeconds (m_max);
+}
+
+void
+LatencyHistogram::Print (std::ostream &os) const
+{
+  os << "count " << m_count
+     << " mean " << GetMean ().GetSeconds ()
+     << " p50 " << GetPercentile (50).GetSeconds ()
+     << " p90 " << GetPercentile (90).GetSeconds ()
+     << " p99 " << GetPercentile (99).GetSeconds ()
+     << " p999 " << GetPercentile (99.9).GetSeconds ()
+     << " max " << GetMax ().GetSeconds ();
+}
+
+std::ostream &
+operator<< (std::ostream &os, const LatencyHistogram &histogram)
+{
+  histogram.Print (os);
+  return os;
+}
+
+} // namespace aodv
+} // namespace ns3
@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AODV_LATENCY_HISTOGRAM_H
+#define AODV_LATENCY_HISTOGRAM_H
+
+#include "ns3/nstime.h"
+#include <ostream>
+#include <vector>
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv
+ *
+ * \brief Log-bucketed latency histogram with fixed memory.
+ *
+ * The layout is the one of HdrHistogram: the latencies, in nanoseconds,
+ * below 2^p are counted exactly, then each power of two range
+ * [2^k, 2^(k+1)) is split in 2^(p-1) linear sub-buckets, so the relative
+ * error of a percentile is at most 2^(1-p) whatever the magnitude of the
+ * latency.  The bucket array covers the whole int64 range, it is
+ * allocated on the first sample (2^p + (64 - p) * 2^(p-1) counters, 15 KiB
+ * with the default precision of 6) and never grows.  The count, sum,
+ * minimum and maximum are kept exactly.
+ */
+class LatencyHistogram
+{
+public:
+  /**
+   * \param precision the number of significant bits p of the buckets,
+   * between 1 and 16
+   */
+  LatencyHistogram (uint32_t precision = 6);
+
+  /**
+   * Set the precision, clears the histogram
+   * \param precision the number of significant bits of the buckets
+   */
+  void SetPrecision (uint32_t precision);
+  /**
+   * \returns the number of significant bits of the buckets
+   */
+  uint32_t GetPrecision () const;
+  /**
+   * Count a latency, negative latencies are counted as zero
+   * \param latency the latency
+   */
+  void Record (Time latency);
+  /**
+   * Add the samples of another histogram of the same precision
+   * \param other the histogram
+   */
+  void Merge (const LatencyHistogram &other);
+  /// Forget all samples, keeps the bucket array
+  void Reset ();
+
+  /**
+   * \returns the number of samples
+   */
+  uint64_t GetCount () const;
+  /**
+   * \returns the smallest sample, zero if none
+   */
+  Time GetMin () const;
+  /**
+   * \returns the largest sample, zero if none
+   */
+  Time GetMax () const;
+  /**
+   * \returns the mean of the samples, zero if none
+   */
+  Time GetMean () const;
+  /**
+   * \param percentile the percentile, between 0 and 100 (99.9 for p999)
+   * \returns the largest latency counted in the bucket of the percentile,
+   * bounded by the largest sample, zero if there is no sample
+   */
+  Time GetPercentile (double percentile) const;
+
+  /**
+   * Print the count, mean, p50, p90, p99, p999 and maximum on one line
+   * \param os the output stream
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  /**
+   * \param value a latency in nanoseconds
+   * \returns the index of its bucket
+   */
+  uint32_t GetIndex (uint64_t value) const;
+  /**
+   * \param index a bucket index
+   * \returns the largest latency, in nanoseconds, counted in the bucket
+   */
+  uint64_t GetHighestEquivalent (uint32_t index) const;
+
+  uint32_t m_precision;          ///< Significant bits of the buckets
+  std::vector<uint64_t> m_counts; ///< Bucket counters, empty until the first sample
+  uint64_t m_count;              ///< Number of samples
+  uint64_t m_sum;                ///< Sum of the samples, in nanoseconds
+  uint64_t m_min;                ///< Smallest sample, in nanoseconds
+  uint64_t m_max;                ///< Largest sample, in nanoseconds
+};
+
+/**
+ * \brief Print the histogram, see LatencyHistogram::Print
+ * \param os the output stream
+ * \param histogram the histogram
+ * \returns the output stream
+ */
+std::ostream & operator<< (std::ostream &os, const LatencyHistogram &histogram);
+
+} // namespace aodv
+} // namespace ns3
+
+#endif /* AODV_LATENCY_HISTOGRAM_H */
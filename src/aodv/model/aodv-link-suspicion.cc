@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "aodv-link-suspicion.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <limits>
+
+namespace ns3 {
+namespace aodv {
+
+/// Number of addresses below which the expired ones are not pruned
+static const uint32_t MIN_PRUNE_SIZE = 64;
+
+LinkSuspicion::LinkSuspicion ()
+  : m_pruneSize (MIN_PRUNE_SIZE)
+{
+}
+
+void
+LinkSuspicion::NeighborHeard (Ipv4Address neighbor, Time expire)
+{
+  m_heardNeighbors[neighbor] = expire;
+  Prune ();
+}
+
+void
+LinkSuspicion::RequestReceived (Ipv4Address origin, uint32_t id, Ipv4Address neighbor,
+                                Ipv4Address second, uint8_t hopCount, Time expire)
+{
+  // every copy: the second hop is in radio range of the neighbor
+  std::unordered_map<Ipv4Address, SecondHop, Ipv4AddressHash>::iterator j = m_secondHops.find (second);
+  if (j == m_secondHops.end ())
+    {
+      SecondHop secondHop;
+      secondHop.m_neighbor = neighbor;
+      secondHop.m_expire = expire;
+      m_secondHops[second] = secondHop;
+    }
+  else
+    {
+      if (j->second.m_neighbor != neighbor)
+        {
+          j->second.m_otherNeighbor = j->second.m_neighbor;
+          j->second.m_otherExpire = j->second.m_expire;
+          j->second.m_neighbor = neighbor;
+        }
+      j->second.m_expire = expire;
+    }
+  Prune ();
+
+  std::unordered_map<Ipv4Address, Flood, Ipv4AddressHash>::iterator i = m_floods.find (origin);
+  if (i == m_floods.end () || i->second.m_id != id)
+    {
+      Flood flood;
+      flood.m_id = id;
+      flood.m_neighbor = neighbor;
+      flood.m_hopCount = hopCount;
+      flood.m_otherHopCount = std::numeric_limits<uint8_t>::max ();
+      m_floods[origin] = flood;
+    }
+  else if (neighbor != i->second.m_neighbor)
+    {
+      i->second.m_otherHopCount = std::min (i->second.m_otherHopCount, hopCount);
+    }
+}
+
+bool
+LinkSuspicion::IsKnown (Ipv4Address address, Ipv4Address neighbor) const
+{
+  Time now = Simulator::Now ();
+  std::unordered_map<Ipv4Address, Time, Ipv4AddressHash>::const_iterator i =
+    m_heardNeighbors.find (address);
+  if (i != m_heardNeighbors.end () && i->second > now)
+    {
+      return true;
+    }
+  std::unordered_map<Ipv4Address, SecondHop, Ipv4AddressHash>::const_iterator j =
+    m_secondHops.find (address);
+  if (j == m_secondHops.end ())
+    {
+      return false;
+    }
+  return (j->second.m_neighbor != neighbor && j->second.m_expire > now)
+         || (j->second.m_otherNeighbor != neighbor && j->second.m_otherExpire > now);
+}
+
+bool
+LinkSuspicion::IsSuspicious (Ipv4Address origin, Ipv4Address neighbor, Ipv4Address second) const
+{
+  if (second == Ipv4Address::GetAny () || second == origin || IsKnown (second, neighbor))
+    {
+      return false;
+    }
+  // a route not set by the first copy of the last flood cannot be vouched for
+  std::unordered_map<Ipv4Address, Flood, Ipv4AddressHash>::const_iterator i = m_floods.find (origin);
+  if (i == m_floods.end () || i->second.m_neighbor != neighbor)
+    {
+      return true;
+    }
+  return i->second.m_hopCount < i->second.m_otherHopCount;
+}
+
+void
+LinkSuspicion::Prune ()
+{
+  if (GetNAddresses () < m_pruneSize)
+    {
+      return;
+    }
+  Time now = Simulator::Now ();
+  for (std::unordered_map<Ipv4Address, Time, Ipv4AddressHash>::iterator i = m_heardNeighbors.begin ();
+       i != m_heardNeighbors.end ();)
+    {
+      if (i->second > now)
+        {
+          ++i;
+        }
+      else
+        {
+          i = m_heardNeighbors.erase (i);
+        }
+    }
+  for (std::unordered_map<Ipv4Address, SecondHop, Ipv4AddressHash>::iterator j = m_secondHops.begin ();
+       j != m_secondHops.end ();)
+    {
+      if (j->second.m_expire > now || j->second.m_otherExpire > now)
+        {
+          ++j;
+        }
+      else
+        {
+          j = m_secondHops.erase (j);
+        }
+    }
+  m_pruneSize = std::max (MIN_PRUNE_SIZE, 2 * GetNAddresses ());
+}
+
+uint32_t
+LinkSuspicion::GetNAddresses () const
+{
+  return static_cast<uint32_t> (m_heardNeighbors.size () + m_secondHops.size ());
+}
+
+void
+LinkSuspicion::Clear ()
+{
+  m_floods.clear ();
+  m_heardNeighbors.clear ();
+  m_secondHops.clear ();
+  m_pruneSize = MIN_PRUNE_SIZE;
+}
+
+} // namespace aodv
+} // namespace ns3
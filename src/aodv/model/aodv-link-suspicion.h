@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef AODV_LINK_SUSPICION_H
+#define AODV_LINK_SUSPICION_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <unordered_map>
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv
+ *
+ * \brief Wormhole suspicion of the reverse routes, from overheard control messages.
+ *
+ * The reverse route towards the originator of a RREQ goes through the
+ * neighbor of its first copy and the second hop reported in that copy.  The
+ * link between them is suspicious, and worth a WHCS, when nothing the node
+ * heard shows it in radio range:
+ * - the second hop is neither the originator itself, nor a neighbor heard
+ *   recently by HELLO, RREQ or RREP, nor the second hop of a recent copy
+ *   of a RREQ from another neighbor;
+ * - and the first copy was strictly shorter than all the copies of the
+ *   same flood from the other neighbors, as the shortcut of a tunnel is.
+ *
+ * A link with a known neighbor second hop, or which was not a shortcut, is
+ * trusted.  The addresses heard are kept until they expire, and the
+ * expired ones are pruned whenever the number of addresses doubles, so
+ * an observation costs a few hash lookups.
+ */
+class LinkSuspicion
+{
+public:
+  LinkSuspicion ();
+
+  /**
+   * Count a HELLO, or any other message received directly from a neighbor
+   * \param neighbor the neighbor
+   * \param expire the time the neighbor is lost if it is not heard again
+   */
+  void NeighborHeard (Ipv4Address neighbor, Time expire);
+  /**
+   * Count a RREQ, before the duplicates are dropped
+   * \param origin the originator of the RREQ
+   * \param id the RREQ ID
+   * \param neighbor the neighbor the RREQ was received from
+   * \param second the node the neighbor received the RREQ from
+   * \param hopCount the hop count of the RREQ
+   * \param expire the time the second hop is forgotten if it is not reported again
+   */
+  void RequestReceived (Ipv4Address origin, uint32_t id, Ipv4Address neighbor, Ipv4Address second,
+                        uint8_t hopCount, Time expire);
+
+  /**
+   * \param origin the originator of the route
+   * \param neighbor the next hop towards the originator
+   * \param second the second hop towards the originator
+   * \returns true if the link from the neighbor to the second hop may be a tunnel
+   */
+  bool IsSuspicious (Ipv4Address origin, Ipv4Address neighbor, Ipv4Address second) const;
+  /**
+   * \returns the number of neighbors and second hops remembered, expired or not
+   */
+  uint32_t GetNAddresses () const;
+  /// Forget all observations
+  void Clear ();
+
+private:
+  /**
+   * \param address an address
+   * \param neighbor a neighbor
+   * \returns true if address was heard directly recently, or reported as
+   * second hop by another neighbor than neighbor
+   */
+  bool IsKnown (Ipv4Address address, Ipv4Address neighbor) const;
+  /// Forget the expired addresses once their number has doubled since the last time
+  void Prune ();
+
+  /// Copies of the last RREQ of an originator
+  struct Flood
+  {
+    uint32_t m_id;              ///< RREQ ID
+    Ipv4Address m_neighbor;     ///< Neighbor of the first copy
+    uint8_t m_hopCount;         ///< Hop count of the first copy
+    uint8_t m_otherHopCount;    ///< Smallest hop count of the copies from the other neighbors
+  };
+  /// Second hop reported in the RREQ
+  struct SecondHop
+  {
+    Ipv4Address m_neighbor;       ///< Neighbor of the last report
+    Time m_expire;                ///< Expiration of the last report
+    Ipv4Address m_otherNeighbor;  ///< Neighbor of the last report from another neighbor
+    Time m_otherExpire;           ///< Expiration of the last report from another neighbor
+  };
+
+  /// Last RREQ of each originator
+  std::unordered_map<Ipv4Address, Flood, Ipv4AddressHash> m_floods;
+  /// Expiration time of the neighbors heard directly
+  std::unordered_map<Ipv4Address, Time, Ipv4AddressHash> m_heardNeighbors;
+  /// Second hops reported in the RREQ
+  std::unordered_map<Ipv4Address, SecondHop, Ipv4AddressHash> m_secondHops;
+  /// Number of addresses from which the expired ones are pruned
+  uint32_t m_pruneSize;
+};
+
+} // namespace aodv
+} // namespace ns3
+
+#endif /* AODV_LINK_SUSPICION_H */
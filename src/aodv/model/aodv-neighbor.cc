@@ -37,7 +37,9 @@ NS_LOG_COMPONENT_DEFINE ("AodvNeighbors");
 
 namespace aodv {
 Neighbors::Neighbors (Time delay)
-  : m_ntimer (Timer::CANCEL_ON_DESTROY)
+  : m_ntimer (Timer::CANCEL_ON_DESTROY),
+    m_added (0),
+    m_closed (false)
 {
   m_ntimer.SetDelay (delay);
   m_ntimer.SetFunction (&Neighbors::Purge, this);
@@ -48,28 +50,17 @@ bool
 Neighbors::IsNeighbor (Ipv4Address addr)
 {
   Purge ();
-  for (std::vector<Neighbor>::const_iterator i = m_nb.begin ();
-       i != m_nb.end (); ++i)
-    {
-      if (i->m_neighborAddress == addr)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_nb.find (addr) != m_nb.end ();
 }
 
 Time
 Neighbors::GetExpireTime (Ipv4Address addr)
 {
   Purge ();
-  for (std::vector<Neighbor>::const_iterator i = m_nb.begin (); i
-       != m_nb.end (); ++i)
+  NeighborMap::const_iterator i = m_nb.find (addr);
+  if (i != m_nb.end ())
     {
-      if (i->m_neighborAddress == addr)
-        {
-          return (i->m_expireTime - Simulator::Now ());
-        }
+      return (i->second.m_neighbor.m_expireTime - Simulator::Now ());
     }
   return Seconds (0);
 }
@@ -77,26 +68,47 @@ Neighbors::GetExpireTime (Ipv4Address addr)
 void
 Neighbors::Update (Ipv4Address addr, Time expire)
 {
-  for (std::vector<Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+  NeighborMap::iterator i = m_nb.find (addr);
+  if (i != m_nb.end ())
     {
-      if (i->m_neighborAddress == addr)
+      Neighbor &nb = i->second.m_neighbor;
+      if (expire + Simulator::Now () > nb.m_expireTime)
         {
-          i->m_expireTime
-            = std::max (expire + Simulator::Now (), i->m_expireTime);
-          if (i->m_hardwareAddress == Mac48Address ())
-            {
-              i->m_hardwareAddress = LookupMacAddress (i->m_neighborAddress);
-            }
-          return;
+          nb.m_expireTime = expire + Simulator::Now ();
+          QueueExpiry (nb);
+        }
+      if (nb.m_hardwareAddress == Mac48Address ())
+        {
+          nb.m_hardwareAddress = LookupMacAddress (nb.m_neighborAddress);
         }
+      return;
     }
 
   NS_LOG_LOGIC ("Open link to " << addr);
-  Neighbor neighbor (addr, LookupMacAddress (addr), expire + Simulator::Now ());
-  m_nb.push_back (neighbor);
+  Entry entry = { Neighbor (addr, LookupMacAddress (addr), expire + Simulator::Now ()), m_added++ };
+  m_nb.insert (std::make_pair (addr, entry));
+  QueueExpiry (entry.m_neighbor);
   Purge ();
 }
 
+void
+Neighbors::QueueExpiry (Neighbor const & nb)
+{
+  Expiry expiry = { nb.m_neighborAddress, nb.m_expireTime };
+  m_expiry.push (expiry);
+  // neighbors refreshed by every packet leave many outdated elements, drop them
+  if (m_expiry.size () > 2 * m_nb.size () + 64)
+    {
+      ExpiryQueue expiries;
+      for (NeighborMap::const_iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+        {
+          Expiry current = { i->first, i->second.m_neighbor.m_expireTime };
+          expiries.push (current);
+        }
+      m_expiry.swap (expiries);
+    }
+}
+
 /**
  * \brief CloseNeighbor structure
  */
@@ -122,19 +134,63 @@ Neighbors::Purge ()
       return;
     }
 
+  // the closed links, with the rank of the neighbor
   CloseNeighbor pred;
-  if (!m_handleLinkFailure.IsNull ())
+  std::vector<std::pair<uint64_t, Ipv4Address> > closed;
+  if (m_closed)
     {
-      for (std::vector<Neighbor>::iterator j = m_nb.begin (); j != m_nb.end (); ++j)
+      for (NeighborMap::const_iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+        {
+          if (i->second.m_neighbor.close)
+            {
+              closed.push_back (std::make_pair (i->second.m_order, i->first));
+            }
+        }
+      m_closed = false;
+    }
+  Time now = Simulator::Now ();
+  while (!m_expiry.empty () && m_expiry.top ().m_expire < now)
+    {
+      NeighborMap::const_iterator i = m_nb.find (m_expiry.top ().m_address);
+      m_expiry.pop ();
+      // skip the neighbors removed or extended since
+      if (i != m_nb.end () && pred (i->second.m_neighbor))
+        {
+          closed.push_back (std::make_pair (i->second.m_order, i->first));
+        }
+    }
+  std::sort (closed.begin (), closed.end ());
+  closed.erase (std::unique (closed.begin (), closed.end ()), closed.end ());
+
+  if (!closed.empty ())
+    {
+      std::vector<Ipv4Address> addresses;
+      for (std::vector<std::pair<uint64_t, Ipv4Address> >::const_iterator j = closed.begin ();
+           j != closed.end (); ++j)
+        {
+          NS_LOG_LOGIC ("Close link to " << j->second);
+          addresses.push_back (j->second);
+        }
+      if (!m_handleLinkFailures.IsNull ())
+        {
+          m_handleLinkFailures (addresses);
+        }
+      else if (!m_handleLinkFailure.IsNull ())
+        {
+          for (std::vector<Ipv4Address>::const_iterator j = addresses.begin (); j != addresses.end (); ++j)
+            {
+              m_handleLinkFailure (*j);
+            }
+        }
+      for (std::vector<Ipv4Address>::const_iterator j = addresses.begin (); j != addresses.end (); ++j)
         {
-          if (pred (*j))
+          NeighborMap::iterator i = m_nb.find (*j);
+          if (i != m_nb.end () && pred (i->second.m_neighbor))
             {
-              NS_LOG_LOGIC ("Close link to " << j->m_neighborAddress);
-              m_handleLinkFailure (j->m_neighborAddress);
+              m_nb.erase (i);
             }
         }
     }
-  m_nb.erase (std::remove_if (m_nb.begin (), m_nb.end (), pred), m_nb.end ());
   m_ntimer.Cancel ();
   m_ntimer.Schedule ();
 }
@@ -180,11 +236,12 @@ Neighbors::ProcessTxError (WifiMacHeader const & hdr)
 {
   Mac48Address addr = hdr.GetAddr1 ();
 
-  for (std::vector<Neighbor>::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
+  for (NeighborMap::iterator i = m_nb.begin (); i != m_nb.end (); ++i)
     {
-      if (i->m_hardwareAddress == addr)
+      if (i->second.m_neighbor.m_hardwareAddress == addr)
         {
-          i->close = true;
+          i->second.m_neighbor.close = true;
+          m_closed = true;
         }
     }
   Purge ();
@@ -29,6 +29,9 @@
 #ifndef AODVNEIGHBOR_H
 #define AODVNEIGHBOR_H
 
+#include <functional>
+#include <queue>
+#include <unordered_map>
 #include <vector>
 #include "ns3/simulator.h"
 #include "ns3/timer.h"
@@ -47,6 +50,11 @@ class RoutingProtocol;
 /**
  * \ingroup aodv
  * \brief maintain list of active neighbors
+ *
+ * Neighbors are kept in a hash map keyed on their address, and their expire
+ * times in a queue, so that a purge only touches the neighbors which
+ * actually expired.  The links closed by a purge are reported at once, in
+ * the order the neighbors were added, to the link failure callbacks.
  */
 class Neighbors
 {
@@ -109,6 +117,8 @@ public:
   void Clear ()
   {
     m_nb.clear ();
+    m_expiry = ExpiryQueue ();
+    m_closed = false;
   }
 
   /**
@@ -146,16 +156,69 @@ public:
   {
     return m_handleLinkFailure;
   }
+  /**
+   * Set the callback notified once per purge with all the closed links,
+   * instead of the link failure callback
+   * \param cb the callback function
+   */
+  void SetBatchCallback (Callback<void, std::vector<Ipv4Address> const &> cb)
+  {
+    m_handleLinkFailures = cb;
+  }
 
 private:
+  /// Neighbor with the rank of its addition
+  struct Entry
+  {
+    /// The neighbor
+    Neighbor m_neighbor;
+    /// Number of neighbors added before this one
+    uint64_t m_order;
+  };
+  /// Expire time of a neighbor waiting for expiration
+  struct Expiry
+  {
+    /// Neighbor IPv4 address
+    Ipv4Address m_address;
+    /// Expire time of the neighbor when it was queued
+    Time m_expire;
+    /**
+     * \brief Order by expiration time
+     * \param o the other element
+     * \return true if this element expires later than \p o
+     */
+    bool operator> (const Expiry & o) const
+    {
+      return m_expire > o.m_expire;
+    }
+  };
+  /// Queue of expire times, earliest expiration first
+  typedef std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry> > ExpiryQueue;
+  /// Neighbors by address
+  typedef std::unordered_map<Ipv4Address, Entry, Ipv4AddressHash> NeighborMap;
+
+  /**
+   * Queue the expire time of a neighbor, after it was added or extended.
+   * \param nb the neighbor
+   */
+  void QueueExpiry (Neighbor const & nb);
+
   /// link failure callback
   Callback<void, Ipv4Address> m_handleLinkFailure;
+  /// link failure callback, with all the links closed by a purge
+  Callback<void, std::vector<Ipv4Address> const &> m_handleLinkFailures;
   /// TX error callback
   Callback<void, WifiMacHeader const &> m_txErrorCallback;
   /// Timer for neighbor's list. Schedule Purge().
   Timer m_ntimer;
-  /// vector of entries
-  std::vector<Neighbor> m_nb;
+  /// neighbors by address
+  NeighborMap m_nb;
+  /// expire times of the neighbors, may hold several elements per neighbor
+  ExpiryQueue m_expiry;
+  /// number of neighbors ever added
+  uint64_t m_added;
+  /// whether a neighbor was closed by a TX error
+  bool m_closed;
   /// list of ARP cached to be used for layer 2 notifications processing
   std::vector<Ptr<ArpCache> > m_arp;
 
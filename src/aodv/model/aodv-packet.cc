@@ -32,6 +32,97 @@
 namespace ns3 {
 namespace aodv {
 
+namespace {
+
+/// Flag of the messages serialized in the compact encoding
+const uint8_t COMPACT_FLAG = 1 << 0;
+
+/**
+ * \param v a value
+ * \return the number of bytes of the value as a varint
+ */
+uint32_t
+GetVarintSize (uint32_t v)
+{
+  uint32_t size = 1;
+  while (v >= 0x80)
+    {
+      v >>= 7;
+      ++size;
+    }
+  return size;
+}
+
+/**
+ * \brief Write a varint: 7 bits per byte, low bits first, the high bit
+ * set on all the bytes but the last
+ * \param i the buffer iterator
+ * \param v the value
+ */
+void
+WriteVarint (Buffer::Iterator &i, uint32_t v)
+{
+  while (v >= 0x80)
+    {
+      i.WriteU8 (uint8_t (v | 0x80));
+      v >>= 7;
+    }
+  i.WriteU8 (uint8_t (v));
+}
+
+/**
+ * \brief Read a varint written by WriteVarint
+ * \param i the buffer iterator
+ * \return the value
+ */
+uint32_t
+ReadVarint (Buffer::Iterator &i)
+{
+  uint32_t v = 0;
+  for (uint32_t shift = 0; shift < 35; shift += 7)
+    {
+      uint8_t byte = i.ReadU8 ();
+      v |= uint32_t (byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        {
+          break;
+        }
+    }
+  return v;
+}
+
+/**
+ * \param a an address
+ * \return true if the address is sent in the compact encoding
+ */
+bool
+IsPresent (Ipv4Address a)
+{
+  return a != Ipv4Address::GetAny ();
+}
+
+/**
+ * \brief Read an address of the compact encoding
+ * \param i the buffer iterator
+ * \param present the presence bits
+ * \param bit the presence bit of the address
+ * \param a the address, 0.0.0.0 if not present
+ */
+void
+ReadIfPresent (Buffer::Iterator &i, uint8_t present, uint8_t bit, Ipv4Address &a)
+{
+  if (present & bit)
+    {
+      ReadFrom (i, a);
+    }
+  else
+    {
+      a = Ipv4Address::GetAny ();
+    }
+}
+
+} // unnamed namespace
+
 NS_OBJECT_ENSURE_REGISTERED (TypeHeader);
 
 TypeHeader::TypeHeader (MessageType t)
@@ -83,6 +174,7 @@ TypeHeader::Deserialize (Buffer::Iterator start)
     case AODVTYPE_RREP_ACK:
     case AODVTYPE_WHCS:
     case AODVTYPE_WHCE:
+    case AODVTYPE_WHCS_BATCH:
       {
         m_type = (MessageType) type;
         break;
@@ -130,6 +222,11 @@ TypeHeader::Print (std::ostream &os) const
         os << "WHCE";
         break;
       }
+      case AODVTYPE_WHCS_BATCH:
+      {
+        os << "WHCS_BATCH";
+        break;
+      }
     default:
       os << "UNKNOWN_TYPE";
     }
@@ -312,6 +409,85 @@ RreqHeader::operator== (RreqHeader const & o) const
 }
 
 
+//-----------------------------------------------------------------------------
+// Forward prefix
+//-----------------------------------------------------------------------------
+
+ForwardPrefixHeader::ForwardPrefixHeader (uint8_t flags, uint8_t second, uint8_t hopCount)
+  : m_flags (flags),
+    m_second (second),
+    m_hopCount (hopCount)
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ForwardPrefixHeader);
+
+TypeId
+ForwardPrefixHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::aodv::ForwardPrefixHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<ForwardPrefixHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+ForwardPrefixHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+ForwardPrefixHeader::GetSerializedSize () const
+{
+  return 3;
+}
+
+void
+ForwardPrefixHeader::Serialize (Buffer::Iterator i) const
+{
+  i.WriteU8 (m_flags);
+  i.WriteU8 (m_second);
+  i.WriteU8 (m_hopCount);
+}
+
+uint32_t
+ForwardPrefixHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_flags = i.ReadU8 ();
+  m_second = i.ReadU8 ();
+  m_hopCount = i.ReadU8 ();
+  return i.GetDistanceFrom (start);
+}
+
+void
+ForwardPrefixHeader::Print (std::ostream &os) const
+{
+  os << "flags " << uint32_t (m_flags) << " " << uint32_t (m_second)
+     << " hop count " << uint32_t (m_hopCount);
+}
+
+Ptr<Packet>
+ForwardPrefixHeader::Patch (Ptr<const Packet> message) const
+{
+  // the metadata of the rest of the message becomes a fragment of its header
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddAtEnd (message);
+  packet->RemoveAllByteTags ();
+  packet->RemoveAtStart (GetSerializedSize ());
+  packet->AddHeader (*this);
+  return packet;
+}
+
+bool
+ForwardPrefixHeader::operator== (ForwardPrefixHeader const & o) const
+{
+  return (m_flags == o.m_flags && m_second == o.m_second && m_hopCount == o.m_hopCount);
+}
+
 //-----------------------------------------------------------------------------
 // WHCS
 //-----------------------------------------------------------------------------
@@ -360,6 +536,12 @@ WHCheckHeader::GetInstanceTypeId () const
 uint32_t
 WHCheckHeader::GetSerializedSize () const
 {
+  if (GetCompact ())
+    {
+      return 3 + 1 + GetVarintSize (m_WHCheckID) + 4 * IsPresent (m_fir) + GetVarintSize (m_firSeqNo)
+             + 4 * IsPresent (m_origin) + GetVarintSize (m_originSeqNo) + 4 * IsPresent (m_sec)
+             + 4 * IsPresent (m_src) + 4 * IsPresent (m_dst) + 2 + GetVarintSize (m_rreq_id);
+    }
   //38+1(WH攻撃を行ったかわかる用のフラグ)
   //return 38;
   return 39 + 4/*RREQのID分*/;
@@ -370,9 +552,42 @@ WHCheckHeader::GetSerializedSize () const
 void
 WHCheckHeader::Serialize (Buffer::Iterator i) const
 {
+  // ForwardPrefixHeader
   i.WriteU8 (m_flags);
-  i.WriteU8 (m_reserved);
+  i.WriteU8 (m_whf);
   i.WriteU8 (m_hopCount);
+  if (GetCompact ())
+    {
+      i.WriteU8 (IsPresent (m_fir) | IsPresent (m_origin) << 1 | IsPresent (m_sec) << 2
+                 | IsPresent (m_src) << 3 | IsPresent (m_dst) << 4);
+      WriteVarint (i, m_WHCheckID);
+      if (IsPresent (m_fir))
+        {
+          WriteTo (i, m_fir);
+        }
+      WriteVarint (i, m_firSeqNo);
+      if (IsPresent (m_origin))
+        {
+          WriteTo (i, m_origin);
+        }
+      WriteVarint (i, m_originSeqNo);
+      if (IsPresent (m_sec))
+        {
+          WriteTo (i, m_sec);
+        }
+      if (IsPresent (m_src))
+        {
+          WriteTo (i, m_src);
+        }
+      if (IsPresent (m_dst))
+        {
+          WriteTo (i, m_dst);
+        }
+      i.WriteU8 (m_rrepid);
+      i.WriteU8 (m_WHflag);
+      WriteVarint (i, m_rreq_id);
+      return;
+    }
   i.WriteHtonU32 (m_WHCheckID);
   WriteTo (i, m_fir);
   i.WriteHtonU32 (m_firSeqNo);
@@ -381,7 +596,7 @@ WHCheckHeader::Serialize (Buffer::Iterator i) const
   WriteTo (i, m_sec);
   WriteTo (i, m_src);
   WriteTo (i, m_dst);
-  i.WriteU8 (m_whf);
+  i.WriteU8 (m_reserved);
   i.WriteU8 (m_rrepid);
   //WH攻撃を行ったかわかる用のフラグ
   i.WriteU8 (m_WHflag);
@@ -393,8 +608,25 @@ WHCheckHeader::Deserialize (Buffer::Iterator start)
 {
   Buffer::Iterator i = start;
   m_flags = i.ReadU8 ();
-  m_reserved = i.ReadU8 ();
+  m_whf = i.ReadU8 ();
   m_hopCount = i.ReadU8 ();
+  if (GetCompact ())
+    {
+      uint8_t present = i.ReadU8 ();
+      m_WHCheckID = ReadVarint (i);
+      ReadIfPresent (i, present, 1 << 0, m_fir);
+      m_firSeqNo = ReadVarint (i);
+      ReadIfPresent (i, present, 1 << 1, m_origin);
+      m_originSeqNo = ReadVarint (i);
+      ReadIfPresent (i, present, 1 << 2, m_sec);
+      ReadIfPresent (i, present, 1 << 3, m_src);
+      ReadIfPresent (i, present, 1 << 4, m_dst);
+      m_reserved = 0;
+      m_rrepid = i.ReadU8 ();
+      m_WHflag = i.ReadU8 ();
+      m_rreq_id = ReadVarint (i);
+      return i.GetDistanceFrom (start);
+    }
   m_WHCheckID = i.ReadNtohU32 ();
   ReadFrom (i, m_fir);
   m_firSeqNo = i.ReadNtohU32 ();
@@ -403,7 +635,7 @@ WHCheckHeader::Deserialize (Buffer::Iterator start)
   ReadFrom (i, m_sec);
   ReadFrom (i, m_src);
   ReadFrom (i, m_dst);
-  m_whf = i.ReadU8 ();
+  m_reserved = i.ReadU8 ();
   m_rrepid = i.ReadU8 ();
 
   //WH攻撃を行ったかわかる用のフラグ
@@ -495,6 +727,31 @@ WHCheckHeader::GetUnknownSeqno () const
   return (m_flags & (1 << 3));
 }
 
+void
+WHCheckHeader::SetCompact (bool f)
+{
+  if (f)
+    {
+      m_flags |= COMPACT_FLAG;
+    }
+  else
+    {
+      m_flags &= ~COMPACT_FLAG;
+    }
+}
+
+bool
+WHCheckHeader::GetCompact () const
+{
+  return (m_flags & COMPACT_FLAG);
+}
+
+ForwardPrefixHeader
+WHCheckHeader::GetForwardPrefix () const
+{
+  return ForwardPrefixHeader (m_flags, m_whf, m_hopCount);
+}
+
 bool
 WHCheckHeader::operator== (WHCheckHeader const & o) const
 {
@@ -506,6 +763,169 @@ WHCheckHeader::operator== (WHCheckHeader const & o) const
 }
 
 
+//-----------------------------------------------------------------------------
+// WHCS_BATCH
+//-----------------------------------------------------------------------------
+
+bool
+WHCheckBatchEntry::operator== (WHCheckBatchEntry const & o) const
+{
+  return (origin == o.origin && originSeqNo == o.originSeqNo && id == o.id
+          && fir == o.fir && sec == o.sec && hopCount == o.hopCount && whf == o.whf);
+}
+
+WHCheckBatchHeader::WHCheckBatchHeader ()
+  : m_groups (0)
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (WHCheckBatchHeader);
+
+TypeId
+WHCheckBatchHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::aodv::WHCheckBatchHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<WHCheckBatchHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+WHCheckBatchHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+WHCheckBatchHeader::GetSerializedSize () const
+{
+  return 1 + 5 * m_groups + 18 * m_entries.size ();
+}
+
+void
+WHCheckBatchHeader::Serialize (Buffer::Iterator i) const
+{
+  i.WriteU8 (m_groups);
+  for (std::vector<WHCheckBatchEntry>::const_iterator group = m_entries.begin ();
+       group != m_entries.end (); )
+    {
+      std::vector<WHCheckBatchEntry>::const_iterator end = group;
+      while (end != m_entries.end () && end->origin == group->origin)
+        {
+          ++end;
+        }
+      WriteTo (i, group->origin);
+      i.WriteU8 (end - group);
+      for (; group != end; ++group)
+        {
+          i.WriteHtonU32 (group->id);
+          i.WriteHtonU32 (group->originSeqNo);
+          WriteTo (i, group->fir);
+          WriteTo (i, group->sec);
+          i.WriteU8 (group->hopCount);
+          i.WriteU8 (group->whf);
+        }
+    }
+}
+
+uint32_t
+WHCheckBatchHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_entries.clear ();
+  m_groups = i.ReadU8 ();
+  for (uint8_t g = 0; g < m_groups; ++g)
+    {
+      WHCheckBatchEntry entry;
+      ReadFrom (i, entry.origin);
+      uint8_t count = i.ReadU8 ();
+      for (uint8_t k = 0; k < count; ++k)
+        {
+          entry.id = i.ReadNtohU32 ();
+          entry.originSeqNo = i.ReadNtohU32 ();
+          ReadFrom (i, entry.fir);
+          ReadFrom (i, entry.sec);
+          entry.hopCount = i.ReadU8 ();
+          entry.whf = i.ReadU8 ();
+          m_entries.push_back (entry);
+        }
+    }
+
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+WHCheckBatchHeader::Print (std::ostream &os) const
+{
+  os << m_entries.size () << " checks from " << (uint32_t) m_groups << " originators:";
+  for (std::vector<WHCheckBatchEntry>::const_iterator i = m_entries.begin (); i != m_entries.end (); ++i)
+    {
+      os << " [WHCS ID " << i->id << " origin " << i->origin << " sequence number " << i->originSeqNo
+         << " first " << i->fir << " second " << i->sec << " hop count " << (uint32_t) i->hopCount
+         << " WHF " << (uint32_t) i->whf << "]";
+    }
+}
+
+std::ostream &
+operator<< (std::ostream & os, WHCheckBatchHeader const & h)
+{
+  h.Print (os);
+  return os;
+}
+
+bool
+WHCheckBatchHeader::AddEntry (WHCheckBatchEntry const & entry)
+{
+  if (m_entries.size () >= MAX_ENTRIES)
+    {
+      return false;
+    }
+  std::vector<WHCheckBatchEntry>::iterator pos = m_entries.end ();
+  for (std::vector<WHCheckBatchEntry>::iterator i = m_entries.begin (); i != m_entries.end (); ++i)
+    {
+      if (i->origin == entry.origin)
+        {
+          pos = i + 1;
+        }
+    }
+  if (pos == m_entries.end () && (m_entries.empty () || m_entries.back ().origin != entry.origin))
+    {
+      m_groups++;
+    }
+  m_entries.insert (pos, entry);
+  return true;
+}
+
+uint32_t
+WHCheckBatchHeader::GetNEntries () const
+{
+  return m_entries.size ();
+}
+
+WHCheckBatchEntry const &
+WHCheckBatchHeader::GetEntry (uint32_t i) const
+{
+  NS_ASSERT (i < m_entries.size ());
+  return m_entries[i];
+}
+
+void
+WHCheckBatchHeader::Clear ()
+{
+  m_entries.clear ();
+  m_groups = 0;
+}
+
+bool
+WHCheckBatchHeader::operator== (WHCheckBatchHeader const & o) const
+{
+  return m_entries == o.m_entries;
+}
+
 //-----------------------------------------------------------------------------
 // WHCE
 //-----------------------------------------------------------------------------
@@ -554,6 +974,12 @@ WHEndHeader::GetInstanceTypeId () const
 uint32_t
 WHEndHeader::GetSerializedSize () const
 {
+  if (GetCompact ())
+    {
+      return 3 + 1 + GetVarintSize (m_WHEndID) + 4 * IsPresent (m_dst) + GetVarintSize (m_dstSeqNo)
+             + 4 * IsPresent (m_origin) + 4 * IsPresent (m_source) + 4 * IsPresent (m_aodv_dst)
+             + GetVarintSize (m_lifeTime) + 2 + GetVarintSize (m_rreq_id);
+    }
   //return 32;
   //32+1(フラグ用)
   return 33 + 4/*RREQのID分*/;
@@ -564,9 +990,38 @@ WHEndHeader::GetSerializedSize () const
 void
 WHEndHeader::Serialize (Buffer::Iterator i) const
 {
+  // ForwardPrefixHeader
   i.WriteU8 (m_flags);
   i.WriteU8 (m_prefixSize);
   i.WriteU8 (m_hopCount);
+  if (GetCompact ())
+    {
+      i.WriteU8 (IsPresent (m_dst) | IsPresent (m_origin) << 1 | IsPresent (m_source) << 2
+                 | IsPresent (m_aodv_dst) << 3);
+      WriteVarint (i, m_WHEndID);
+      if (IsPresent (m_dst))
+        {
+          WriteTo (i, m_dst);
+        }
+      WriteVarint (i, m_dstSeqNo);
+      if (IsPresent (m_origin))
+        {
+          WriteTo (i, m_origin);
+        }
+      if (IsPresent (m_source))
+        {
+          WriteTo (i, m_source);
+        }
+      if (IsPresent (m_aodv_dst))
+        {
+          WriteTo (i, m_aodv_dst);
+        }
+      WriteVarint (i, m_lifeTime);
+      i.WriteU8 (m_rrepid);
+      i.WriteU8 (m_WHflag);
+      WriteVarint (i, m_rreq_id);
+      return;
+    }
   i.WriteHtonU32 (m_WHEndID);
   WriteTo (i, m_dst);
   i.WriteHtonU32 (m_dstSeqNo);
@@ -590,6 +1045,22 @@ WHEndHeader::Deserialize (Buffer::Iterator start)
   m_flags = i.ReadU8 ();
   m_prefixSize = i.ReadU8 ();
   m_hopCount = i.ReadU8 ();
+  if (GetCompact ())
+    {
+      uint8_t present = i.ReadU8 ();
+      m_WHEndID = ReadVarint (i);
+      ReadIfPresent (i, present, 1 << 0, m_dst);
+      m_dstSeqNo = ReadVarint (i);
+      ReadIfPresent (i, present, 1 << 1, m_origin);
+      ReadIfPresent (i, present, 1 << 2, m_source);
+      ReadIfPresent (i, present, 1 << 3, m_aodv_dst);
+      m_lifeTime = ReadVarint (i);
+      m_rrepid = i.ReadU8 ();
+      m_WHflag = i.ReadU8 ();
+      m_rreq_id = ReadVarint (i);
+      // a varint received may be longer than the one GetSerializedSize counts
+      return i.GetDistanceFrom (start);
+    }
   m_WHEndID = i.ReadNtohU32 ();
   ReadFrom (i, m_dst);
   m_dstSeqNo = i.ReadNtohU32 ();
@@ -666,6 +1137,31 @@ WHEndHeader::GetPrefixSize () const
   return m_prefixSize;
 }
 
+void
+WHEndHeader::SetCompact (bool f)
+{
+  if (f)
+    {
+      m_flags |= COMPACT_FLAG;
+    }
+  else
+    {
+      m_flags &= ~COMPACT_FLAG;
+    }
+}
+
+bool
+WHEndHeader::GetCompact () const
+{
+  return (m_flags & COMPACT_FLAG);
+}
+
+ForwardPrefixHeader
+WHEndHeader::GetForwardPrefix () const
+{
+  return ForwardPrefixHeader (m_flags, m_prefixSize, m_hopCount);
+}
+
 bool
 WHEndHeader::operator== (WHEndHeader const & o) const
 {
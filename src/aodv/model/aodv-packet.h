@@ -33,7 +33,9 @@
 #include "ns3/enum.h"
 #include "ns3/ipv4-address.h"
 #include <map>
+#include <vector>
 #include "ns3/nstime.h"
+#include "ns3/packet.h"
 
 namespace ns3 {
 namespace aodv {
@@ -50,6 +52,7 @@ enum MessageType
   AODVTYPE_RREP_ACK = 4, //!< AODVTYPE_RREP_ACK
   AODVTYPE_WHCS  = 5,   //!< AODVTYPE_WHCS
   AODVTYPE_WHCE  = 6,   //!< AODVTYPE_WHCE
+  AODVTYPE_WHCS_BATCH = 7, //!< AODVTYPE_WHCS_BATCH
 };
 
 /**
@@ -333,6 +336,75 @@ std::ostream & operator<< (std::ostream & os, RreqHeader const &);
 
 
 
+/**
+* \ingroup aodv
+* \brief The first bytes of a WHCS or a WHCE, the only ones a forwarder changes
+*
+* A node forwarding a WHCS or a WHCE copies the received message and only
+* rewrites these three bytes (see Patch), instead of serializing the whole
+* header again.
+  \verbatim
+  0                   1                   2
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |     Flags     | WHF/Prefix Sz |   Hop Count   |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+*/
+class ForwardPrefixHeader : public Header
+{
+public:
+  /**
+   * constructor
+   *
+   * \param flags the flags of the message
+   * \param second the WHF of a WHCS, the prefix size of a WHCE
+   * \param hopCount the hop count
+   */
+  ForwardPrefixHeader (uint8_t flags = 0, uint8_t second = 0, uint8_t hopCount = 0);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  /**
+   * \brief Get the hop count
+   * \return the hop count
+   */
+  uint8_t GetHopCount () const
+  {
+    return m_hopCount;
+  }
+  /**
+   * \brief Copy a received message with these first bytes
+   *
+   * Only the bytes of the message are copied, not its packet and byte
+   * tags, and the copy is a new packet, with its own UID.
+   *
+   * \param message the WHCS or WHCE, without its TypeHeader
+   * \return the message to forward
+   */
+  Ptr<Packet> Patch (Ptr<const Packet> message) const;
+
+  /**
+   * \brief Comparison operator
+   * \param o header to compare
+   * \return true if the headers are equal
+   */
+  bool operator== (ForwardPrefixHeader const & o) const;
+private:
+  uint8_t m_flags;     ///< Flags
+  uint8_t m_second;    ///< WHF or prefix size
+  uint8_t m_hopCount;  ///< Hop Count
+};
+
 //WHCS メッセージ　作成部分
 
 /**
@@ -342,7 +414,7 @@ std::ostream & operator<< (std::ostream & os, RreqHeader const &);
   0                   1                   2                   3
   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-  |     Type      |J|R|G|D|U|   Reserved          |   Hop Count   |
+  |     Type      |J|R|G|D|U|   |C|      WHF      |   Hop Count   |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                            WHCS ID                            |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -358,7 +430,18 @@ std::ostream & operator<< (std::ostream & os, RreqHeader const &);
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                    AODVの宛先IP Address                      |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |   Reserved    |    RREP ID    |    WH Flag    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                            RREQ ID                            |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   \endverbatim
+*
+* The flags, WHF and hop count come first, so that a forwarder rewrites
+* them in place (see ForwardPrefixHeader).  With the C flag (SetCompact)
+* the rest of the message is compact: a byte telling which of the First
+* Hop, Originator, Second Hop, source and AODV destination addresses are
+* not 0.0.0.0, the IDs and sequence numbers as varints, and only the
+* addresses which are not 0.0.0.0; the reserved byte is not sent.
 */
 class WHCheckHeader : public Header
 {
@@ -600,6 +683,21 @@ public:
    * \return the unknown sequence number flag
    */
   bool GetUnknownSeqno () const;
+  /**
+   * \brief Set the compact encoding flag
+   * \param f true to serialize the message in the compact encoding
+   */
+  void SetCompact (bool f);
+  /**
+   * \brief Get the compact encoding flag
+   * \return true if the message is serialized in the compact encoding
+   */
+  bool GetCompact () const;
+  /**
+   * \brief Get the bytes a forwarder rewrites
+   * \return the flags, the WHF and the hop count
+   */
+  ForwardPrefixHeader GetForwardPrefix () const;
 
   /**
    * \brief 比較演算子
@@ -636,6 +734,120 @@ private:
 std::ostream & operator<< (std::ostream & os, RreqHeader const &);
 
 
+/**
+ * \ingroup aodv
+ * \brief One check carried by a WHCheckBatchHeader
+ *
+ * Only the fields the forwarders need are carried.  The originator keeps
+ * the RREP context of the check (source, AODV destination, RREP ID, RREQ ID)
+ * and restores it when the WHCE comes back.
+ */
+struct WHCheckBatchEntry
+{
+  Ipv4Address origin;    ///< Originator IP Address
+  uint32_t originSeqNo;  ///< Originator Sequence Number
+  uint32_t id;           ///< WHCS ID
+  Ipv4Address fir;       ///< First Hop IP Address
+  Ipv4Address sec;       ///< Second Hop IP Address
+  uint8_t hopCount;      ///< Hop Count
+  uint8_t whf;           ///< 1st hop flag, see WHCheckHeader::SetWHF
+
+  /**
+   * \brief Comparison operator
+   * \param o entry to compare
+   * \return true if the entries are equal
+   */
+  bool operator== (WHCheckBatchEntry const & o) const;
+};
+
+/**
+* \ingroup aodv
+* \brief Batched WH Check Start (WHCS_BATCH) Message Format
+*
+* Carries the WHCS of several checks in one broadcast.  The entries are
+* grouped by originator: a group starts with the originator address and the
+* number of its entries, followed by the entries (18 bytes each).
+  \verbatim
+  0                   1                   2                   3
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |     Type      |  Group Count  |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                    Originator IP Address                      |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |  Entry Count  |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                            WHCS ID                            |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                  Originator Sequence Number                   |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                    First Hop IP Address                       |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                    Second Hop IP Address                      |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |   Hop Count   |      WHF      |   (more entries, more groups)
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+*/
+class WHCheckBatchHeader : public Header
+{
+public:
+  /// Maximum number of entries of a header
+  static const uint32_t MAX_ENTRIES = 64;
+
+  WHCheckBatchHeader ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  /**
+   * \brief Add an entry, next to the entries of the same originator
+   * \param entry the entry
+   * \return false if the header is full
+   */
+  bool AddEntry (WHCheckBatchEntry const & entry);
+  /**
+   * \brief Get the number of entries
+   * \return the number of entries
+   */
+  uint32_t GetNEntries () const;
+  /**
+   * \brief Get an entry
+   * \param i the index of the entry
+   * \return the entry
+   */
+  WHCheckBatchEntry const & GetEntry (uint32_t i) const;
+  /// Remove all entries
+  void Clear ();
+
+  /**
+   * \brief Comparison operator
+   * \param o header to compare
+   * \return true if the headers are equal
+   */
+  bool operator== (WHCheckBatchHeader const & o) const;
+private:
+  /// Entries, the entries of an originator are contiguous
+  std::vector<WHCheckBatchEntry> m_entries;
+  /// Number of originator groups of m_entries
+  uint8_t m_groups;
+};
+
+/**
+  * \brief Stream output operator
+  * \param os output stream
+  * \return updated stream
+  */
+std::ostream & operator<< (std::ostream & os, WHCheckBatchHeader const &);
+
 /**
 * \ingroup aodv
 * \brief Route Reply (RREP) Message Format
@@ -843,7 +1055,7 @@ std::ostream & operator<< (std::ostream & os, RrepHeader const &);
   0                   1                   2                   3
   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-  |     Type      |R|A|    Reserved     |Prefix Sz|   Hop Count   |
+  |     Type      |R|A|         |C|  Prefix Size  |   Hop Count   |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                            WHCE ID                            |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -855,9 +1067,22 @@ std::ostream & operator<< (std::ostream & os, RrepHeader const &);
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                    source IP address                      |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                    AODV destination IP address                |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                           Lifetime                            |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |    RREP ID    |    WH Flag    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                            RREQ ID                            |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   \endverbatim
+*
+* A forwarder only changes the hop count, in place (see ForwardPrefixHeader).
+* With the C flag (SetCompact) the message after the hop count is compact,
+* as the one of WHCheckHeader: a byte telling which of the destination,
+* originator, source and AODV destination addresses are not 0.0.0.0, the
+* ID, sequence number, lifetime and RREQ ID as varints, and only the
+* addresses which are not 0.0.0.0.
 */
 class WHEndHeader : public Header
 {
@@ -1068,6 +1293,21 @@ public:
    * \return the prefix size
    */
   uint8_t GetPrefixSize () const;
+  /**
+   * \brief Set the compact encoding flag
+   * \param f true to serialize the message in the compact encoding
+   */
+  void SetCompact (bool f);
+  /**
+   * \brief Get the compact encoding flag
+   * \return true if the message is serialized in the compact encoding
+   */
+  bool GetCompact () const;
+  /**
+   * \brief Get the bytes a forwarder rewrites
+   * \return the flags, the prefix size and the hop count
+   */
+  ForwardPrefixHeader GetForwardPrefix () const;
 
   /**
    * Configure RREP to be a Hello message
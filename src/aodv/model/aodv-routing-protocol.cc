@@ -35,6 +35,7 @@
 
 #include "aodv-routing-protocol.h"
 #include "ns3/log.h"
+#include "ns3/binary-log.h"
 #include "ns3/boolean.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/inet-socket-address.h"
@@ -46,6 +47,11 @@
 #include "ns3/adhoc-wifi-mac.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+#include "ns3/core-config.h"
+#ifdef NS3_MTP
+#include "ns3/system-mutex.h"
+#endif
 #include <algorithm>
 #include <limits>
 #include <stdio.h>
@@ -55,9 +61,6 @@
 #include <cstdlib> 
 using namespace std;
 
-//検知メッセージのファーストホップとセカンドホップを記録する用のログファイル
-const char* logfile2 = "fir-sec-log.txt";
-
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("AodvRoutingProtocol");
@@ -81,6 +84,10 @@ struct rreq_info
 
 //RREQを送信した時間を保持するためのリスト
 std::vector<struct rreq_info> rreq_list;
+#ifdef NS3_MTP
+//マルチスレッド実行時は全ノードのスレッドから参照されるため排他制御する
+SystemMutex g_rreqListMutex;
+#endif
 
 /**
 * \ingroup aodv
@@ -201,6 +208,10 @@ RoutingProtocol::RoutingProtocol ()
       m_destinationOnly (true), //宛先のみがこのRREQに応答できることを示す。
       m_gratuitousReply (true), //RREPをルート探索を行ったノードにユニキャストすべきかどうかを示す。
       m_enableHello (false), //ハローメッセージが有効かどうかを示す。
+      m_whCheckAggregation (false), //WHCSをWHCS_BATCHにまとめて送信するかどうか
+      m_whCheckAggregationWindow (MilliSeconds (10)), //WHCSがWHCS_BATCHを待つ最大時間
+      m_passiveDetection (false), //疑わしい隣接ノードにだけWHCSを送信するかどうか
+      m_compactEncoding (false), //WHCS・WHCEを圧縮形式で送信するかどうか
       m_routingTable (m_deletePeriod), //ルーティングテーブル
       m_queue (
           m_maxQueueLen,
@@ -225,7 +236,6 @@ RoutingProtocol::RoutingProtocol ()
       m_lastBcastTime (Seconds (0)), //最後のブロードキャスト時間を追跡する
       
       get_rreptimes (0),
-      WH_List {Ipv4Address("10.0.0.2"), Ipv4Address("10.0.0.3")},
       rreq_count (0),
       rrep_count (0),
       WH_attack (0),
@@ -234,7 +244,7 @@ RoutingProtocol::RoutingProtocol ()
   if (m_enableHello)
     {
       //リンク失敗時のコールバックの設定　　RRERを開智する
-      m_nb.SetCallback (MakeCallback (&RoutingProtocol::SendRerrWhenBreaksLinkToNextHop, this));
+      m_nb.SetBatchCallback (MakeCallback (&RoutingProtocol::SendRerrWhenBreaksLinkToNextHops, this));
     }
 }
 TypeId
@@ -368,7 +378,69 @@ RoutingProtocol::GetTypeId (void)
           .AddAttribute ("UniformRv", "Access to the underlying UniformRandomVariable",
                          StringValue ("ns3::UniformRandomVariable"),
                          MakePointerAccessor (&RoutingProtocol::m_uniformRandomVariable),
-                         MakePointerChecker<UniformRandomVariable> ());
+                         MakePointerChecker<UniformRandomVariable> ())
+          .AddAttribute ("DetectionLog",
+                         "Recorder of RREQ/RREP/WHCS/WHCE events shared by all nodes. "
+                         "Detection events are not recorded if null.",
+                         PointerValue (),
+                         MakePointerAccessor (&RoutingProtocol::m_detectionLog),
+                         MakePointerChecker<DetectionEventLog> ())
+          .AddAttribute ("DetectionStatistics",
+                         "Collector of the wormhole detection statistics shared by all nodes. "
+                         "Statistics are not collected if null.",
+                         PointerValue (),
+                         MakePointerAccessor (&RoutingProtocol::m_detectionStatistics),
+                         MakePointerChecker<DetectionStatistics> ())
+          .AddAttribute ("WormholeOracle",
+                         "Wormhole tunnels of the scenario, shared by all nodes. "
+                         "Used to tell whether a check targets a wormhole link and to map "
+                         "tunnel interface addresses to the address of their node.",
+                         PointerValue (),
+                         MakePointerAccessor (&RoutingProtocol::m_wormholeOracle),
+                         MakePointerChecker<WormholeOracle> ())
+          .AddAttribute ("WHCheckAggregation",
+                         "Indicates whether the WHCS originated or forwarded by a node within "
+                         "WHCheckAggregationWindow are sent together in one WHCS_BATCH message.",
+                         BooleanValue (false),
+                         MakeBooleanAccessor (&RoutingProtocol::m_whCheckAggregation),
+                         MakeBooleanChecker ())
+          .AddAttribute ("WHCheckAggregationWindow",
+                         "Maximum time a WHCS waits for the next WHCS_BATCH message of the node.",
+                         TimeValue (MilliSeconds (10)),
+                         MakeTimeAccessor (&RoutingProtocol::m_whCheckAggregationWindow),
+                         MakeTimeChecker ())
+          .AddAttribute ("PassiveDetection",
+                         "Indicates whether a node forwarding a RREP only sends a WHCS when the "
+                         "link between its next and second hops towards the originator is "
+                         "suspicious: the second hop was not heard by the node nor reported by "
+                         "another neighbor, and the RREQ came shorter through the next hop than "
+                         "through any other neighbor.  Otherwise a WHCS is sent for every "
+                         "forwarded RREP.",
+                         BooleanValue (false),
+                         MakeBooleanAccessor (&RoutingProtocol::m_passiveDetection),
+                         MakeBooleanChecker ())
+          .AddAttribute ("CompactEncoding",
+                         "Indicates whether the WHCS and WHCE are sent in the compact encoding, "
+                         "with variable length IDs and without the addresses 0.0.0.0.",
+                         BooleanValue (false),
+                         MakeBooleanAccessor (&RoutingProtocol::m_compactEncoding),
+                         MakeBooleanChecker ())
+          .AddAttribute ("LatencyPrecision",
+                         "Number of significant bits of the buckets of the latency histograms "
+                         "of the node, the relative error of a percentile is at most "
+                         "2^(1-LatencyPrecision).",
+                         UintegerValue (6),
+                         MakeUintegerAccessor (&RoutingProtocol::SetLatencyPrecision,
+                                               &RoutingProtocol::GetLatencyPrecision),
+                         MakeUintegerChecker<uint32_t> (1, 16))
+          .AddTraceSource ("RouteSetupLatency",
+                           "A route was set up by this node, time between the RREQ and the RREP.",
+                           MakeTraceSourceAccessor (&RoutingProtocol::m_routeSetupLatencyTrace),
+                           "ns3::Time::TracedCallback")
+          .AddTraceSource ("CheckLatency",
+                           "A WHCE came back to this node, time since its WHCS.",
+                           MakeTraceSourceAccessor (&RoutingProtocol::m_checkLatencyTrace),
+                           "ns3::Time::TracedCallback");
 
   return tid;
 }
@@ -409,6 +481,13 @@ RoutingProtocol::DoDispose () //クラス・オブジェクトの破棄
       iter->first->Close ();
     }
   m_socketSubnetBroadcastAddresses.clear ();
+  m_detectionLog = 0;
+  m_detectionStatistics = 0;
+  m_wormholeOracle = 0;
+  m_whCheckFlushEvent.Cancel ();
+  m_whCheckOutbox.clear ();
+  m_whCheckContexts.clear ();
+  m_whCheckSendTimes.clear ();
   Ipv4RoutingProtocol::DoDispose ();
 }
 
@@ -498,6 +577,7 @@ RoutingProtocol::RouteOutput (
       UpdateRouteLifeTime (dst, m_activeRouteTimeout); //目的地までのルートの寿命を更新
       UpdateRouteLifeTime (route->GetGateway (),
                            m_activeRouteTimeout); //ゲートウェイノードまでのルートの寿命を更新
+      NS_BINLOG ("packet {} to {} via {}", p->GetUid (), dst, route->GetGateway ());
       return route;
     }
 
@@ -507,6 +587,7 @@ RoutingProtocol::RouteOutput (
   uint32_t iif = (oif ? m_ipv4->GetInterfaceForDevice (oif) : -1);
   DeferredRouteOutputTag tag (iif);
   NS_LOG_DEBUG ("Valid Route not found");
+  NS_BINLOG ("packet {} to {} deferred, no valid route", p->GetUid (), dst);
   if (!p->PeekPacketTag (tag))
     {
       p->AddPacketTag (tag);
@@ -742,6 +823,7 @@ RoutingProtocol::Forwarding (
           m_nb.Update (route->GetGateway (), m_activeRouteTimeout);
           m_nb.Update (toOrigin.GetNextHop (), m_activeRouteTimeout);
 
+          NS_BINLOG ("forward packet {} from {} to {} via {}", p->GetUid (), origin, dst, route->GetGateway ());
           ucb (route, p, header); //ユニキャストコールバック
           return true;
         }
@@ -753,12 +835,14 @@ RoutingProtocol::Forwarding (
                   dst, toDst.GetSeqNo (),
                   origin); //入力パケットを転送するルートがない場合に RERR メッセージを送信します。
               NS_LOG_DEBUG ("Drop packet " << p->GetUid () << " because no route to forward it.");
+              NS_BINLOG ("drop packet {} to {}, invalid route", p->GetUid (), dst);
               return false;
             }
         }
     }
   NS_LOG_LOGIC ("route not found to " << dst << ". Send RERR message.");
   NS_LOG_DEBUG ("Drop packet " << p->GetUid () << " because no route to forward it.");
+  NS_BINLOG ("drop packet {} to {}, no route", p->GetUid (), dst);
   SendRerrWhenNoRouteToForward (
       dst, 0,
       origin); //dst:宛先のIPアドレス、0:宛先ノードのシーケンス番号、origin:発信元のIPアドレス
@@ -1206,6 +1290,7 @@ RoutingProtocol::SendRequest (Ipv4Address dst) //RREQを送信する
   rreqHeader.SetOriginSeqno (m_seqNo);
   m_requestId++;
   rreqHeader.SetId (m_requestId);
+  NS_BINLOG ("RREQ {} for {}, ttl {}", m_requestId, dst, ttl);
 
   // aodvが使用する各インターフェースから、サブネット指向のブロードキャストとしてRREQを送信する。
   //std::map:平衡2分木
@@ -1244,6 +1329,8 @@ RoutingProtocol::SendRequest (Ipv4Address dst) //RREQを送信する
         }
       NS_LOG_DEBUG ("Send RREQ with id " << rreqHeader.GetId () << " to socket");
       m_lastBcastTime = Simulator::Now ();
+      RecordDetectionEvent (DetectionEvent::RREQ_SEND, rreqHeader.GetId (), rreqHeader.GetId (),
+                            rreqHeader.GetHopCount (), rreqHeader.GetOrigin ());
 
       //Ipv4Address origin = rreqHeader.GetOrigin ();
       //printf("RREQ作成時のO RIGIN IP:%u\n",origin.Get());
@@ -1252,10 +1339,8 @@ RoutingProtocol::SendRequest (Ipv4Address dst) //RREQを送信する
                            &RoutingProtocol::SendTo, this, socket, packet, destination);
     }
 
-    //ログファイルに書き込み
-  auto node_count = m_ipv4->GetObject<Node> ();
-
-  node_count->SetRREQ(node_count->GetRREQ() + /*p->GetSize()*/ 32);
+    //検知統計に記録
+    CountMessage (DetectionStatistics::RREQ, /*p->GetSize()*/ 32);
 
   //経路作成時間を取得するためにRREQ送信時間を記録
     struct rreq_info request_time
@@ -1265,6 +1350,10 @@ RoutingProtocol::SendRequest (Ipv4Address dst) //RREQを送信する
     };
 
   //RREQ送信時間リストに保存する
+  {
+#ifdef NS3_MTP
+  CriticalSection cs (g_rreqListMutex);
+#endif
   rreq_list.push_back(request_time);
 
   //rreq_listをすべて表示
@@ -1273,6 +1362,7 @@ RoutingProtocol::SendRequest (Ipv4Address dst) //RREQを送信する
       rreq_info& req = rreq_list[i];
       std::cout << "RREQ sent at: " << req.rreq_time << " seconds, Request ID: " << req.rreq_id << std::endl;
     }
+  }
 
   //再ブロードキャストのためにコメントアウト
   //ScheduleRreqRetry (dst);
@@ -1418,33 +1508,75 @@ RoutingProtocol::SendWHCheck (RrepHeader rrepHeader) //WHCheckを送信する
   m_WHCSId++;
   WHCheckHeader.SetId (m_WHCSId);
 
-  auto node_count = m_ipv4->GetObject<Node> ();
+  uint32_t nodeId = m_ipv4->GetObject<Node> ()->GetId ();
 
   NS_LOG_DEBUG ("ファーストホップノード：" << WHCheckHeader.GetFir()<< "セカンドホップノード" << WHCheckHeader.GetSecond());
 
-  std::ofstream ofs(logfile2 , std::ios::app);
-
-  ofs << "ファーストホップノード：" << WHCheckHeader.GetFir()<< "セカンドホップノード" << WHCheckHeader.GetSecond() << std::endl;
+  RecordDetectionEvent (DetectionEvent::WHCS_SEND, WHCheckHeader.GetId (), WHCheckHeader.GetRREQID (),
+                        WHCheckHeader.GetHopCount (), WHCheckHeader.GetOrigin (),
+                        WHCheckHeader.GetFir (), WHCheckHeader.GetSecond ());
 
   //検知メッセージがWH攻撃に向けたものかをチェックする
-  if(WHCheckHeader.GetFir() == Ipv4Address("10.0.0.3") && WHCheckHeader.GetSecond() == Ipv4Address("10.0.0.2"))
+  if (m_wormholeOracle && m_wormholeOracle->IsWormholeLink (WHCheckHeader.GetFir (), WHCheckHeader.GetSecond ()))
   {
     //フラグを設定
     WHCheckHeader.SetWH_Flag(1);
 
     //判定対象がWHリンク
-    node_count -> Set_WHJudge_Count(node_count->Get_WHJudge_Count() + 1);
+    if (m_detectionStatistics)
+      {
+        m_detectionStatistics->JudgementSent (nodeId, WHCheckHeader.GetId (), true);
+      }
   }
   else
   {
     WHCheckHeader.SetWH_Flag(0);
 
-    //判定対象が正常なリンク
-    node_count -> Set_Nomal_Node_Judge_Count(node_count->Get_Nomal_Node_Judge_Count() + 1);
-
-    //送信したノードIDを保存
-    node_count->AddSendID(WHCheckHeader.GetId());
+    //判定対象が正常なリンク（WHCEが返ってこなければ誤検知として数える）
+    if (m_detectionStatistics)
+      {
+        m_detectionStatistics->JudgementSent (nodeId, WHCheckHeader.GetId (), false);
+      }
   }
+  if (m_detectionStatistics)
+    {
+      m_detectionStatistics->CheckStarted (nodeId);
+    }
+
+  //WHCSの送信からWHCEの受信までの時間を計測する（WHCEが返ってこない検知は送信から一定時間で忘れる）
+  while (!m_whCheckSendTimes.empty ()
+         && m_whCheckSendTimes.begin ()->second + m_pathDiscoveryTime < Simulator::Now ())
+    {
+      m_whCheckSendTimes.erase (m_whCheckSendTimes.begin ());
+    }
+  m_whCheckSendTimes[m_WHCSId] = Simulator::Now ();
+
+  if (m_whCheckAggregation)
+    {
+      // RREPの送信に必要な情報はWHCS_BATCHで送らず，WHCEの受信時まで自ノードで保持する
+      while (!m_whCheckContexts.empty () && m_whCheckContexts.begin ()->second.expire < Simulator::Now ())
+        {
+          m_whCheckContexts.erase (m_whCheckContexts.begin ());
+        }
+      WHCheckContext context;
+      context.src = WHCheckHeader.GetSrc ();
+      context.dst = WHCheckHeader.GetDst ();
+      context.rrepId = WHCheckHeader.GetRREPid ();
+      context.rreqId = WHCheckHeader.GetRREQID ();
+      context.whFlag = WHCheckHeader.GetWH_Flag ();
+      context.expire = Simulator::Now () + m_pathDiscoveryTime;
+      m_whCheckContexts[m_WHCSId] = context;
+
+      WHCheckBatchEntry entry;
+      entry.originSeqNo = WHCheckHeader.GetOriginSeqno ();
+      entry.id = WHCheckHeader.GetId ();
+      entry.fir = WHCheckHeader.GetFir ();
+      entry.sec = WHCheckHeader.GetSecond ();
+      entry.hopCount = WHCheckHeader.GetHopCount ();
+      entry.whf = WHCheckHeader.GetWHF ();
+      QueueWHCheck (entry, ttl, true);
+      return;
+    }
 
   // aodvが使用する各インターフェースから、サブネット指向のブロードキャストとしてRREQを送信する。
   //std::map:平衡2分木
@@ -1465,6 +1597,7 @@ RoutingProtocol::SendWHCheck (RrepHeader rrepHeader) //WHCheckを送信する
       SocketIpTtlTag tag;  //このクラスは、パケットのソケット固有の TTL を IP 層に伝えるタグを実装します。
       tag.SetTtl (ttl);
       packet->AddPacketTag (tag);
+      WHCheckHeader.SetCompact (m_compactEncoding);
       packet->AddHeader (WHCheckHeader);
       TypeHeader tHeader (AODVTYPE_WHCS);
       packet->AddHeader (tHeader);
@@ -1488,12 +1621,9 @@ RoutingProtocol::SendWHCheck (RrepHeader rrepHeader) //WHCheckを送信する
                            &RoutingProtocol::SendTo, this, socket, packet, destination);
     }
 
-    //ログファイルに書き込み
-  //auto node_count = m_ipv4->GetObject<Node> ();
-
-  node_count->SetDetCount(node_count->GetDetCount() + 1);
-
-  node_count->SetWHC(node_count->GetWHC() + /*p->GetSize()*/ 38);
+  //検知統計に記録
+  CountMessage (DetectionStatistics::WHCS,
+                m_compactEncoding ? WHCheckHeader.GetSerializedSize () : /*p->GetSize()*/ 38);
 
   std::cout << Simulator::Now() << std::endl;
 
@@ -1622,6 +1752,10 @@ RoutingProtocol::RecvAodv (
         RecvWHCheckEnd (packet, receiver, sender);
         break;
       }
+      case AODVTYPE_WHCS_BATCH: {
+        RecvWHCheckBatch (packet, receiver, sender);
+        break;
+      }
     }
 }
 
@@ -1935,12 +2069,8 @@ RoutingProtocol::RecvRequest (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
 
   // node_count->SetRREQ(node_count->GetRREQ() + /*p->GetSize()*/ 32);
 
-  std::ofstream writing_file;
-    std::string filename = "sample.txt";
-    writing_file.open(filename, std::ios::app);
-    std::string writing_text ="4";
-    writing_file << writing_text << std::endl;
-    writing_file.close();
+  RecordDetectionEvent (DetectionEvent::RREQ_RECV, rreqHeader.GetId (), rreqHeader.GetId (),
+                        rreqHeader.GetHopCount (), rreqHeader.GetOrigin ());
 
   // ノードは、ブラックリストにあるノードから受信したすべてのRREQを無視する。
   RoutingTableEntry toPrev;
@@ -1965,6 +2095,20 @@ RoutingProtocol::RecvRequest (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
   // printf("origin:%u\n",origin.Get());
   // printf("second : %u\n",second.Get());
 
+  //トンネル経由で届いたRREQでは，セカンドホップがトンネルのアドレスになるので端点ノードのアドレスに置き換える
+  if (m_wormholeOracle)
+    {
+      second = m_wormholeOracle->GetPrimaryAddress (second);
+    }
+
+  //パッシブ検知：重複したRREQも含めて，隣接ノードとそのセカンドホップ，フラッドごとのホップ数を記録する
+  if (m_passiveDetection && !IsMyOwnAddress (origin))
+    {
+      Time expire = Simulator::Now () + Time (m_allowedHelloLoss * m_helloInterval);
+      m_linkSuspicion.NeighborHeard (src, expire);
+      m_linkSuspicion.RequestReceived (origin, id, src, second, rreqHeader.GetHopCount (), expire);
+    }
+
   /*
    *  ノードは同じOriginator IP AddressとRREQ IDを持つRREQを受信したかどうかをチェックする。
    *  そのようなRREQを受信した場合、ノードは新たに受信したRREQを黙って破棄する。
@@ -1972,11 +2116,13 @@ RoutingProtocol::RecvRequest (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
   if (m_rreqIdCache.IsDuplicate (origin, id))
     {
       NS_LOG_DEBUG ("Ignoring RREQ due to duplicate");
+      NS_BINLOG ("RREQ {} from {} dropped, duplicate", id, origin);
       return;
     }
 
   //　RREQホップ数の増加
   uint8_t hop = rreqHeader.GetHopCount () + 1;
+  NS_BINLOG ("RREQ {} from {} via {}, hops {}", id, origin, src, hop);
   rreqHeader.SetHopCount (hop);
   rreqHeader.SetSecond (src);
 
@@ -1989,10 +2135,6 @@ RoutingProtocol::RecvRequest (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
    *  4. ホップ数はRREQメッセージのホップ数からコピーされる；
    *  5. ここで、MinimalLifetime = 現在時刻 + 2*NetTraversalTime - 2*HopCount*NodeTraversalTime である。
    */
-  if(second == Ipv4Address ("10.1.2.1"))
-  {
-    second = Ipv4Address ("10.0.0.2");
-  }
 
   RoutingTableEntry toOrigin;
   if (!m_routingTable.LookupRoute (
@@ -2173,29 +2315,21 @@ RoutingProtocol::RecvRequest (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
       
     }
 
-    //ログファイルに書き込み
-  auto node_count = m_ipv4->GetObject<Node> ();
-
-  node_count->SetRREQ(node_count->GetRREQ() + /*p->GetSize()*/ 32);
+    //検知統計に記録
+    CountMessage (DetectionStatistics::RREQ, /*p->GetSize()*/ 32);
 }
 
 
 
 
-void
-RoutingProtocol::RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sender) //RREQを受信
+bool
+RoutingProtocol::ProcessWHCheck (WHCheckHeader &WHCheckHeader, Ipv4Address receiver, Ipv4Address sender)
 {
-  NS_LOG_FUNCTION (this);
-  WHCheckHeader WHCheckHeader;
-  p->RemoveHeader (WHCheckHeader);
-
+  NS_LOG_FUNCTION (this << receiver << sender);
   //printf("Recv WHC\n");
-  std::ofstream writing_file;
-    std::string filename = "sample.txt";
-    writing_file.open(filename, std::ios::app);
-    std::string writing_text ="1";
-    writing_file << writing_text << std::endl;
-    writing_file.close();
+  RecordDetectionEvent (DetectionEvent::WHCS_RECV, WHCheckHeader.GetId (), WHCheckHeader.GetRREQID (),
+                        WHCheckHeader.GetHopCount (), WHCheckHeader.GetOrigin (),
+                        WHCheckHeader.GetFir (), WHCheckHeader.GetSecond ());
 
   
 
@@ -2206,7 +2340,7 @@ RoutingProtocol::RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
       if (toPrev.IsUnidirectional ())//一方向性かどうか
         {
           NS_LOG_DEBUG ("Ignoring WHCS from node in blacklist");
-          return;
+          return false;
         }
     }
 
@@ -2229,7 +2363,7 @@ RoutingProtocol::RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
       // writing_file.close();
 
       NS_LOG_DEBUG ("Ignoring WHC due to duplicate");
-      return;
+      return false;
     }
 
   //printf("Recv WHCheck \n");
@@ -2253,7 +2387,7 @@ RoutingProtocol::RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
     //   writing_file << writing_text << std::endl;
     //   writing_file.close();
     NS_LOG_DEBUG ("送信元が1st,2ndのどちらか");
-    return;
+    return false;
   }
 
   if(receiver == WHCheckHeader.GetFir() || receiver == WHCheckHeader.GetSecond())
@@ -2265,7 +2399,7 @@ RoutingProtocol::RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
     //   writing_file << writing_text << std::endl;
     //   writing_file.close();
     NS_LOG_DEBUG ("自分自身がが1st,2ndのどちらか");
-    return;
+    return false;
   }
 
   uint8_t hop = WHCheckHeader.GetHopCount ();
@@ -2323,7 +2457,7 @@ RoutingProtocol::RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
     
 
     //printf("ホップ数が４以上となった\n");
-    return;
+    return false;
   }
 
 
@@ -2452,7 +2586,7 @@ RoutingProtocol::RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
       SendWHCheckEnd(WHCheckHeader, toOrigin2, receiver);
 
       //SendReply (rreqHeader, toOrigin);
-      return;
+      return false;
     }
 
     //最大ホップ数の制限
@@ -2502,6 +2636,22 @@ RoutingProtocol::RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
 //         }
 //     }
 
+  return true;
+}
+
+void
+RoutingProtocol::RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sender) //RREQを受信
+{
+  NS_LOG_FUNCTION (this);
+  WHCheckHeader WHCheckHeader;
+  //転送時に先頭3バイトだけ書き換えるため、ヘッダは取り除かない
+  p->PeekHeader (WHCheckHeader);
+
+  if (!ProcessWHCheck (WHCheckHeader, receiver, sender))
+    {
+      return;
+    }
+
    SocketIpTtlTag tag;
    p->RemovePacketTag (tag);
   // if (tag.GetTtl () < 2)
@@ -2519,11 +2669,11 @@ RoutingProtocol::RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
       
       Ptr<Socket> socket = j->first;
       Ipv4InterfaceAddress iface = j->second;
-      Ptr<Packet> packet = Create<Packet> ();
+      //WHF・ホップ数を受信したメッセージに上書き
+      Ptr<Packet> packet = WHCheckHeader.GetForwardPrefix ().Patch (p);
       SocketIpTtlTag ttl;
       ttl.SetTtl (tag.GetTtl () - 1);
       packet->AddPacketTag (ttl);
-      packet->AddHeader (WHCheckHeader);
       TypeHeader tHeader (AODVTYPE_WHCS); //AODVTYPE_RREQ=1
       packet->AddHeader (tHeader);
       // 32アドレスの場合は全ホストにブロードキャスト送信、それ以外はサブネットに直接送信
@@ -2541,12 +2691,125 @@ RoutingProtocol::RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
                            &RoutingProtocol::SendTo, this, socket, packet, destination); //RRREQ送信部
     }
 
-    //ログファイルに書き込み
-  auto node_count = m_ipv4->GetObject<Node> ();
+    //検知統計に記録
+    CountMessage (DetectionStatistics::WHCS,
+                  WHCheckHeader.GetCompact () ? WHCheckHeader.GetSerializedSize () : /*p->GetSize()*/ 38);
+}
+
 
-  node_count->SetWHC(node_count->GetWHC() + /*p->GetSize()*/ 38);
+void
+RoutingProtocol::RecvWHCheckBatch (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION (this << receiver << sender);
+  WHCheckBatchHeader batchHeader;
+  p->RemoveHeader (batchHeader);
+  SocketIpTtlTag tag;
+  p->RemovePacketTag (tag);
+
+  // 各WHCSを個別のWHCSと同じように処理し，転送するものは次のWHCS_BATCHにまとめる
+  for (uint32_t i = 0; i < batchHeader.GetNEntries (); ++i)
+    {
+      WHCheckBatchEntry entry = batchHeader.GetEntry (i);
+      WHCheckHeader WHCheckHeader;
+      WHCheckHeader.SetHopCount (entry.hopCount);
+      WHCheckHeader.SetId (entry.id);
+      WHCheckHeader.SetFir (entry.fir);
+      WHCheckHeader.SetOrigin (entry.origin);
+      WHCheckHeader.SetOriginSeqno (entry.originSeqNo);
+      WHCheckHeader.SetSecond (entry.sec);
+      WHCheckHeader.SetWHF (entry.whf);
+      if (!ProcessWHCheck (WHCheckHeader, receiver, sender))
+        {
+          continue;
+        }
+      entry.hopCount = WHCheckHeader.GetHopCount ();
+      entry.whf = WHCheckHeader.GetWHF ();
+      QueueWHCheck (entry, tag.GetTtl () - 1, false);
+    }
 }
 
+void
+RoutingProtocol::QueueWHCheck (WHCheckBatchEntry const &entry, uint8_t ttl, bool own)
+{
+  NS_LOG_FUNCTION (this << entry.id << entry.origin << (uint32_t) ttl << own);
+  PendingWHCheck pending;
+  pending.entry = entry;
+  pending.ttl = ttl;
+  pending.own = own;
+  m_whCheckOutbox.push_back (pending);
+  if (!m_whCheckFlushEvent.IsRunning ())
+    {
+      // 個別のWHCSの送信ジッタ（0〜10ms）の代わりに，ウィンドウ内の一様乱数の時刻にまとめて送信する
+      Time delay = MicroSeconds (m_uniformRandomVariable->GetInteger (
+          0, m_whCheckAggregationWindow.GetMicroSeconds ()));
+      m_whCheckFlushEvent = Simulator::Schedule (delay, &RoutingProtocol::FlushWHChecks, this);
+    }
+}
+
+void
+RoutingProtocol::FlushWHChecks ()
+{
+  NS_LOG_FUNCTION (this << m_whCheckOutbox.size ());
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin ();
+       j != m_socketAddresses.end (); ++j)
+    {
+      Ptr<Socket> socket = j->first;
+      Ipv4InterfaceAddress iface = j->second;
+      Ipv4Address destination;
+      if (iface.GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = iface.GetBroadcast ();
+        }
+
+      // ヘッダーに入りきらない分は次のWHCS_BATCHで送る
+      // IPのTTLはまとめたWHCSの最大値とする（WHCSの到達範囲はホップ数で制限される）
+      std::vector<PendingWHCheck>::const_iterator i = m_whCheckOutbox.begin ();
+      while (i != m_whCheckOutbox.end ())
+        {
+          WHCheckBatchHeader batchHeader;
+          uint8_t ttl = 0;
+          for (; i != m_whCheckOutbox.end (); ++i)
+            {
+              WHCheckBatchEntry entry = i->entry;
+              if (i->own)
+                {
+                  entry.origin = iface.GetLocal ();
+                }
+              if (!batchHeader.AddEntry (entry))
+                {
+                  break;
+                }
+              if (i->own)
+                {
+                  m_WHCheckIdCache.IsDuplicate (entry.origin, entry.id); //重複した WHCS を処理します。
+                }
+              ttl = std::max (ttl, i->ttl);
+            }
+
+          Ptr<Packet> packet = Create<Packet> ();
+          SocketIpTtlTag tag;
+          tag.SetTtl (ttl);
+          packet->AddPacketTag (tag);
+          packet->AddHeader (batchHeader);
+          TypeHeader tHeader (AODVTYPE_WHCS_BATCH);
+          packet->AddHeader (tHeader);
+          NS_LOG_DEBUG ("Send WHCS_BATCH with " << batchHeader.GetNEntries () << " WHCS to socket");
+          m_lastBcastTime = Simulator::Now ();
+          SendTo (socket, packet, destination);
+
+          //検知統計に記録（個別のWHCSと同じく，インターフェースの数によらず1回とする）
+          if (j == m_socketAddresses.begin ())
+            {
+              CountMessage (DetectionStatistics::WHCS, tHeader.GetSerializedSize () + batchHeader.GetSerializedSize ());
+            }
+        }
+    }
+  m_whCheckOutbox.clear ();
+}
 
 //新しいSend Reply
 
@@ -2590,11 +2853,18 @@ RoutingProtocol::SendReply (RreqHeader const & rreqHeader, RoutingTableEntry con
 
   //printf("RREP送信時のFirst Hop: %u\n", toOrigin.GetNextHop().Get ());
 
-  //パケット作成部分？
+  SendReplyTo (rrepHeader, toOrigin, toOrigin.GetHop ());
+  RecordDetectionEvent (DetectionEvent::RREP_SEND, rrepHeader.Getid (), rrepHeader.GetRREQid (),
+                        rrepHeader.GetHopCount (), rrepHeader.GetOrigin ());
+}
 
+void
+RoutingProtocol::SendReplyTo (RrepHeader const & rrepHeader, RoutingTableEntry const & toOrigin,
+                              uint8_t ttl)
+{
   Ptr<Packet> packet = Create<Packet> ();
   SocketIpTtlTag tag;
-  tag.SetTtl (toOrigin.GetHop ());
+  tag.SetTtl (ttl);
   packet->AddPacketTag (tag);
   packet->AddHeader (rrepHeader);
   TypeHeader tHeader (AODVTYPE_RREP);
@@ -2603,11 +2873,8 @@ RoutingProtocol::SendReply (RreqHeader const & rreqHeader, RoutingTableEntry con
   NS_ASSERT (socket);
   socket->SendTo (packet, 0, InetSocketAddress (toOrigin.GetNextHop (), AODV_PORT));
 
-  //ログファイルに書き込み
-  auto node_count = m_ipv4->GetObject<Node> ();
-
-  node_count->SetRREP(node_count->GetRREP() + /*p->GetSize()*/ 20);
-
+  //検知統計に記録（結果を比較できるよう，ノードのRREPログと同じく20バイトで数える）
+  CountMessage (DetectionStatistics::RREP, /*p->GetSize()*/ 20);
 }
 
 
@@ -2691,6 +2958,7 @@ RoutingProtocol::SendWHCheckEnd (WHCheckHeader const &WHCheckHeader,
   SocketIpTtlTag tag;
   tag.SetTtl (toOrigin.GetHop ());
   packet->AddPacketTag (tag);
+  WHEndHeader.SetCompact (m_compactEncoding);
   packet->AddHeader (WHEndHeader);
   TypeHeader tHeader (AODVTYPE_WHCE);
   packet->AddHeader (tHeader);
@@ -2698,11 +2966,12 @@ RoutingProtocol::SendWHCheckEnd (WHCheckHeader const &WHCheckHeader,
   NS_ASSERT (socket);
 
   socket->SendTo (packet, 0, InetSocketAddress (toOrigin.GetNextHop (), AODV_PORT));//RREP送信部
+  RecordDetectionEvent (DetectionEvent::WHCE_SEND, WHEndHeader.GetId (), WHEndHeader.GetRREQID (),
+                        WHEndHeader.GetHopCount (), WHEndHeader.GetOrigin ());
 
-  //ログファイルに書き込み
-  auto node_count = m_ipv4->GetObject<Node> ();
-
-  node_count->SetWHE(node_count->GetWHE() + /*p->GetSize()*/ 32);
+  //検知統計に記録
+  CountMessage (DetectionStatistics::WHCE,
+                m_compactEncoding ? WHEndHeader.GetSerializedSize () : /*p->GetSize()*/ 32);
 }
 
 
@@ -2745,6 +3014,8 @@ RoutingProtocol:: SendReplyByIntermediateNode (RoutingTableEntry &toDst, Routing
   Ptr<Socket> socket = FindSocketWithInterfaceAddress (toOrigin.GetInterface ());
   NS_ASSERT (socket);
   socket->SendTo (packet, 0, InetSocketAddress (toOrigin.GetNextHop (), AODV_PORT));
+  RecordDetectionEvent (DetectionEvent::RREP_SEND, rrepHeader.Getid (), rrepHeader.GetRREQid (),
+                        rrepHeader.GetHopCount (), rrepHeader.GetOrigin ());
 
   // 無償RREPの生成
   if (gratRep)
@@ -2808,16 +3079,20 @@ RoutingProtocol::RecvReply (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sen
       return;
     }
 
+  NS_BINLOG ("RREP for {} to {} via {}, hops {}", dst, rrepHeader.GetOrigin (), sender, hop);
+
   // printf("Receav RREP\n");
 
   //printf("Recv RREP ID:%d\n", rrepHeader.Getid());
   
-  std::ofstream writing_file;
-    std::string filename = "com_num.txt";
-    writing_file.open(filename, std::ios::app);
-    std::string writing_text ="1";
-    writing_file << writing_text << std::endl;
-    writing_file.close();
+  RecordDetectionEvent (DetectionEvent::RREP_RECV, rrepHeader.Getid (), rrepHeader.GetRREQid (),
+                        rrepHeader.GetHopCount (), rrepHeader.GetOrigin ());
+
+  //パッシブ検知：RREPの送信元は電波の届く隣接ノード
+  if (m_passiveDetection)
+    {
+      m_linkSuspicion.NeighborHeard (sender, Simulator::Now () + Time (m_allowedHelloLoss * m_helloInterval));
+    }
 
   /*
    * 宛先へのルートテーブルエントリーが作成または更新された場合、以下のアクションが発生する：
@@ -2894,7 +3169,6 @@ RoutingProtocol::RecvReply (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sen
       //RouteRequestTimerExpire(Ipv4Address(rrepHeader.GetDst()));
 
       auto node_id= m_ipv4->GetObject<Node> ()->GetId();
-      auto node_count = m_ipv4->GetObject<Node> ();
 
       std::cout << "RREQを受信したノードID" << node_id <<std::endl;
 
@@ -2903,6 +3177,9 @@ RoutingProtocol::RecvReply (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sen
       {
         std::cout << "宛先ノードのIPアドレス" << rrepHeader.GetDst() << std::endl;
         std::cout << "経路作成時間を取得   RREQのIDを取得：" << rrepHeader.GetRREQid() <<std::endl;
+#ifdef NS3_MTP
+          CriticalSection cs (g_rreqListMutex);
+#endif
           size_t i = 0;
           for(i = 0; i < rreq_list.size(); i++)
           {   
@@ -2911,8 +3188,14 @@ RoutingProtocol::RecvReply (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sen
 
               if(rreq_list[i].rreq_id == rrepHeader.GetRREQid())
               {
-                  node_count->Set_Routing_Time(Simulator::Now());
-                  node_count->Increment_Routing_Time_Count();
+                  //RREQ送信からRREP到着までを経路作成時間とする
+                  Time setupTime = Simulator::Now () - rreq_list[i].rreq_time;
+                  m_routeSetupLatency.Record (setupTime);
+                  m_routeSetupLatencyTrace (setupTime);
+                  if (m_detectionStatistics)
+                    {
+                      m_detectionStatistics->RouteEstablished (node_id, setupTime);
+                    }
 
                   std::cout << "RREPが目的地に到着した時間：" << Simulator::Now() - rreq_list[i].rreq_time <<std::endl;
                   break;
@@ -3045,6 +3328,25 @@ RoutingProtocol::RecvReply (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sen
     // }
     //}
 
+  //パッシブ検知：オリジンへのネクストホップとセカンドホップの間のリンクが疑わしくなければ，WHCSを送らずにRREPを転送する
+  if (m_passiveDetection
+      && !m_linkSuspicion.IsSuspicious (rrepHeader.GetOrigin (), toOrigin.GetNextHop (),
+                                        toOrigin.GetSecondHop ()))
+    {
+      NS_BINLOG ("RREP {} forwarded to {} without check, second hop {}", rrepHeader.Getid (),
+                 toOrigin.GetNextHop (), toOrigin.GetSecondHop ());
+      //検知統計に記録：チェックせずに正常と判定したリンク（トンネルなら見逃し）
+      if (m_detectionStatistics)
+        {
+          m_detectionStatistics->JudgementSkipped (
+              m_ipv4->GetObject<Node> ()->GetId (),
+              m_wormholeOracle && m_wormholeOracle->IsWormholeLink (toOrigin.GetNextHop (),
+                                                                     toOrigin.GetSecondHop ()));
+        }
+      SendReplyTo (rrepHeader, toOrigin, tag.GetTtl () - 1);
+      return;
+    }
+
     SendWHCheck(rrepHeader);
 
   // Ptr<Packet> packet = Create<Packet> ();RecvWH
@@ -3066,16 +3368,13 @@ RoutingProtocol::RecvWHCheckEnd (Ptr<Packet> p, Ipv4Address receiver, Ipv4Addres
   // printf("receiver : %d\n",receiver.Get ());
   NS_LOG_FUNCTION (this << " src " << sender);
   WHEndHeader WHEndHeader;
-  p->RemoveHeader (WHEndHeader);
+  //転送時に先頭3バイトだけ書き換えるため、ヘッダは取り除かない
+  p->PeekHeader (WHEndHeader);
   Ipv4Address dst = WHEndHeader.GetDst ();
   NS_LOG_LOGIC ("WHCE destination " << dst << " WHCE origin " << WHEndHeader.GetOrigin ());
 
-  std::ofstream writing_file;
-    std::string filename = "sample.txt";
-    writing_file.open(filename, std::ios::app);
-    std::string writing_text ="31";
-    writing_file << writing_text << std::endl;
-    writing_file.close();
+  RecordDetectionEvent (DetectionEvent::WHCE_RECV, WHEndHeader.GetId (), WHEndHeader.GetRREQID (),
+                        WHEndHeader.GetHopCount (), WHEndHeader.GetOrigin ());
 
   uint8_t hop = WHEndHeader.GetHopCount () + 1;
   WHEndHeader.SetHopCount (hop);
@@ -3162,11 +3461,21 @@ RoutingProtocol::RecvWHCheckEnd (Ptr<Packet> p, Ipv4Address receiver, Ipv4Addres
   //   }
   NS_LOG_LOGIC ("receiver " << receiver << " origin " << WHEndHeader.GetOrigin ());
 
-  auto node_count = m_ipv4->GetObject<Node> ();
-
   //目的地が自分のアドレスと一致
   if (IsMyOwnAddress (WHEndHeader.GetOrigin ()))
     {
+      // WHCS_BATCHで送った検知では，保持しておいたRREPの情報を戻す
+      std::map<uint32_t, WHCheckContext>::iterator context = m_whCheckContexts.find (id);
+      if (context != m_whCheckContexts.end ())
+        {
+          WHEndHeader.SetSrc (context->second.src);
+          WHEndHeader.SetAodv_Dst (context->second.dst);
+          WHEndHeader.SetRREPid (context->second.rrepId);
+          WHEndHeader.SetRREQID (context->second.rreqId);
+          WHEndHeader.SetWH_Flag (context->second.whFlag);
+          m_whCheckContexts.erase (context);
+        }
+
       if (toDst.GetFlag () == IN_SEARCH)
         {
           m_routingTable.Update (newEntry);
@@ -3174,15 +3483,27 @@ RoutingProtocol::RecvWHCheckEnd (Ptr<Packet> p, Ipv4Address receiver, Ipv4Addres
           m_addressReqTimer.erase (dst);
         }
 
-        if(WHEndHeader.GetWH_Flag() == 1)
-        {
-          //WH攻撃を正常なノードと判定した
-          node_count->Set_WHDetection_miss_Count(node_count->Get_WHDetection_miss_Count() +1);
-        }
-        else{
-          //受信したIDを保存
-          node_count->AddRecvID(id);
-        }
+        //WHCSの送信からWHCEの受信までの時間
+        std::map<uint32_t, Time>::iterator sent = m_whCheckSendTimes.find (id);
+        if (sent != m_whCheckSendTimes.end ())
+          {
+            Time latency = Simulator::Now () - sent->second;
+            m_whCheckSendTimes.erase (sent);
+            m_checkLatency.Record (latency);
+            m_checkLatencyTrace (latency);
+            if (m_detectionStatistics)
+              {
+                m_detectionStatistics->CheckCompleted (m_ipv4->GetObject<Node> ()->GetId (), latency);
+              }
+          }
+
+        //WH_Flag == 1: WH攻撃を正常なノードと判定した
+        //WH_Flag == 0: 正常なリンクの判定が完了した
+        if (m_detectionStatistics)
+          {
+            m_detectionStatistics->JudgementAnswered (m_ipv4->GetObject<Node> ()->GetId (), id,
+                                                      WHEndHeader.GetWH_Flag () == 1);
+          }
 
       //RREPを送信する
       RoutingTableEntry toSrc;
@@ -3204,23 +3525,7 @@ RoutingProtocol::RecvWHCheckEnd (Ptr<Packet> p, Ipv4Address receiver, Ipv4Addres
 
       //printf("RREPを送信　ID:%d\n", rrepHeader.Getid());
 
-      //RREPパケット作製
-        Ptr<Packet> packet = Create<Packet> ();
-        SocketIpTtlTag ttl;
-        ttl.SetTtl (toSrc.GetHop());
-        packet->AddPacketTag (ttl);
-        packet->AddHeader (rrepHeader);
-        TypeHeader tHeader (AODVTYPE_RREP);
-        packet->AddHeader (tHeader);
-        Ptr<Socket> socket = FindSocketWithInterfaceAddress (toSrc.GetInterface ());
-        NS_ASSERT (socket);
-        socket->SendTo (packet, 0, InetSocketAddress (toSrc.GetNextHop (), AODV_PORT));
-
-        //ログファイルに書き込み
-        auto node_count = m_ipv4->GetObject<Node> ();
-
-        node_count->SetRREP(node_count->GetRREP() + /*p->GetSize()*/ 20);
-    
+      SendReplyTo (rrepHeader, toSrc, toSrc.GetHop ());
       return;
     }
 
@@ -3263,21 +3568,20 @@ RoutingProtocol::RecvWHCheckEnd (Ptr<Packet> p, Ipv4Address receiver, Ipv4Addres
 
   // printf("Send RREP\n");
 
-  Ptr<Packet> packet = Create<Packet> ();
+  //ホップ数を受信したメッセージに上書き
+  Ptr<Packet> packet = WHEndHeader.GetForwardPrefix ().Patch (p);
   SocketIpTtlTag ttl;
   ttl.SetTtl (tag.GetTtl () - 1);
   packet->AddPacketTag (ttl);
-  packet->AddHeader (WHEndHeader);
   TypeHeader tHeader (AODVTYPE_WHCE);
   packet->AddHeader (tHeader);
   Ptr<Socket> socket = FindSocketWithInterfaceAddress (toOrigin.GetInterface ());
   NS_ASSERT (socket);
   socket->SendTo (packet, 0, InetSocketAddress (toOrigin.GetNextHop (), AODV_PORT));
 
-  //ログファイルに書き込み
-  //auto node_count = m_ipv4->GetObject<Node> ();
-
-  node_count->SetWHE(node_count->GetWHE() + /*p->GetSize()*/ 32);
+  //検知統計に記録
+  CountMessage (DetectionStatistics::WHCE,
+                WHEndHeader.GetCompact () ? WHEndHeader.GetSerializedSize () : /*p->GetSize()*/ 32);
 }
 
 void
@@ -3339,6 +3643,11 @@ RoutingProtocol::ProcessHello (RrepHeader const &rrepHeader,
     {
       m_nb.Update (rrepHeader.GetDst (), Time (m_allowedHelloLoss * m_helloInterval));
     }
+  if (m_passiveDetection)
+    {
+      m_linkSuspicion.NeighborHeard (rrepHeader.GetDst (),
+                                     Simulator::Now () + Time (m_allowedHelloLoss * m_helloInterval));
+    }
 }
 
 void
@@ -3349,6 +3658,7 @@ RoutingProtocol::RecvError (Ptr<Packet> p,
   NS_LOG_FUNCTION (this << " from " << src);
   RerrHeader rerrHeader;
   p->RemoveHeader (rerrHeader);
+  NS_BINLOG ("RERR from {}, {} destinations", src, rerrHeader.GetDestCount ());
   std::map<Ipv4Address, uint32_t> dstWithNextHopSrc;
   std::map<Ipv4Address, uint32_t> unreachable;
   m_routingTable.GetListOfDestinationWithNextHop (src, dstWithNextHopSrc);
@@ -3565,11 +3875,34 @@ RoutingProtocol::SendPacketFromQueue (Ipv4Address dst,
 
 void
 RoutingProtocol::SendRerrWhenBreaksLinkToNextHop (Ipv4Address nextHop) //RERR を開始する
+{
+  NS_LOG_FUNCTION (this << nextHop);
+  std::map<Ipv4Address, uint32_t> unreachable;
+  m_routingTable.GetListOfDestinationWithNextHop (nextHop, unreachable);
+  SendRerrWhenBreaksLinkToNextHop (nextHop, unreachable);
+}
+
+//複数のリンク切れをまとめて処理する（ルーティングテーブルの走査は1回）
+void
+RoutingProtocol::SendRerrWhenBreaksLinkToNextHops (std::vector<Ipv4Address> const & nextHops)
+{
+  NS_LOG_FUNCTION (this << nextHops.size ());
+  // invalidating the routes of a neighbor does not change the next hop of the others
+  std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> > unreachable;
+  m_routingTable.GetListOfDestinationWithNextHops (nextHops, unreachable);
+  for (std::vector<Ipv4Address>::const_iterator i = nextHops.begin (); i != nextHops.end (); ++i)
+    {
+      NS_BINLOG ("link to {} broken, {} routes", *i, unreachable[*i].size ());
+      SendRerrWhenBreaksLinkToNextHop (*i, unreachable[*i]);
+    }
+}
+
+void
+RoutingProtocol::SendRerrWhenBreaksLinkToNextHop (Ipv4Address nextHop, std::map<Ipv4Address, uint32_t> & unreachable)
 {
   NS_LOG_FUNCTION (this << nextHop);
   RerrHeader rerrHeader;
   std::vector<Ipv4Address> precursors;
-  std::map<Ipv4Address, uint32_t> unreachable;
 
   RoutingTableEntry toNextHop;
   if (!m_routingTable.LookupRoute (nextHop, toNextHop))
@@ -3578,7 +3911,6 @@ RoutingProtocol::SendRerrWhenBreaksLinkToNextHop (Ipv4Address nextHop) //RERR 
     }
   toNextHop.GetPrecursors (precursors);
   rerrHeader.AddUnDestination (nextHop, toNextHop.GetSeqNo ());
-  m_routingTable.GetListOfDestinationWithNextHop (nextHop, unreachable);
   for (std::map<Ipv4Address, uint32_t>::const_iterator i = unreachable.begin ();
        i != unreachable.end ();)
     {
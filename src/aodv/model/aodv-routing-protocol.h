@@ -33,7 +33,14 @@
 #include "aodv-packet.h"
 #include "aodv-neighbor.h"
 #include "aodv-dpd.h"
+#include "aodv-detection-log.h"
+#include "aodv-detection-statistics.h"
+#include "aodv-wormhole-oracle.h"
+#include "aodv-latency-histogram.h"
+#include "aodv-link-suspicion.h"
 #include "ns3/node.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -166,6 +173,47 @@ public:
   {
     return m_enableBroadcast;
   }
+  /**
+   * Get the route setup times of this node
+   * \returns the histogram of the times between a RREQ and its RREP
+   */
+  const LatencyHistogram & GetRouteSetupLatency () const
+  {
+    return m_routeSetupLatency;
+  }
+  /**
+   * Get the check latencies of this node
+   * \returns the histogram of the times between a WHCS and its WHCE
+   */
+  const LatencyHistogram & GetCheckLatency () const
+  {
+    return m_checkLatency;
+  }
+  /**
+   * Set the precision of the latency histograms, clears them
+   * \param precision the number of significant bits of the buckets
+   */
+  void SetLatencyPrecision (uint32_t precision)
+  {
+    m_routeSetupLatency.SetPrecision (precision);
+    m_checkLatency.SetPrecision (precision);
+  }
+  /**
+   * Get the precision of the latency histograms
+   * \returns the number of significant bits of the buckets
+   */
+  uint32_t GetLatencyPrecision () const
+  {
+    return m_routeSetupLatency.GetPrecision ();
+  }
+  /**
+   * Get the wormhole suspicion of the reverse routes of this node
+   * \returns the observations used by the passive detection
+   */
+  const LinkSuspicion & GetLinkSuspicion () const
+  {
+    return m_linkSuspicion;
+  }
 
   /**
    * Assign a fixed random variable stream number to the random variables
@@ -218,6 +266,13 @@ private:
   bool m_gratuitousReply;              ///< Indicates whether a gratuitous RREP should be unicast to the node originated route discovery.
   bool m_enableHello;                  ///< Indicates whether a hello messages enable
   bool m_enableBroadcast;              ///< Indicates whether a a broadcast data packets forwarding enable
+  Ptr<DetectionEventLog> m_detectionLog; ///< Detection event recorder, null if disabled
+  Ptr<DetectionStatistics> m_detectionStatistics; ///< Detection statistics collector, null if disabled
+  Ptr<WormholeOracle> m_wormholeOracle;           ///< Wormhole tunnels of the scenario, null if none
+  bool m_whCheckAggregation;           ///< Indicates whether WHCS are sent in WHCS_BATCH messages
+  Time m_whCheckAggregationWindow;     ///< Maximum delay of a WHCS waiting for a WHCS_BATCH
+  bool m_passiveDetection;             ///< Indicates whether a WHCS is only sent for a suspicious neighbor
+  bool m_compactEncoding;              ///< Indicates whether WHCS and WHCE are sent in the compact encoding
   //\}
 
   /// IP protocol
@@ -257,6 +312,41 @@ private:
   uint16_t m_rreqCount;
   /// Number of RERRs used for RERR rate control
   uint16_t m_rerrCount;
+  /// RREP context of a WHCS originated by this node, restored from the WHCE
+  struct WHCheckContext
+  {
+    Ipv4Address src;      ///< AODV source the RREP is sent to
+    Ipv4Address dst;      ///< AODV destination of the RREP
+    uint8_t rrepId;       ///< RREP ID
+    uint32_t rreqId;      ///< RREQ ID
+    uint8_t whFlag;       ///< 1 if the checked link is a wormhole tunnel
+    Time expire;          ///< Time the context is forgotten if no WHCE came back
+  };
+  /// RREP contexts of the WHCS_BATCH checks of this node, by WHCS ID
+  std::map<uint32_t, WHCheckContext> m_whCheckContexts;
+  /// A WHCS waiting for the next WHCS_BATCH
+  struct PendingWHCheck
+  {
+    WHCheckBatchEntry entry; ///< the WHCS
+    uint8_t ttl;             ///< IP TTL
+    bool own;                ///< true if originated by this node
+  };
+  /// WHCS waiting for the next WHCS_BATCH
+  std::vector<PendingWHCheck> m_whCheckOutbox;
+  /// Sends the next WHCS_BATCH
+  EventId m_whCheckFlushEvent;
+  /// Send times of the WHCS of this node waiting for their WHCE, by WHCS ID
+  std::map<uint32_t, Time> m_whCheckSendTimes;
+  /// Route setup times of this node
+  LatencyHistogram m_routeSetupLatency;
+  /// Times between the WHCS of this node and their WHCE
+  LatencyHistogram m_checkLatency;
+  /// Trace fired with each route setup time of this node
+  TracedCallback<Time> m_routeSetupLatencyTrace;
+  /// Trace fired with each check latency of this node
+  TracedCallback<Time> m_checkLatencyTrace;
+  /// Wormhole suspicion of the reverse routes, for the passive detection
+  LinkSuspicion m_linkSuspicion;
  /// WHCSレート制御に使用されるWHCS数
   uint16_t m_WHCheckCount;
 
@@ -361,6 +451,17 @@ private:
   void RecvWHCheck (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src);
   /// Receive WHCE
   void RecvWHCheckEnd (Ptr<Packet> p, Ipv4Address my,Ipv4Address src);
+  /// Receive WHCS_BATCH
+  void RecvWHCheckBatch (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src);
+  /**
+   * Process a WHCS received from a neighbor: update the reverse route and
+   * send the WHCE if this node sees both hops of the checked link.
+   * \param WHCheckHeader the WHCS, the hop count and WHF are updated
+   * \param receiver the address of the receiving interface
+   * \param src the neighbor the WHCS was received from
+   * \returns true if the WHCS should be forwarded
+   */
+  bool ProcessWHCheck (WHCheckHeader & WHCheckHeader, Ipv4Address receiver, Ipv4Address src);
   //\}
 
   ///\name Send
@@ -374,9 +475,58 @@ private:
 
   /// Send WHCR(WH check Request)
   void SendWHCheck (RrepHeader rrepHeader);
+  /**
+   * Queue a WHCS for the next WHCS_BATCH of this node
+   * \param entry the WHCS
+   * \param ttl the IP TTL of the WHCS
+   * \param own true if this node originated the WHCS, its originator
+   * address is then the address of each sending interface
+   */
+  void QueueWHCheck (WHCheckBatchEntry const & entry, uint8_t ttl, bool own);
+  /// Send the queued WHCS in WHCS_BATCH messages
+  void FlushWHChecks ();
+  /**
+   * Record a detection event if the detection event log is enabled
+   * \param type the event type
+   * \param id the message id
+   * \param rreqId the RREQ id the message refers to
+   * \param hopCount the hop count carried in the message
+   * \param origin the origin address of the message
+   * \param fir the first hop of the checked link
+   * \param second the second hop of the checked link
+   */
+  void RecordDetectionEvent (DetectionEvent::Type type, uint32_t id, uint32_t rreqId, uint8_t hopCount,
+                             Ipv4Address origin, Ipv4Address fir = Ipv4Address::GetAny (),
+                             Ipv4Address second = Ipv4Address::GetAny ())
+  {
+    if (m_detectionLog)
+      {
+        m_detectionLog->Record (type, m_ipv4->GetObject<Node> ()->GetId (), id, rreqId, hopCount,
+                                origin, fir, second);
+      }
+  }
+  /**
+   * Count a control message sent by this node if the detection statistics are enabled
+   * \param message the message type
+   * \param bytes the message size
+   */
+  void CountMessage (DetectionStatistics::Message message, uint32_t bytes)
+  {
+    if (m_detectionStatistics)
+      {
+        m_detectionStatistics->MessageSent (m_ipv4->GetObject<Node> ()->GetId (), message, bytes);
+      }
+  }
 
   /// Send RREP
   void SendReply (RreqHeader const & rreqHeader, RoutingTableEntry const & toOrigin);
+  /**
+   * Send a RREP to the next hop of a route towards its originator, and count it
+   * \param rrepHeader the RREP header
+   * \param toOrigin the routing table entry of the route
+   * \param ttl the TTL of the RREP
+   */
+  void SendReplyTo (RrepHeader const & rrepHeader, RoutingTableEntry const & toOrigin, uint8_t ttl);
   
   /// Send RREP
   void SendWHCheckEnd (WHCheckHeader const & WHCheckHeader, RoutingTableEntry const & toOrigin, Ipv4Address receiver);
@@ -391,6 +541,17 @@ private:
   void SendReplyAck (Ipv4Address neighbor);
   /// Initiate RERR
   void SendRerrWhenBreaksLinkToNextHop (Ipv4Address nextHop);
+  /**
+   * Initiate RERR for several broken links, with one pass over the routing table
+   * \param nextHops the lost neighbors
+   */
+  void SendRerrWhenBreaksLinkToNextHops (std::vector<Ipv4Address> const & nextHops);
+  /**
+   * Initiate RERR
+   * \param nextHop the lost neighbor
+   * \param unreachable the destinations through \p nextHop, with their sequence number
+   */
+  void SendRerrWhenBreaksLinkToNextHop (Ipv4Address nextHop, std::map<Ipv4Address, uint32_t> & unreachable);
   /// Forward RERR
   void SendRerrMessage (Ptr<Packet> packet,  std::vector<Ipv4Address> precursors);
   /**
@@ -450,8 +611,6 @@ private:
 
   int get_rreptimes;
 
-  std::vector<Ipv4Address> WH_List;
-
   int rreq_count;
   int rrep_count;
 
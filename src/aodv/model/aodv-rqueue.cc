@@ -27,7 +27,6 @@
  */
 #include "aodv-rqueue.h"
 #include <algorithm>
-#include <functional>
 #include "ns3/ipv4-route.h"
 #include "ns3/socket.h"
 #include "ns3/log.h"
@@ -48,71 +47,100 @@ bool
 RequestQueue::Enqueue (QueueEntry & entry) //キュー内に同じパケットと宛先アドレスを持つエントリがない場合は、エントリをキューにプッシュします。
 {
   Purge ();
-  for (std::vector<QueueEntry>::const_iterator i = m_queue.begin (); i
-       != m_queue.end (); ++i)
+  Ipv4Address dst = entry.GetIpv4Header ().GetDestination ();
+  BucketMap::const_iterator b = m_buckets.find (dst);
+  if (b != m_buckets.end ()
+      && b->second.m_uids.find (entry.GetPacket ()->GetUid ()) != b->second.m_uids.end ())
     {
-      if ((i->GetPacket ()->GetUid () == entry.GetPacket ()->GetUid ())
-          && (i->GetIpv4Header ().GetDestination ()
-              == entry.GetIpv4Header ().GetDestination ()))
-        {
-          return false;
-        }
+      return false;
     }
   entry.SetExpireTime (m_queueTimeout);
   if (m_queue.size () == m_maxLen)
     {
       Drop (m_queue.front (), "Drop the most aged packet"); // Drop the most aged packet
-      m_queue.erase (m_queue.begin ());
+      Erase (m_queue.begin ());
     }
-  m_queue.push_back (entry);
+  Time expire = entry.GetExpireTime () + Simulator::Now ();
+  if (m_queue.empty ())
+    {
+      m_sorted = true;
+    }
+  else if (expire < m_lastExpire)
+    {
+      // the timeout was shortened, this entry may expire before older ones
+      m_sorted = false;
+    }
+  m_lastExpire = expire;
+  Bucket &bucket = m_buckets[dst];
+  bucket.m_entries.push_back (m_queue.insert (m_queue.end (), entry));
+  bucket.m_uids.insert (entry.GetPacket ()->GetUid ());
   return true;
 }
 
+void
+RequestQueue::Erase (std::list<QueueEntry>::iterator i)
+{
+  BucketMap::iterator b = m_buckets.find (i->GetIpv4Header ().GetDestination ());
+  NS_ASSERT (b != m_buckets.end ());
+  Bucket &bucket = b->second;
+  if (bucket.m_entries.front () == i)
+    {
+      bucket.m_entries.pop_front ();
+    }
+  else
+    {
+      bucket.m_entries.erase (std::find (bucket.m_entries.begin (), bucket.m_entries.end (), i));
+    }
+  bucket.m_uids.erase (i->GetPacket ()->GetUid ());
+  if (bucket.m_entries.empty ())
+    {
+      m_buckets.erase (b);
+    }
+  m_queue.erase (i);
+}
+
 void
 RequestQueue::DropPacketWithDst (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
   Purge ();
-  for (std::vector<QueueEntry>::iterator i = m_queue.begin (); i
-       != m_queue.end (); ++i)
+  BucketMap::iterator b = m_buckets.find (dst);
+  if (b == m_buckets.end ())
     {
-      if (IsEqual (*i, dst))
-        {
-          Drop (*i, "DropPacketWithDst ");
-        }
+      return;
+    }
+  for (std::deque<std::list<QueueEntry>::iterator>::const_iterator i = b->second.m_entries.begin ();
+       i != b->second.m_entries.end (); ++i)
+    {
+      Drop (**i, "DropPacketWithDst ");
+    }
+  for (std::deque<std::list<QueueEntry>::iterator>::const_iterator i = b->second.m_entries.begin ();
+       i != b->second.m_entries.end (); ++i)
+    {
+      m_queue.erase (*i);
     }
-  m_queue.erase (std::remove_if (m_queue.begin (), m_queue.end (),
-                                 std::bind2nd (std::ptr_fun (RequestQueue::IsEqual), dst)), m_queue.end ());
+  m_buckets.erase (b);
 }
 
 bool
 RequestQueue::Dequeue (Ipv4Address dst, QueueEntry & entry)
 {
   Purge ();
-  for (std::vector<QueueEntry>::iterator i = m_queue.begin (); i != m_queue.end (); ++i)
+  BucketMap::const_iterator b = m_buckets.find (dst);
+  if (b == m_buckets.end ())
     {
-      if (i->GetIpv4Header ().GetDestination () == dst)
-        {
-          entry = *i;
-          m_queue.erase (i);
-          return true;
-        }
+      return false;
     }
-  return false;
+  std::list<QueueEntry>::iterator i = b->second.m_entries.front ();
+  entry = *i;
+  Erase (i);
+  return true;
 }
 
 bool
 RequestQueue::Find (Ipv4Address dst)
 {
-  for (std::vector<QueueEntry>::const_iterator i = m_queue.begin (); i
-       != m_queue.end (); ++i)
-    {
-      if (i->GetIpv4Header ().GetDestination () == dst)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_buckets.find (dst) != m_buckets.end ();
 }
 
 /**
@@ -137,16 +165,27 @@ void
 RequestQueue::Purge ()
 {
   IsExpired pred;
-  for (std::vector<QueueEntry>::iterator i = m_queue.begin (); i
-       != m_queue.end (); ++i)
+  if (m_sorted)
+    {
+      // the entries expire oldest first, stop at the first one alive
+      while (!m_queue.empty () && pred (m_queue.front ()))
+        {
+          Drop (m_queue.front (), "Drop outdated packet ");
+          Erase (m_queue.begin ());
+        }
+      return;
+    }
+  for (std::list<QueueEntry>::iterator i = m_queue.begin (); i != m_queue.end (); )
     {
+      std::list<QueueEntry>::iterator next = i;
+      ++next;
       if (pred (*i))
         {
           Drop (*i, "Drop outdated packet ");
+          Erase (i);
         }
+      i = next;
     }
-  m_queue.erase (std::remove_if (m_queue.begin (), m_queue.end (), pred),
-                 m_queue.end ());
 }
 
 void
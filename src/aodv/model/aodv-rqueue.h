@@ -28,6 +28,10 @@
 #ifndef AODV_RQUEUE_H
 #define AODV_RQUEUE_H
 
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/simulator.h"
@@ -176,6 +180,11 @@ private:
  * \brief AODV route request queue
  *
  * Since AODV is an on demand routing we queue requests while looking for route.
+ *
+ * The entries are kept in a list, oldest first, for the expiry and for
+ * dropping the most aged packet when the queue is full, and indexed by
+ * destination with a FIFO of list positions and the set of packet UIDs,
+ * so that queuing, dequeuing and dropping a packet cost constant time.
  */
 class RequestQueue
 {
@@ -187,7 +196,9 @@ public:
    * \param routeToQueueTimeout the route to queue timeout
    */
   RequestQueue (uint32_t maxLen, Time routeToQueueTimeout)
-    : m_maxLen (maxLen),
+    : m_lastExpire (Seconds (0)),
+      m_sorted (true),
+      m_maxLen (maxLen),
       m_queueTimeout (routeToQueueTimeout)
   {
   }
@@ -257,10 +268,32 @@ public:
   }
 
 private:
-  /// The queue
-  std::vector<QueueEntry> m_queue;
+  /// The entries of a destination
+  struct Bucket
+  {
+    /// The entries, oldest first
+    std::deque<std::list<QueueEntry>::iterator> m_entries;
+    /// The UIDs of their packets
+    std::unordered_set<uint64_t> m_uids;
+  };
+  /// Buckets by destination
+  typedef std::unordered_map<Ipv4Address, Bucket, Ipv4AddressHash> BucketMap;
+
+  /// The queue, oldest first
+  std::list<QueueEntry> m_queue;
+  /// The entries by destination
+  BucketMap m_buckets;
+  /// Expire time of the newest entry
+  Time m_lastExpire;
+  /// Whether the entries expire in the order of the queue, i.e. the timeout was not shortened
+  bool m_sorted;
   /// Remove all expired entries
   void Purge ();
+  /**
+   * Remove an entry from the queue and from the index of its destination
+   * \param i the entry
+   */
+  void Erase (std::list<QueueEntry>::iterator i);
   /**
    * Notify that packet is dropped from queue by timeout
    * \param en the queue entry to drop
@@ -271,16 +304,6 @@ private:
   uint32_t m_maxLen;
   /// The maximum period of time that a routing protocol is allowed to buffer a packet for, seconds.
   Time m_queueTimeout;
-  /**
-   * Determine if queue matches a destination address
-   * \param en The queue entry
-   * \param dst The destination IPv4 address
-   * \returns true if the queue entry matches the destination address
-   */
-  static bool IsEqual (QueueEntry en, const Ipv4Address dst)
-  {
-    return (en.GetIpv4Header ().GetDestination () == dst);
-  }
 };
 
 
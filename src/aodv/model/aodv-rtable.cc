@@ -222,8 +222,7 @@ RoutingTable::LookupRoute (Ipv4Address id, RoutingTableEntry & rt)
       NS_LOG_LOGIC ("Route to " << id << " not found; m_ipv4AddressEntry is empty");
       return false;
     }
-  std::map<Ipv4Address, RoutingTableEntry>::const_iterator i =
-    m_ipv4AddressEntry.find (id);
+  EntryMap::const_iterator i = m_ipv4AddressEntry.find (id);
   if (i == m_ipv4AddressEntry.end ())
     {
       NS_LOG_LOGIC ("Route to " << id << " not found");
@@ -271,8 +270,12 @@ RoutingTable::AddRoute (RoutingTableEntry & rt)
       rt.SetRreqCnt (0);
     }
     //std::pair ２つの異なる方の値を保持する組を表現するためのクラス
-  std::pair<std::map<Ipv4Address, RoutingTableEntry>::iterator, bool> result =
-    m_ipv4AddressEntry.insert (std::make_pair (rt.GetDestination (), rt)); //(std::map)m_ipv4AddressEntry.insert:平衡２分木二要素を挿入
+  std::pair<EntryMap::iterator, bool> result =
+    m_ipv4AddressEntry.insert (std::make_pair (rt.GetDestination (), rt)); //ハッシュマップに要素を挿入
+  if (result.second)
+    {
+      QueueExpiry (rt);
+    }
   return result.second;
 }
 
@@ -280,8 +283,7 @@ bool
 RoutingTable::Update (RoutingTableEntry & rt)
 {
   NS_LOG_FUNCTION (this);
-  std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-    m_ipv4AddressEntry.find (rt.GetDestination ());
+  EntryMap::iterator i = m_ipv4AddressEntry.find (rt.GetDestination ());
   if (i == m_ipv4AddressEntry.end ())
     {
       NS_LOG_LOGIC ("Route update to " << rt.GetDestination () << " fails; not found");
@@ -293,6 +295,7 @@ RoutingTable::Update (RoutingTableEntry & rt)
       NS_LOG_LOGIC ("Route update to " << rt.GetDestination () << " set RreqCnt to 0");
       i->second.SetRreqCnt (0);
     }
+  QueueExpiry (i->second);
   return true;
 }
 
@@ -301,8 +304,7 @@ bool
 RoutingTable::SetEntryState (Ipv4Address id, RouteFlags state)
 {
   NS_LOG_FUNCTION (this);
-  std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-    m_ipv4AddressEntry.find (id);
+  EntryMap::iterator i = m_ipv4AddressEntry.find (id);
   if (i == m_ipv4AddressEntry.end ())
     {
       NS_LOG_LOGIC ("Route set entry state to " << id << " fails; not found");
@@ -310,6 +312,8 @@ RoutingTable::SetEntryState (Ipv4Address id, RouteFlags state)
     }
   i->second.SetFlag (state);
   i->second.SetRreqCnt (0);
+  // an entry in search is not expired, it may be now
+  QueueExpiry (i->second);
   NS_LOG_LOGIC ("Route set entry state to " << id << ": new state is " << state);
   return true;
 }
@@ -320,8 +324,7 @@ RoutingTable::GetListOfDestinationWithNextHop (Ipv4Address nextHop, std::map<Ipv
   NS_LOG_FUNCTION (this);
   Purge ();
   unreachable.clear ();
-  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
+  for (EntryMap::const_iterator i = m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
     {
       if (i->second.GetNextHop () == nextHop)
         {
@@ -331,22 +334,43 @@ RoutingTable::GetListOfDestinationWithNextHop (Ipv4Address nextHop, std::map<Ipv
     }
 }
 
+void
+RoutingTable::GetListOfDestinationWithNextHops (std::vector<Ipv4Address> const & nextHops,
+                                                std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> > & unreachable)
+{
+  NS_LOG_FUNCTION (this);
+  Purge ();
+  unreachable.clear ();
+  for (std::vector<Ipv4Address>::const_iterator i = nextHops.begin (); i != nextHops.end (); ++i)
+    {
+      unreachable[*i];
+    }
+  for (EntryMap::const_iterator i = m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
+    {
+      std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> >::iterator j =
+        unreachable.find (i->second.GetNextHop ());
+      if (j != unreachable.end ())
+        {
+          NS_LOG_LOGIC ("Unreachable insert " << i->first << " " << i->second.GetSeqNo ());
+          j->second.insert (std::make_pair (i->first, i->second.GetSeqNo ()));
+        }
+    }
+}
+
 void
 RoutingTable::InvalidateRoutesWithDst (const std::map<Ipv4Address, uint32_t> & unreachable)
 {
   NS_LOG_FUNCTION (this);
   Purge ();
-  for (std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
+  for (std::map<Ipv4Address, uint32_t>::const_iterator j =
+         unreachable.begin (); j != unreachable.end (); ++j)
     {
-      for (std::map<Ipv4Address, uint32_t>::const_iterator j =
-             unreachable.begin (); j != unreachable.end (); ++j)
+      EntryMap::iterator i = m_ipv4AddressEntry.find (j->first);
+      if (i != m_ipv4AddressEntry.end () && i->second.GetFlag () == VALID)
         {
-          if ((i->first == j->first) && (i->second.GetFlag () == VALID))
-            {
-              NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
-              i->second.Invalidate (m_badLinkLifetime);
-            }
+          NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
+          i->second.Invalidate (m_badLinkLifetime);
+          QueueExpiry (i->second);
         }
     }
 }
@@ -359,14 +383,11 @@ RoutingTable::DeleteAllRoutesFromInterface (Ipv4InterfaceAddress iface)
     {
       return;
     }
-  for (std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); )
+  for (EntryMap::iterator i = m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); )
     {
       if (i->second.GetInterface () == iface)
         {
-          std::map<Ipv4Address, RoutingTableEntry>::iterator tmp = i;
-          ++i;
-          m_ipv4AddressEntry.erase (tmp);
+          i = m_ipv4AddressEntry.erase (i);
         }
       else
         {
@@ -379,36 +400,45 @@ void
 RoutingTable::Purge ()
 {
   NS_LOG_FUNCTION (this);
-  if (m_ipv4AddressEntry.empty ())
-    {
-      return;
-    }
-  for (std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-         m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); )
+  Time now = Simulator::Now ();
+  while (!m_expiry.empty () && m_expiry.top ().m_expire < now)
     {
-      if (i->second.GetLifeTime () < Seconds (0))
+      Ipv4Address dst = m_expiry.top ().m_dst;
+      m_expiry.pop ();
+      EntryMap::iterator i = m_ipv4AddressEntry.find (dst);
+      // the entry was deleted, or its lifetime changed and was queued again
+      if (i == m_ipv4AddressEntry.end () || i->second.GetLifeTime () >= Seconds (0))
         {
-          if (i->second.GetFlag () == INVALID)
-            {
-              std::map<Ipv4Address, RoutingTableEntry>::iterator tmp = i;
-              ++i;
-              m_ipv4AddressEntry.erase (tmp);
-            }
-          else if (i->second.GetFlag () == VALID)
-            {
-              NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
-              i->second.Invalidate (m_badLinkLifetime);
-              ++i;
-            }
-          else
-            {
-              ++i;
-            }
+          continue;
         }
-      else
+      if (i->second.GetFlag () == INVALID)
         {
-          ++i;
+          m_ipv4AddressEntry.erase (i);
+        }
+      else if (i->second.GetFlag () == VALID)
+        {
+          NS_LOG_LOGIC ("Invalidate route with destination address " << i->first);
+          i->second.Invalidate (m_badLinkLifetime);
+          QueueExpiry (i->second);
+        }
+    }
+}
+
+void
+RoutingTable::QueueExpiry (RoutingTableEntry const & rt)
+{
+  Expiry expiry = { rt.GetDestination (), rt.GetLifeTime () + Simulator::Now () };
+  m_expiry.push (expiry);
+  // entries refreshed for every packet leave many outdated elements, drop them
+  if (m_expiry.size () > 2 * m_ipv4AddressEntry.size () + 64)
+    {
+      ExpiryQueue expiries;
+      for (EntryMap::const_iterator i = m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); ++i)
+        {
+          Expiry current = { i->first, i->second.GetLifeTime () + Simulator::Now () };
+          expiries.push (current);
         }
+      m_expiry.swap (expiries);
     }
 }
 
@@ -453,8 +483,7 @@ bool
 RoutingTable::MarkLinkAsUnidirectional (Ipv4Address neighbor, Time blacklistTimeout)
 {
   NS_LOG_FUNCTION (this << neighbor << blacklistTimeout.GetSeconds ());
-  std::map<Ipv4Address, RoutingTableEntry>::iterator i =
-    m_ipv4AddressEntry.find (neighbor);
+  EntryMap::iterator i = m_ipv4AddressEntry.find (neighbor);
   if (i == m_ipv4AddressEntry.end ())
     {
       NS_LOG_LOGIC ("Mark link unidirectional to  " << neighbor << " fails; not found");
@@ -470,7 +499,8 @@ RoutingTable::MarkLinkAsUnidirectional (Ipv4Address neighbor, Time blacklistTime
 void
 RoutingTable::Print (Ptr<OutputStreamWrapper> stream) const
 {
-  std::map<Ipv4Address, RoutingTableEntry> table = m_ipv4AddressEntry;
+  // sorted by destination
+  std::map<Ipv4Address, RoutingTableEntry> table (m_ipv4AddressEntry.begin (), m_ipv4AddressEntry.end ());
   Purge (table);
   *stream->GetStream () << "\nAODV Routing table\n"
                         << "Destination\tGateway\t\tInterface\tFlag\tExpire\t\tHops\n";
@@ -30,7 +30,11 @@
 
 #include <stdint.h>
 #include <cassert>
+#include <functional>
 #include <map>
+#include <queue>
+#include <unordered_map>
+#include <vector>
 #include <sys/types.h>
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-route.h"
@@ -406,6 +410,12 @@ private:
 /**
  * \ingroup aodv
  * \brief The Routing table used by AODV protocol
+ *
+ * Entries are kept in a hash map keyed on the destination for constant time
+ * lookup.  Expiry is driven by a queue ordered by lifetime, with an element
+ * pushed each time an entry is added or changed, so a purge only touches the
+ * entries whose lifetime actually passed; the elements left behind by later
+ * changes are skipped when they come out of the queue.
  */
 class RoutingTable //AODVプロトコルで使用されるルーティングテーブル　ルーティングテーブル全体の操作？
 {
@@ -472,6 +482,14 @@ public:
    * \param unreachable
    */
   void GetListOfDestinationWithNextHop (Ipv4Address nextHop, std::map<Ipv4Address, uint32_t> & unreachable);
+  /**
+   * Lookup the routes through several next hops in one pass over the table.
+   *
+   * \param nextHops the next hop IP addresses
+   * \param unreachable the destinations with their sequence number, per next hop
+   */
+  void GetListOfDestinationWithNextHops (std::vector<Ipv4Address> const & nextHops,
+                                         std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> > & unreachable);
   /**
    *   この宛先を持つルーティングエントリーを以下のように更新する：
    *  1. このルーティングエントリの宛先シーケンス番号(もし存在し有効であれば)は、
@@ -490,6 +508,7 @@ public:
   void Clear ()
   {
     m_ipv4AddressEntry.clear ();
+    m_expiry = ExpiryQueue ();
   }
   /// すべての古いエントリーを削除し、有効期限が切れている場合は有効なエントリーを無効にする。
   void Purge ();
@@ -507,11 +526,40 @@ public:
   void Print (Ptr<OutputStreamWrapper> stream) const;
 
 private:
+  /// Lifetime of an entry waiting for expiration
+  struct Expiry
+  {
+    /// Destination of the entry
+    Ipv4Address m_dst;
+    /// Lifetime of the entry when it was queued
+    Time m_expire;
+    /**
+     * \brief Order by expiration time
+     * \param o the other element
+     * \return true if this element expires later than \p o
+     */
+    bool operator> (const Expiry & o) const
+    {
+      return m_expire > o.m_expire;
+    }
+  };
+  /// Queue of lifetimes, earliest expiration first
+  typedef std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry> > ExpiryQueue;
+  /// Routing table entries by destination
+  typedef std::unordered_map<Ipv4Address, RoutingTableEntry, Ipv4AddressHash> EntryMap;
+
   /// ルーティングテーブル
-  //(key,value)のペアで構成される標準的なコンテナで、キーに基づいて対数時間で検索することができる。
-  std::map<Ipv4Address, RoutingTableEntry> m_ipv4AddressEntry;
+  //宛先をキーとするハッシュマップで、定数時間で検索することができる。
+  EntryMap m_ipv4AddressEntry;
+  /// Lifetimes of the entries, may hold several elements per entry
+  ExpiryQueue m_expiry;
   /// 無効なルートの削除時間
   Time m_badLinkLifetime;
+  /**
+   * Queue the current lifetime of an entry, after it was added or changed.
+   * \param rt the entry
+   */
+  void QueueExpiry (RoutingTableEntry const & rt);
   /**
    * Print() メソッドで使用する、Purge の const バージョン。
    * \param table パージするルーティングテーブルエントリ
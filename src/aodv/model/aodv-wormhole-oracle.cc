@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "aodv-wormhole-oracle.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AodvWormholeOracle");
+
+namespace aodv {
+NS_OBJECT_ENSURE_REGISTERED (WormholeOracle);
+
+TypeId
+WormholeOracle::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::aodv::WormholeOracle")
+    .SetParent<Object> ()
+    .SetGroupName ("Aodv")
+    .AddConstructor<WormholeOracle> ()
+  ;
+  return tid;
+}
+
+WormholeOracle::WormholeOracle ()
+{
+}
+
+uint64_t
+WormholeOracle::MakeKey (Ipv4Address first, Ipv4Address second)
+{
+  uint32_t a = std::min (first.Get (), second.Get ());
+  uint32_t b = std::max (first.Get (), second.Get ());
+  return (static_cast<uint64_t> (a) << 32) | b;
+}
+
+void
+WormholeOracle::AddTunnel (Ipv4Address first, Ipv4Address second)
+{
+  NS_LOG_FUNCTION (this << first << second);
+  m_links.insert (MakeKey (first, second));
+}
+
+void
+WormholeOracle::AddAlias (Ipv4Address alias, Ipv4Address primary)
+{
+  NS_LOG_FUNCTION (this << alias << primary);
+  m_aliases[alias.Get ()] = primary.Get ();
+}
+
+bool
+WormholeOracle::IsWormholeLink (Ipv4Address first, Ipv4Address second) const
+{
+  return m_links.find (MakeKey (first, second)) != m_links.end ();
+}
+
+Ipv4Address
+WormholeOracle::GetPrimaryAddress (Ipv4Address address) const
+{
+  std::unordered_map<uint32_t, uint32_t>::const_iterator i = m_aliases.find (address.Get ());
+  return i == m_aliases.end () ? address : Ipv4Address (i->second);
+}
+
+uint32_t
+WormholeOracle::GetNTunnels (void) const
+{
+  return m_links.size ();
+}
+
+void
+WormholeOracle::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_links.clear ();
+  m_aliases.clear ();
+}
+
+} // namespace aodv
+} // namespace ns3
@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef AODV_WORMHOLE_ORACLE_H
+#define AODV_WORMHOLE_ORACLE_H
+
+#include "ns3/object.h"
+#include "ns3/ipv4-address.h"
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv
+ *
+ * \brief Ground truth of the wormhole tunnels of a simulation.
+ *
+ * The oracle tells whether the link checked by a WHCS is a wormhole
+ * tunnel, so that the detection statistics can tell detections from
+ * false positives, and maps the addresses of the tunnel interfaces to the
+ * primary (wireless) address of their node, which is the address the
+ * other nodes know the tunnel endpoint by.
+ *
+ * A tunnel is stored as the unordered pair of the primary addresses of
+ * its endpoints, both lookups are hash lookups.  The oracle is filled
+ * while the scenario is built (see WormholeAttackHelper::AssignAddresses)
+ * and only read while the simulation runs, so it is shared by all
+ * RoutingProtocol objects without locking.
+ */
+class WormholeOracle : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  WormholeOracle ();
+
+  /**
+   * Register a tunnel
+   * \param first the primary address of one endpoint
+   * \param second the primary address of the other endpoint
+   */
+  void AddTunnel (Ipv4Address first, Ipv4Address second);
+  /**
+   * Register the address of a tunnel interface
+   * \param alias the address of the tunnel interface
+   * \param primary the primary address of its node
+   */
+  void AddAlias (Ipv4Address alias, Ipv4Address primary);
+  /**
+   * \param first the primary address of one end of the link
+   * \param second the primary address of the other end of the link
+   * \returns true if the link is a wormhole tunnel, in either direction
+   */
+  bool IsWormholeLink (Ipv4Address first, Ipv4Address second) const;
+  /**
+   * \param address an address
+   * \returns the primary address of the node if address is a tunnel
+   * interface, address otherwise
+   */
+  Ipv4Address GetPrimaryAddress (Ipv4Address address) const;
+  /**
+   * \returns the number of registered tunnels
+   */
+  uint32_t GetNTunnels (void) const;
+  /// Forget all tunnels and aliases
+  void Clear (void);
+
+private:
+  /**
+   * \param first one end of the link
+   * \param second the other end of the link
+   * \returns the key of the link in m_links, the same in both directions
+   */
+  static uint64_t MakeKey (Ipv4Address first, Ipv4Address second);
+
+  std::unordered_set<uint64_t> m_links;             ///< Tunnels, see MakeKey
+  std::unordered_map<uint32_t, uint32_t> m_aliases; ///< Tunnel interface address to primary address
+};
+
+} // namespace aodv
+} // namespace ns3
+
+#endif /* AODV_WORMHOLE_ORACLE_H */
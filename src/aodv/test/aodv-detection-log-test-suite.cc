@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/aodv-detection-log.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include <cstring>
+#include <fstream>
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the CSV sink of the detection event log
+ */
+class DetectionLogCsvTest : public TestCase
+{
+public:
+  DetectionLogCsvTest () : TestCase ("Detection event log, CSV sink")
+  {
+  }
+  virtual void DoRun ();
+
+private:
+  /**
+   * Record one event
+   * \param type the event type
+   * \param id the message id
+   */
+  void DoRecord (DetectionEvent::Type type, uint32_t id);
+  /**
+   * Count the lines of the output file
+   * \returns the number of lines
+   */
+  uint32_t CountLines () const;
+  /// Check the buffer after the threshold is reached
+  void CheckFlushed ();
+
+  /// Log under test
+  Ptr<DetectionEventLog> m_log;
+  /// Output file
+  std::string m_file;
+};
+
+void
+DetectionLogCsvTest::DoRecord (DetectionEvent::Type type, uint32_t id)
+{
+  m_log->Record (type, 7, id, 1, 3, Ipv4Address ("10.0.0.1"));
+}
+
+uint32_t
+DetectionLogCsvTest::CountLines () const
+{
+  std::ifstream in (m_file.c_str ());
+  std::string line;
+  uint32_t n = 0;
+  while (std::getline (in, line))
+    {
+      ++n;
+    }
+  return n;
+}
+
+void
+DetectionLogCsvTest::CheckFlushed ()
+{
+  NS_TEST_EXPECT_MSG_EQ (m_log->GetBuffered ().size (), 0, "Buffer written at the threshold");
+  NS_TEST_EXPECT_MSG_EQ (CountLines (), 4, "Header and three events");
+}
+
+void
+DetectionLogCsvTest::DoRun ()
+{
+  m_file = CreateTempDirFilename ("aodv-detection.csv");
+  m_log = CreateObject<DetectionEventLog> ();
+  m_log->SetAttribute ("FileName", StringValue (m_file));
+  m_log->SetAttribute ("FlushThreshold", UintegerValue (3));
+
+  Simulator::Schedule (Seconds (1), &DetectionLogCsvTest::DoRecord, this, DetectionEvent::RREQ_RECV, 1);
+  Simulator::Schedule (Seconds (2), &DetectionLogCsvTest::DoRecord, this, DetectionEvent::WHCS_SEND, 2);
+  Simulator::Schedule (Seconds (3), &DetectionLogCsvTest::DoRecord, this, DetectionEvent::WHCE_RECV, 3);
+  Simulator::Schedule (Seconds (4), &DetectionLogCsvTest::CheckFlushed, this);
+  Simulator::Schedule (Seconds (5), &DetectionLogCsvTest::DoRecord, this, DetectionEvent::RREP_RECV, 4);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_log->GetBuffered ().size (), 1, "Event kept in memory");
+  NS_TEST_EXPECT_MSG_EQ (CountLines (), 4, "Nothing written below the threshold");
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (CountLines (), 5, "Remaining event written at the end of the simulation");
+  NS_TEST_EXPECT_MSG_EQ (m_log->GetNRecorded (), 4, "Recorded events");
+
+  std::ifstream in (m_file.c_str ());
+  std::string line;
+  std::getline (in, line);
+  std::getline (in, line);
+  NS_TEST_EXPECT_MSG_EQ (line, "1000000000,7,RREQ_RECV,3,1,1,10.0.0.1,0.0.0.0,0.0.0.0", "First event");
+  m_log = 0;
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the binary sink of the detection event log
+ */
+class DetectionLogBinaryTest : public TestCase
+{
+public:
+  DetectionLogBinaryTest () : TestCase ("Detection event log, binary sink")
+  {
+  }
+  virtual void DoRun ();
+};
+
+void
+DetectionLogBinaryTest::DoRun ()
+{
+  std::string file = CreateTempDirFilename ("aodv-detection.bin");
+  Ptr<DetectionEventLog> log = CreateObject<DetectionEventLog> ();
+  log->SetAttribute ("FileName", StringValue (file));
+  log->SetAttribute ("Format", EnumValue (DetectionEventLog::BINARY));
+  log->Record (DetectionEvent::WHCS_RECV, 5, 42, 9, 2, Ipv4Address ("10.0.0.1"),
+               Ipv4Address ("10.0.0.2"), Ipv4Address ("10.0.0.3"));
+  log->Record (DetectionEvent::WHCE_SEND, 6, 43, 9, 0, Ipv4Address ("10.0.0.4"));
+  log->Flush ();
+  Simulator::Destroy ();
+
+  std::ifstream in (file.c_str (), std::ios::binary);
+  std::vector<char> data ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+  NS_TEST_ASSERT_MSG_EQ (data.size (), 12 + 2 * DetectionEventLog::BINARY_RECORD_SIZE, "File size");
+  NS_TEST_EXPECT_MSG_EQ (std::string (data.data (), 8), "AODVDLOG", "Magic");
+  uint32_t recordSize;
+  std::memcpy (&recordSize, &data[8], 4);
+  NS_TEST_EXPECT_MSG_EQ (recordSize, DetectionEventLog::BINARY_RECORD_SIZE, "Record size");
+
+  const char *r = &data[12];
+  uint32_t node, id, fir, second;
+  std::memcpy (&node, r + 8, 4);
+  std::memcpy (&id, r + 14, 4);
+  std::memcpy (&fir, r + 26, 4);
+  std::memcpy (&second, r + 30, 4);
+  NS_TEST_EXPECT_MSG_EQ (node, 5, "Node");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (r[12]), DetectionEvent::WHCS_RECV, "Type");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (r[13]), 2, "Hop count");
+  NS_TEST_EXPECT_MSG_EQ (id, 42, "Id");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4Address (fir), Ipv4Address ("10.0.0.2"), "First hop");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4Address (second), Ipv4Address ("10.0.0.3"), "Second hop");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Detection event log test suite
+ */
+class DetectionLogTestSuite : public TestSuite
+{
+public:
+  DetectionLogTestSuite () : TestSuite ("aodv-detection-log", UNIT)
+  {
+    AddTestCase (new DetectionLogCsvTest, TestCase::QUICK);
+    AddTestCase (new DetectionLogBinaryTest, TestCase::QUICK);
+  }
+} g_detectionLogTestSuite; ///< the test suite
+
+}  // namespace aodv
+}  // namespace ns3
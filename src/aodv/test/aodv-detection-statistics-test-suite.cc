@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/aodv-detection-statistics.h"
+#include "ns3/test.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the aggregation of the detection statistics
+ */
+class DetectionStatisticsSummaryTest : public TestCase
+{
+public:
+  DetectionStatisticsSummaryTest () : TestCase ("Detection statistics, summary")
+  {
+  }
+  virtual void DoRun ();
+};
+
+void
+DetectionStatisticsSummaryTest::DoRun ()
+{
+  Ptr<DetectionStatistics> stats = CreateObject<DetectionStatistics> ();
+
+  stats->MessageSent (0, DetectionStatistics::RREQ, 32);
+  stats->MessageSent (3, DetectionStatistics::RREQ, 32);
+  stats->MessageSent (1, DetectionStatistics::RREP, 20);
+  stats->MessageSent (1, DetectionStatistics::WHCS, 38);
+  stats->MessageSent (2, DetectionStatistics::WHCS, 38);
+  stats->MessageSent (4, DetectionStatistics::WHCE, 32);
+
+  // node 1: two normal links, one answered; node 2: the same id, answered
+  stats->JudgementSent (1, 7, false);
+  stats->JudgementSent (1, 8, false);
+  stats->JudgementSent (2, 7, false);
+  stats->JudgementAnswered (1, 7, false);
+  stats->JudgementAnswered (2, 7, false);
+  // node 2: two wormhole links, one judged normal
+  stats->JudgementSent (2, 9, true);
+  stats->JudgementSent (2, 10, true);
+  stats->JudgementAnswered (2, 9, true);
+  // node 3: a normal link and a wormhole link judged normal without a check
+  stats->JudgementSkipped (3, false);
+  stats->JudgementSkipped (3, true);
+
+  stats->CheckStarted (1);
+  stats->CheckStarted (2);
+
+  stats->RouteEstablished (0, MilliSeconds (30));
+  stats->RouteEstablished (0, MilliSeconds (10));
+  stats->RouteEstablished (5, MilliSeconds (20));
+  stats->CheckCompleted (1, MilliSeconds (4));
+
+  DetectionSummary s = stats->GetSummary ();
+  NS_TEST_EXPECT_MSG_EQ (s.rreqBytes, 64, "RREQ bytes");
+  NS_TEST_EXPECT_MSG_EQ (s.rrepBytes, 20, "RREP bytes");
+  NS_TEST_EXPECT_MSG_EQ (s.whcsBytes, 76, "WHCS bytes");
+  NS_TEST_EXPECT_MSG_EQ (s.whceBytes, 32, "WHCE bytes");
+  NS_TEST_EXPECT_MSG_EQ (s.checks, 2, "Checks");
+  NS_TEST_EXPECT_MSG_EQ (s.normalJudgements, 4, "Normal judgements");
+  NS_TEST_EXPECT_MSG_EQ (s.wormholeJudgements, 3, "Wormhole judgements");
+  NS_TEST_EXPECT_MSG_EQ (s.wormholesDetected, 1, "Wormholes detected");
+  NS_TEST_EXPECT_MSG_EQ (s.falsePositives, 1, "Unanswered check of node 1");
+  NS_TEST_EXPECT_MSG_EQ (s.uncheckedJudgements, 2, "Unchecked judgements");
+  NS_TEST_EXPECT_MSG_EQ_TOL (s.detectionRate, 1.0 / 3, 1e-9, "Detection rate");
+  NS_TEST_EXPECT_MSG_EQ_TOL (s.falsePositiveRate, 0.25, 1e-9, "False positive rate");
+  NS_TEST_EXPECT_MSG_EQ_TOL (s.costPerJudgement, 108.0 / 7, 1e-9, "Cost per judgement");
+  NS_TEST_EXPECT_MSG_EQ (s.routeSetups, 3, "Route setups");
+  NS_TEST_EXPECT_MSG_EQ (s.routeSetupTotal, MilliSeconds (60), "Route setup total");
+  NS_TEST_EXPECT_MSG_EQ (s.routeSetupMin, MilliSeconds (10), "Route setup min");
+  NS_TEST_EXPECT_MSG_EQ (s.routeSetupMean, MilliSeconds (20), "Route setup mean");
+  NS_TEST_EXPECT_MSG_EQ (s.routeSetupMax, MilliSeconds (30), "Route setup max");
+  NS_TEST_EXPECT_MSG_EQ_TOL (s.routeSetupP50, MilliSeconds (20), MilliSeconds (1), "Route setup p50");
+  NS_TEST_EXPECT_MSG_EQ (s.routeSetupP999, MilliSeconds (30), "Route setup p999 bounded by the max");
+  NS_TEST_EXPECT_MSG_EQ (stats->GetRouteSetupLatency ().GetCount (), 3, "Route setup histogram");
+  NS_TEST_EXPECT_MSG_EQ (s.checksCompleted, 1, "Checks completed");
+  NS_TEST_EXPECT_MSG_EQ (s.checkLatencyMax, MilliSeconds (4), "Check latency max");
+
+  DetectionNodeCounters c = stats->GetNodeCounters (2);
+  NS_TEST_EXPECT_MSG_EQ (c.whcsBytes, 38, "Node WHCS bytes");
+  NS_TEST_EXPECT_MSG_EQ (c.normalJudgements, 1, "Node normal judgements");
+  NS_TEST_EXPECT_MSG_EQ (c.wormholeJudgements, 2, "Node wormhole judgements");
+  NS_TEST_EXPECT_MSG_EQ (c.wormholeMisses, 1, "Node wormhole misses");
+  NS_TEST_EXPECT_MSG_EQ (stats->GetNodeCounters (1).checksCompleted, 1, "Node checks completed");
+  NS_TEST_EXPECT_MSG_EQ (stats->GetNodeCounters (3).uncheckedJudgements, 2, "Node unchecked judgements");
+  NS_TEST_EXPECT_MSG_EQ (stats->GetNodeCounters (3).wormholeMisses, 1, "Node unchecked wormhole");
+  NS_TEST_EXPECT_MSG_EQ (stats->GetNodeCounters (100).routeSetups, 0, "Unknown node");
+
+  stats->Reset ();
+  s = stats->GetSummary ();
+  NS_TEST_EXPECT_MSG_EQ (s.whcsBytes, 0, "Reset bytes");
+  NS_TEST_EXPECT_MSG_EQ (s.falsePositives, 0, "Reset pending checks");
+  NS_TEST_EXPECT_MSG_EQ (s.uncheckedJudgements, 0, "Reset unchecked judgements");
+  NS_TEST_EXPECT_MSG_EQ (s.detectionRate, 0, "No judgement");
+  NS_TEST_EXPECT_MSG_EQ (s.routeSetupMean, Time (0), "No route setup");
+  NS_TEST_EXPECT_MSG_EQ (s.routeSetupP99, Time (0), "No route setup percentile");
+  NS_TEST_EXPECT_MSG_EQ (s.checksCompleted, 0, "Reset check latencies");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Detection statistics test suite
+ */
+class DetectionStatisticsTestSuite : public TestSuite
+{
+public:
+  DetectionStatisticsTestSuite () : TestSuite ("aodv-detection-statistics", UNIT)
+  {
+    AddTestCase (new DetectionStatisticsSummaryTest, TestCase::QUICK);
+  }
+} g_detectionStatisticsTestSuite; ///< the test suite
+
+}  // namespace aodv
+}  // namespace ns3
@@ -105,6 +105,50 @@ IdCacheTest::CheckTimeout3 ()
   NS_TEST_EXPECT_MSG_EQ (cache.GetSize (), 0, "All records expire");
 }
 
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for id cache expiry when the lifetime is shortened
+ */
+class IdCacheExpiryOrderTest : public TestCase
+{
+public:
+  IdCacheExpiryOrderTest () : TestCase ("Id Cache expiry order"),
+                              cache (Seconds (10))
+  {
+  }
+  virtual void DoRun ();
+
+private:
+  /// Check that only the entry with the shorter lifetime expired
+  void CheckTimeout ();
+
+  /// ID cache
+  IdCache cache;
+};
+
+void
+IdCacheExpiryOrderTest::DoRun ()
+{
+  NS_TEST_EXPECT_MSG_EQ (cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 1), false, "Long lived entry");
+  cache.SetLifetime (Seconds (2));
+  NS_TEST_EXPECT_MSG_EQ (cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 2), false, "Short lived entry");
+  NS_TEST_EXPECT_MSG_EQ (cache.GetSize (), 2, "Both entries");
+
+  Simulator::Schedule (Seconds (3), &IdCacheExpiryOrderTest::CheckTimeout, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+IdCacheExpiryOrderTest::CheckTimeout ()
+{
+  NS_TEST_EXPECT_MSG_EQ (cache.GetSize (), 1, "Short lived entry expired first");
+  NS_TEST_EXPECT_MSG_EQ (cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 1), true, "Long lived entry kept");
+  NS_TEST_EXPECT_MSG_EQ (cache.IsDuplicate (Ipv4Address ("1.2.3.4"), 2), false, "Expired entry added again");
+}
+
 /**
  * \ingroup aodv-test
  * \ingroup tests
@@ -117,6 +161,7 @@ public:
   IdCacheTestSuite () : TestSuite ("aodv-routing-id-cache", UNIT)
   {
     AddTestCase (new IdCacheTest, TestCase::QUICK);
+    AddTestCase (new IdCacheExpiryOrderTest, TestCase::QUICK);
   }
 } g_idCacheTestSuite; ///< the test suite
 
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/aodv-latency-histogram.h"
+#include "ns3/test.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the percentiles of the latency histogram
+ */
+class LatencyHistogramPercentileTest : public TestCase
+{
+public:
+  LatencyHistogramPercentileTest () : TestCase ("Latency histogram, percentiles")
+  {
+  }
+  virtual void DoRun ();
+};
+
+void
+LatencyHistogramPercentileTest::DoRun ()
+{
+  LatencyHistogram h;
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile (50), Time (0), "Empty histogram");
+
+  // 1 ms .. 1000 ms: the p-th percentile is p * 10 ms
+  for (uint32_t i = 1; i <= 1000; ++i)
+    {
+      h.Record (MilliSeconds (i));
+    }
+  NS_TEST_EXPECT_MSG_EQ (h.GetCount (), 1000, "Count");
+  NS_TEST_EXPECT_MSG_EQ (h.GetMin (), MilliSeconds (1), "Min");
+  NS_TEST_EXPECT_MSG_EQ (h.GetMax (), MilliSeconds (1000), "Max");
+  NS_TEST_EXPECT_MSG_EQ (h.GetMean (), MicroSeconds (500500), "Mean");
+  // relative error at most 2^(1-6)
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetPercentile (50).GetSeconds (), 0.5, 0.5 / 32, "p50");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetPercentile (90).GetSeconds (), 0.9, 0.9 / 32, "p90");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetPercentile (99).GetSeconds (), 0.99, 0.99 / 32, "p99");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h.GetPercentile (99.9).GetSeconds (), 0.999, 0.999 / 32, "p999");
+  NS_TEST_EXPECT_MSG_EQ (h.GetPercentile (100), MilliSeconds (1000), "p100 is the max");
+  NS_TEST_EXPECT_MSG_EQ ((h.GetPercentile (50) >= MilliSeconds (500)), true, "Upper bound of the bucket");
+
+  // small values are exact
+  LatencyHistogram exact;
+  exact.Record (NanoSeconds (3));
+  exact.Record (NanoSeconds (5));
+  exact.Record (NanoSeconds (-2));
+  NS_TEST_EXPECT_MSG_EQ (exact.GetPercentile (50), NanoSeconds (3), "Exact small value");
+  NS_TEST_EXPECT_MSG_EQ (exact.GetMin (), Time (0), "Negative latency counted as zero");
+
+  // very large values do not overflow the buckets
+  exact.Record (Seconds (1e9));
+  NS_TEST_EXPECT_MSG_EQ (exact.GetPercentile (100), Seconds (1e9), "Large value");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for merging and resetting latency histograms
+ */
+class LatencyHistogramMergeTest : public TestCase
+{
+public:
+  LatencyHistogramMergeTest () : TestCase ("Latency histogram, merge")
+  {
+  }
+  virtual void DoRun ();
+};
+
+void
+LatencyHistogramMergeTest::DoRun ()
+{
+  LatencyHistogram a (8);
+  LatencyHistogram b (8);
+  a.Record (MilliSeconds (10));
+  b.Record (MilliSeconds (20));
+  b.Record (MilliSeconds (30));
+  a.Merge (b);
+  NS_TEST_EXPECT_MSG_EQ (a.GetCount (), 3, "Merged count");
+  NS_TEST_EXPECT_MSG_EQ (a.GetMax (), MilliSeconds (30), "Merged max");
+  NS_TEST_EXPECT_MSG_EQ_TOL (a.GetPercentile (50).GetSeconds (), 0.02, 0.02 / 128, "Merged p50");
+
+  LatencyHistogram empty (8);
+  empty.Merge (a);
+  NS_TEST_EXPECT_MSG_EQ (empty.GetMin (), MilliSeconds (10), "Merged into an empty histogram");
+
+  a.Reset ();
+  NS_TEST_EXPECT_MSG_EQ (a.GetCount (), 0, "Reset");
+  NS_TEST_EXPECT_MSG_EQ (a.GetMean (), Time (0), "Reset mean");
+  a.Record (MilliSeconds (5));
+  NS_TEST_EXPECT_MSG_EQ (a.GetPercentile (99), MilliSeconds (5), "Recorded after reset");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Latency histogram test suite
+ */
+class LatencyHistogramTestSuite : public TestSuite
+{
+public:
+  LatencyHistogramTestSuite () : TestSuite ("aodv-latency-histogram", UNIT)
+  {
+    AddTestCase (new LatencyHistogramPercentileTest, TestCase::QUICK);
+    AddTestCase (new LatencyHistogramMergeTest, TestCase::QUICK);
+  }
+} g_latencyHistogramTestSuite; ///< the test suite
+
+}  // namespace aodv
+}  // namespace ns3
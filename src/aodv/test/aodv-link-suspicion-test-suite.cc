@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/aodv-link-suspicion.h"
+#include "ns3/test.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the second hops known to be in radio range
+ */
+class LinkSuspicionSecondHopTest : public TestCase
+{
+public:
+  LinkSuspicionSecondHopTest () : TestCase ("Link suspicion, second hops")
+  {
+  }
+  virtual void DoRun ();
+};
+
+void
+LinkSuspicionSecondHopTest::DoRun ()
+{
+  Ipv4Address origin ("10.0.0.1");
+  Ipv4Address a ("10.0.0.2");
+  Ipv4Address b ("10.0.0.3");
+  Ipv4Address far ("10.0.0.9");
+  Time expire = Seconds (10);
+
+  // the first copy comes through a link out of radio range, and is the shortest
+  LinkSuspicion s;
+  s.RequestReceived (origin, 1, a, far, 2, expire);
+  s.RequestReceived (origin, 1, b, origin, 3, expire);
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, far), true, "Unknown second hop");
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, b, origin), false, "Second hop is the originator");
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, Ipv4Address::GetAny ()), false, "No second hop");
+
+  // the second hop reported by the same neighbor only
+  s.RequestReceived (origin, 2, a, far, 2, expire);
+  s.RequestReceived (origin, 2, b, origin, 3, expire);
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, far), true, "Reported by the neighbor itself");
+
+  // a second hop heard directly
+  s.NeighborHeard (far, expire);
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, far), false, "Second hop in radio range");
+  s.NeighborHeard (far, Seconds (0));
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, far), true, "Second hop lost");
+
+  // a second hop reported by another neighbor, before or after
+  s.RequestReceived (Ipv4Address ("10.0.0.4"), 1, b, far, 5, expire);
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, far), false, "Reported by another neighbor");
+  s.RequestReceived (origin, 3, a, far, 2, expire);
+  s.RequestReceived (origin, 3, b, origin, 3, expire);
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, far), false, "Reported by another neighbor before");
+  s.RequestReceived (origin, 4, a, far, 2, Seconds (0));
+  s.RequestReceived (Ipv4Address ("10.0.0.4"), 2, b, far, 5, Seconds (0));
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, far), true, "Reports expired");
+
+  s.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (s.GetNAddresses (), 0, "Cleared");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the hop counts of the copies of a flood
+ */
+class LinkSuspicionHopCountTest : public TestCase
+{
+public:
+  LinkSuspicionHopCountTest () : TestCase ("Link suspicion, hop counts")
+  {
+  }
+  virtual void DoRun ();
+};
+
+void
+LinkSuspicionHopCountTest::DoRun ()
+{
+  Ipv4Address origin ("10.0.0.1");
+  Ipv4Address a ("10.0.0.2");
+  Ipv4Address b ("10.0.0.3");
+  Ipv4Address c ("10.0.0.4");
+  Ipv4Address far ("10.0.0.9");
+  Time expire = Seconds (10);
+
+  LinkSuspicion s;
+  s.RequestReceived (origin, 1, a, far, 3, expire);
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, far), true, "Single copy");
+  s.RequestReceived (origin, 1, a, far, 2, expire);
+  s.RequestReceived (origin, 1, b, origin, 4, expire);
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, far), true, "Shorter than the other copies");
+  s.RequestReceived (origin, 1, c, origin, 3, expire);
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, far), false, "As short as another copy");
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, b, Ipv4Address ("10.0.0.8")), true,
+                         "Route not set by the first copy");
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (Ipv4Address ("10.0.0.5"), a, far), true, "Unknown flood");
+
+  // a new flood of the originator
+  s.RequestReceived (origin, 2, a, far, 3, expire);
+  s.RequestReceived (origin, 2, b, origin, 4, expire);
+  NS_TEST_EXPECT_MSG_EQ (s.IsSuspicious (origin, a, far), true, "New flood");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the pruning of the expired addresses
+ */
+class LinkSuspicionPruneTest : public TestCase
+{
+public:
+  LinkSuspicionPruneTest () : TestCase ("Link suspicion, pruning")
+  {
+  }
+  virtual void DoRun ();
+};
+
+void
+LinkSuspicionPruneTest::DoRun ()
+{
+  Ipv4Address origin ("10.0.0.1");
+  LinkSuspicion s;
+  for (uint32_t n = 0; n < 1000; n++)
+    {
+      s.NeighborHeard (Ipv4Address (uint32_t (0x0a010000 + n)), Seconds (0));
+      s.RequestReceived (origin, n, Ipv4Address ("10.0.0.2"), Ipv4Address (uint32_t (0x0a020000 + n)), 3,
+                         Seconds (0));
+    }
+  NS_TEST_EXPECT_MSG_LT (s.GetNAddresses (), 100, "Expired addresses pruned");
+
+  s.Clear ();
+  for (uint32_t n = 0; n < 1000; n++)
+    {
+      s.NeighborHeard (Ipv4Address (uint32_t (0x0a010000 + n)), Seconds (10));
+    }
+  NS_TEST_EXPECT_MSG_EQ (s.GetNAddresses (), 1000, "Live addresses kept");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Link suspicion test suite
+ */
+class LinkSuspicionTestSuite : public TestSuite
+{
+public:
+  LinkSuspicionTestSuite () : TestSuite ("aodv-link-suspicion", UNIT)
+  {
+    AddTestCase (new LinkSuspicionSecondHopTest, TestCase::QUICK);
+    AddTestCase (new LinkSuspicionHopCountTest, TestCase::QUICK);
+    AddTestCase (new LinkSuspicionPruneTest, TestCase::QUICK);
+  }
+} g_linkSuspicionTestSuite; ///< the test suite
+
+}  // namespace aodv
+}  // namespace ns3
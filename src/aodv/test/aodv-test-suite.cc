@@ -109,6 +109,72 @@ NeighborTest::DoRun ()
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the batched link failure notification of the neighbors
+ */
+struct NeighborBatchTest : public TestCase
+{
+  NeighborBatchTest () : TestCase ("Neighbor batch"),
+                         neighbor (0)
+  {
+  }
+  virtual void DoRun ();
+  /**
+   * Batch handler test function
+   * \param addrs the IPv4 addresses of the lost neighbors
+   */
+  void Handler (std::vector<Ipv4Address> const & addrs);
+  /// Check that the first three neighbors were lost at once, in the order they were added
+  void CheckTimeout ();
+  /// The Neighbors
+  Neighbors * neighbor;
+  /// The batches of lost neighbors
+  std::vector<std::vector<Ipv4Address> > lost;
+};
+
+void
+NeighborBatchTest::Handler (std::vector<Ipv4Address> const & addrs)
+{
+  lost.push_back (addrs);
+}
+
+void
+NeighborBatchTest::CheckTimeout ()
+{
+  NS_TEST_EXPECT_MSG_EQ (neighbor->IsNeighbor (Ipv4Address ("3.3.3.3")), false, "Neighbor doesn't exist");
+  NS_TEST_EXPECT_MSG_EQ (neighbor->IsNeighbor (Ipv4Address ("4.4.4.4")), true, "Neighbor exists");
+  NS_TEST_ASSERT_MSG_EQ (lost.size (), 1, "links not closed at once");
+  NS_TEST_ASSERT_MSG_EQ (lost[0].size (), 3, "unexpected number of closed links");
+  NS_TEST_EXPECT_MSG_EQ (lost[0][0], Ipv4Address ("3.3.3.3"), "closed links out of order");
+  NS_TEST_EXPECT_MSG_EQ (lost[0][1], Ipv4Address ("1.1.1.1"), "closed links out of order");
+  NS_TEST_EXPECT_MSG_EQ (lost[0][2], Ipv4Address ("2.2.2.2"), "closed links out of order");
+}
+
+void
+NeighborBatchTest::DoRun ()
+{
+  Neighbors nb (Seconds (10));
+  neighbor = &nb;
+  neighbor->SetBatchCallback (MakeCallback (&NeighborBatchTest::Handler, this));
+  neighbor->Update (Ipv4Address ("3.3.3.3"), Seconds (3));
+  neighbor->Update (Ipv4Address ("1.1.1.1"), Seconds (1));
+  neighbor->Update (Ipv4Address ("2.2.2.2"), Seconds (2));
+  neighbor->Update (Ipv4Address ("4.4.4.4"), Seconds (20));
+  // a shorter lifetime does not shorten the expire time
+  neighbor->Update (Ipv4Address ("3.3.3.3"), Seconds (1));
+  NS_TEST_EXPECT_MSG_EQ (neighbor->GetExpireTime (Ipv4Address ("3.3.3.3")), Seconds (3), "Known expire time");
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      neighbor->Update (Ipv4Address ("4.4.4.4"), Seconds (5));
+    }
+  Simulator::Schedule (Seconds (5), &NeighborBatchTest::CheckTimeout, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup aodv-test
  * \ingroup tests
@@ -296,6 +362,188 @@ struct RerrHeaderTest : public TestCase
   }
 };
 
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for WHCS_BATCH
+ */
+struct WHCheckBatchHeaderTest : public TestCase
+{
+  WHCheckBatchHeaderTest () : TestCase ("AODV WHCS_BATCH")
+  {
+  }
+  virtual void DoRun ()
+  {
+    WHCheckBatchHeader h;
+    WHCheckBatchEntry e1 = { Ipv4Address ("1.2.3.4"), 10, 1, Ipv4Address ("1.1.1.1"), Ipv4Address ("2.2.2.2"), 0, 1 };
+    WHCheckBatchEntry e2 = { Ipv4Address ("4.3.2.1"), 20, 7, Ipv4Address ("3.3.3.3"), Ipv4Address ("4.4.4.4"), 2, 0 };
+    WHCheckBatchEntry e3 = { Ipv4Address ("1.2.3.4"), 11, 2, Ipv4Address ("1.1.1.1"), Ipv4Address ("5.5.5.5"), 0, 1 };
+    NS_TEST_EXPECT_MSG_EQ (h.AddEntry (e1), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (h.AddEntry (e2), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (h.AddEntry (e3), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (h.GetNEntries (), 3, "trivial");
+    NS_TEST_EXPECT_MSG_EQ ((h.GetEntry (1) == e3), true, "Entries of an originator are contiguous");
+    NS_TEST_EXPECT_MSG_EQ (h.GetSerializedSize (), 1 + 2 * 5 + 3 * 18, "Originator sent once per group");
+
+    Ptr<Packet> p = Create<Packet> ();
+    p->AddHeader (h);
+    WHCheckBatchHeader h2;
+    uint32_t bytes = p->RemoveHeader (h2);
+    NS_TEST_EXPECT_MSG_EQ (bytes, h.GetSerializedSize (), "Round trip size");
+    NS_TEST_EXPECT_MSG_EQ ((h == h2), true, "Round trip serialization works");
+
+    h.Clear ();
+    for (uint32_t i = 0; i < WHCheckBatchHeader::MAX_ENTRIES; ++i)
+      {
+        e1.id = i;
+        h.AddEntry (e1);
+      }
+    NS_TEST_EXPECT_MSG_EQ (h.AddEntry (e2), false, "Full header");
+    NS_TEST_EXPECT_MSG_EQ (h.GetSerializedSize (), 1 + 5 + WHCheckBatchHeader::MAX_ENTRIES * 18, "One group");
+  }
+};
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for WHCS
+ */
+struct WHCheckHeaderTest : public TestCase
+{
+  WHCheckHeaderTest () : TestCase ("AODV WHCS")
+  {
+  }
+  virtual void DoRun ()
+  {
+    WHCheckHeader h (/*flags*/ 0, /*reserved*/ 0, /*hopCount*/ 6, /*id*/ 5, /*fir*/ Ipv4Address ("1.2.3.4"),
+                     /*firSeqNo*/ 300, /*origin*/ Ipv4Address ("4.3.2.1"), /*originSeqNo*/ 1,
+                     /*sec*/ Ipv4Address::GetAny (), /*src*/ Ipv4Address ("1.1.1.1"),
+                     /*dst*/ Ipv4Address ("2.2.2.2"), /*WHF*/ 1, /*rrepid*/ 3, /*WHflag*/ 1, /*rreqid*/ 70000);
+    NS_TEST_EXPECT_MSG_EQ (h.GetCompact (), false, "Standard encoding by default");
+    NS_TEST_EXPECT_MSG_EQ (h.GetSerializedSize (), 43, "Standard size");
+
+    Ptr<Packet> p = Create<Packet> ();
+    p->AddHeader (h);
+    WHCheckHeader h2;
+    p->RemoveHeader (h2);
+    NS_TEST_EXPECT_MSG_EQ ((h == h2), true, "Round trip serialization works");
+
+    h.SetCompact (true);
+    NS_TEST_EXPECT_MSG_EQ (h.GetCompact (), true, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (h.GetSerializedSize (), 29, "Varint IDs and no second hop");
+    p = Create<Packet> ();
+    p->AddHeader (h);
+    WHCheckHeader h3;
+    uint32_t bytes = p->RemoveHeader (h3);
+    NS_TEST_EXPECT_MSG_EQ (bytes, 29, "Round trip size");
+    NS_TEST_EXPECT_MSG_EQ ((h == h3), true, "Round trip serialization works");
+    NS_TEST_EXPECT_MSG_EQ (h3.GetSecond (), Ipv4Address::GetAny (), "Elided address");
+    NS_TEST_EXPECT_MSG_EQ (h3.GetFirSeqno (), 300, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (h3.GetWHF (), 1, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (h3.GetRREPid (), 3, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (h3.GetWH_Flag (), 1, "trivial");
+    NS_TEST_EXPECT_MSG_EQ (h3.GetRREQID (), 70000, "trivial");
+  }
+};
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for WHCE
+ */
+struct WHEndHeaderTest : public TestCase
+{
+  WHEndHeaderTest () : TestCase ("AODV WHCE")
+  {
+  }
+  virtual void DoRun ()
+  {
+    WHEndHeader h (/*prefixSize*/ 0, /*hopCount*/ 2, /*id*/ 200, /*dst*/ Ipv4Address ("1.2.3.4"),
+                   /*dstSeqNo*/ 9, /*origin*/ Ipv4Address ("4.3.2.1"), /*source*/ Ipv4Address::GetAny (),
+                   /*aodv_dst*/ Ipv4Address::GetAny (), /*lifetime*/ Seconds (3), /*rrepid*/ 4,
+                   /*WHflag*/ 0, /*rreqid*/ 12);
+    uint32_t size = h.GetSerializedSize ();
+    h.SetCompact (true);
+    NS_TEST_EXPECT_MSG_EQ (h.GetSerializedSize (), 3 + 1 + 2 + 4 + 1 + 4 + 2 + 2 + 1, "Compact size");
+    NS_TEST_EXPECT_MSG_LT (h.GetSerializedSize (), size, "Smaller than the standard encoding");
+
+    Ptr<Packet> p = Create<Packet> ();
+    p->AddHeader (h);
+    WHEndHeader h2;
+    uint32_t bytes = p->RemoveHeader (h2);
+    NS_TEST_EXPECT_MSG_EQ (bytes, h.GetSerializedSize (), "Round trip size");
+    NS_TEST_EXPECT_MSG_EQ ((h == h2), true, "Round trip serialization works");
+    NS_TEST_EXPECT_MSG_EQ (h2.GetSrc (), Ipv4Address::GetAny (), "Elided address");
+    NS_TEST_EXPECT_MSG_EQ (h2.GetLifeTime (), Seconds (3), "trivial");
+    NS_TEST_EXPECT_MSG_EQ (h2.GetRREQID (), 12, "trivial");
+
+    // ID 0 as a two bytes varint
+    uint8_t buffer[] = { 1, 0, 0, 0, 0x80, 0x00, 0, 0, 0, 0, 0 };
+    p = Create<Packet> (buffer, sizeof (buffer));
+    WHEndHeader h3;
+    bytes = p->PeekHeader (h3);
+    NS_TEST_EXPECT_MSG_EQ (bytes, sizeof (buffer), "Non minimal varint");
+    NS_TEST_EXPECT_MSG_EQ (h3.GetId (), 0, "trivial");
+  }
+};
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the forwarding of WHCS and WHCE without re-serialization
+ */
+struct ForwardPrefixHeaderTest : public TestCase
+{
+  ForwardPrefixHeaderTest () : TestCase ("AODV forward prefix")
+  {
+  }
+  virtual void DoRun ()
+  {
+    for (uint32_t compact = 0; compact < 2; ++compact)
+      {
+        WHCheckHeader h (/*flags*/ 0, /*reserved*/ 0, /*hopCount*/ 1, /*id*/ 5, /*fir*/ Ipv4Address ("1.2.3.4"),
+                         /*firSeqNo*/ 3, /*origin*/ Ipv4Address ("4.3.2.1"), /*originSeqNo*/ 1,
+                         /*sec*/ Ipv4Address ("5.5.5.5"), /*src*/ Ipv4Address ("1.1.1.1"),
+                         /*dst*/ Ipv4Address ("2.2.2.2"), /*WHF*/ 1, /*rrepid*/ 3, /*WHflag*/ 0, /*rreqid*/ 8);
+        h.SetCompact (compact);
+        Ptr<Packet> p = Create<Packet> ();
+        p->AddHeader (h);
+
+        WHCheckHeader received;
+        p->PeekHeader (received);
+        received.SetHopCount (2);
+        received.SetWHF (0);
+        Ptr<Packet> forwarded = received.GetForwardPrefix ().Patch (p);
+        NS_TEST_EXPECT_MSG_EQ (forwarded->GetSize (), p->GetSize (), "Same size");
+
+        WHCheckHeader h2;
+        forwarded->RemoveHeader (h2);
+        NS_TEST_EXPECT_MSG_EQ ((h2 == received), true, "Patched message");
+        NS_TEST_EXPECT_MSG_EQ (h2.GetHopCount (), 2, "Patched hop count");
+        NS_TEST_EXPECT_MSG_EQ (h2.GetWHF (), 0, "Patched WHF");
+        NS_TEST_EXPECT_MSG_EQ (h2.GetSecond (), Ipv4Address ("5.5.5.5"), "Other fields intact");
+        NS_TEST_EXPECT_MSG_EQ (h2.GetRREQID (), 8, "Other fields intact");
+      }
+
+    WHEndHeader e (/*prefixSize*/ 0, /*hopCount*/ 1, /*id*/ 7, /*dst*/ Ipv4Address ("1.2.3.4"));
+    e.SetCompact (true);
+    Ptr<Packet> p = Create<Packet> ();
+    p->AddHeader (e);
+    WHEndHeader received;
+    p->PeekHeader (received);
+    received.SetHopCount (4);
+    Ptr<Packet> forwarded = received.GetForwardPrefix ().Patch (p);
+    WHEndHeader e2;
+    forwarded->RemoveHeader (e2);
+    NS_TEST_EXPECT_MSG_EQ ((e2 == received), true, "Patched message");
+    NS_TEST_EXPECT_MSG_EQ (e2.GetHopCount (), 4, "Patched hop count");
+  }
+};
+
 /**
  * \ingroup aodv-test
  * \ingroup tests
@@ -495,6 +743,97 @@ AodvRqueueTest::CheckTimeout ()
   NS_TEST_EXPECT_MSG_EQ (q.GetSize (), 0, "Must be empty now");
 }
 
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the order of the AODV request queue: FIFO per
+ * destination, most aged packet dropped first, expiry with a shortened timeout
+ */
+struct AodvRqueueOrderTest : public TestCase
+{
+  AodvRqueueOrderTest () : TestCase ("Rqueue order"),
+                           q (3, Seconds (10)),
+                           drops (0)
+  {
+  }
+  virtual void DoRun ();
+  /**
+   * Error test function
+   * \param p The packet
+   * \param h The header
+   * \param e the socket error
+   */
+  void Error (Ptr<const Packet> p, const Ipv4Header & h, Socket::SocketErrno e)
+  {
+    drops++;
+  }
+  /**
+   * \param dst the destination
+   * \returns a new entry for the destination
+   */
+  QueueEntry Entry (Ipv4Address dst)
+  {
+    Ipv4Header h;
+    h.SetDestination (dst);
+    return QueueEntry (Create<Packet> (), h, Ipv4RoutingProtocol::UnicastForwardCallback (),
+                       MakeCallback (&AodvRqueueOrderTest::Error, this));
+  }
+  /// Check that only the entry queued with the shorter timeout expired
+  void CheckTimeout ();
+
+  /// Request queue
+  RequestQueue q;
+  /// Number of dropped packets
+  uint32_t drops;
+};
+
+void
+AodvRqueueOrderTest::DoRun ()
+{
+  Ipv4Address a ("1.1.1.1");
+  Ipv4Address b ("2.2.2.2");
+  QueueEntry a1 = Entry (a);
+  QueueEntry b1 = Entry (b);
+  QueueEntry a2 = Entry (a);
+  QueueEntry b2 = Entry (b);
+  NS_TEST_EXPECT_MSG_EQ (q.Enqueue (a1), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (q.Enqueue (b1), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (q.Enqueue (a2), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (q.Enqueue (a2), false, "duplicate packet queued");
+  // the queue is full, the most aged packet is dropped
+  NS_TEST_EXPECT_MSG_EQ (q.Enqueue (b2), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (drops, 1, "most aged packet not dropped");
+  NS_TEST_EXPECT_MSG_EQ (q.GetSize (), 3, "trivial");
+  QueueEntry entry;
+  NS_TEST_EXPECT_MSG_EQ (q.Dequeue (a, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetPacket (), a2.GetPacket (), "wrong packet dropped");
+  NS_TEST_EXPECT_MSG_EQ (q.Find (a), false, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (q.Dequeue (b, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetPacket (), b1.GetPacket (), "packets not dequeued in order");
+  NS_TEST_EXPECT_MSG_EQ (q.Dequeue (b, entry), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (entry.GetPacket (), b2.GetPacket (), "packets not dequeued in order");
+  NS_TEST_EXPECT_MSG_EQ (q.GetSize (), 0, "trivial");
+
+  // a packet queued after a shorter timeout expires before older ones
+  QueueEntry a3 = Entry (a);
+  QueueEntry b3 = Entry (b);
+  q.Enqueue (a3);
+  q.SetQueueTimeout (Seconds (1));
+  q.Enqueue (b3);
+  Simulator::Schedule (Seconds (5), &AodvRqueueOrderTest::CheckTimeout, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+AodvRqueueOrderTest::CheckTimeout ()
+{
+  NS_TEST_EXPECT_MSG_EQ (q.GetSize (), 1, "unexpected number of expired packets");
+  NS_TEST_EXPECT_MSG_EQ (q.Find (Ipv4Address ("1.1.1.1")), true, "packet expired early");
+  NS_TEST_EXPECT_MSG_EQ (drops, 2, "expired packet not dropped");
+}
+
 /**
  * \ingroup aodv-test
  * \ingroup tests
@@ -641,6 +980,109 @@ struct AodvRtableTest : public TestCase
   }
 };
 
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * Routing table expiry test case: routes are invalidated, then deleted, when
+ * their lifetime passes, and refreshing a route postpones its expiry.
+ */
+struct AodvRtableExpiryTest : public TestCase
+{
+  AodvRtableExpiryTest () : TestCase ("Rtable expiry"),
+                            rtable (Seconds (1))
+  {
+  }
+  virtual void DoRun ();
+  /// Refresh route A, and update route B many times
+  void Refresh ();
+  /// Check the routes at 2.5 s, and make route C valid
+  void Check1 ();
+  /// Check the routes at 4 s
+  void Check2 ();
+  /// Check the routes at 5.5 s
+  void Check3 ();
+  /**
+   * \param dst the destination
+   * \return the flag of the route, or -1 if there is none
+   */
+  int GetFlag (Ipv4Address dst)
+  {
+    RoutingTableEntry rt;
+    return rtable.LookupRoute (dst, rt) ? rt.GetFlag () : -1;
+  }
+
+  /// Routing table
+  RoutingTable rtable;
+};
+
+void
+AodvRtableExpiryTest::DoRun ()
+{
+  Ptr<NetDevice> dev;
+  Ipv4InterfaceAddress iface;
+  RoutingTableEntry a (/*output device*/ dev, /*dst*/ Ipv4Address ("10.0.0.1"), /*validSeqNo*/ true, /*seqNo*/ 1,
+                                         /*interface*/ iface, /*hop*/ 1, /*next hop*/ Ipv4Address ("10.0.0.1"), /*second hop*/ Ipv4Address (), /*lifetime*/ Seconds (2));
+  RoutingTableEntry b (/*output device*/ dev, /*dst*/ Ipv4Address ("10.0.0.2"), /*validSeqNo*/ true, /*seqNo*/ 1,
+                                         /*interface*/ iface, /*hop*/ 2, /*next hop*/ Ipv4Address ("10.0.0.1"), /*second hop*/ Ipv4Address (), /*lifetime*/ Seconds (5));
+  RoutingTableEntry c (/*output device*/ dev, /*dst*/ Ipv4Address ("10.0.0.3"), /*validSeqNo*/ false, /*seqNo*/ 0,
+                                         /*interface*/ iface, /*hop*/ 3, /*next hop*/ Ipv4Address (), /*second hop*/ Ipv4Address (), /*lifetime*/ Seconds (1));
+  c.SetFlag (IN_SEARCH);
+  NS_TEST_EXPECT_MSG_EQ (rtable.AddRoute (a), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rtable.AddRoute (b), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (rtable.AddRoute (c), true, "trivial");
+  Simulator::Schedule (Seconds (0.5), &AodvRtableExpiryTest::Refresh, this);
+  Simulator::Schedule (Seconds (2.5), &AodvRtableExpiryTest::Check1, this);
+  Simulator::Schedule (Seconds (4), &AodvRtableExpiryTest::Check2, this);
+  Simulator::Schedule (Seconds (5.5), &AodvRtableExpiryTest::Check3, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+AodvRtableExpiryTest::Refresh ()
+{
+  RoutingTableEntry rt;
+  NS_TEST_EXPECT_MSG_EQ (rtable.LookupRoute (Ipv4Address ("10.0.0.1"), rt), true, "trivial");
+  rt.SetLifeTime (Seconds (3));
+  NS_TEST_EXPECT_MSG_EQ (rtable.Update (rt), true, "trivial");
+  // as for every forwarded packet, without changing the lifetime of B
+  NS_TEST_EXPECT_MSG_EQ (rtable.LookupRoute (Ipv4Address ("10.0.0.2"), rt), true, "trivial");
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      rtable.Update (rt);
+    }
+}
+
+void
+AodvRtableExpiryTest::Check1 ()
+{
+  NS_TEST_EXPECT_MSG_EQ (GetFlag (Ipv4Address ("10.0.0.1")), VALID, "refreshed route expired");
+  NS_TEST_EXPECT_MSG_EQ (GetFlag (Ipv4Address ("10.0.0.2")), VALID, "route expired early");
+  NS_TEST_EXPECT_MSG_EQ (GetFlag (Ipv4Address ("10.0.0.3")), IN_SEARCH, "route in search expired");
+  // a valid route whose lifetime passed is invalidated on the next lookup
+  NS_TEST_EXPECT_MSG_EQ (rtable.SetEntryState (Ipv4Address ("10.0.0.3"), VALID), true, "trivial");
+  NS_TEST_EXPECT_MSG_EQ (GetFlag (Ipv4Address ("10.0.0.3")), INVALID, "expired route still valid");
+}
+
+void
+AodvRtableExpiryTest::Check2 ()
+{
+  NS_TEST_EXPECT_MSG_EQ (GetFlag (Ipv4Address ("10.0.0.1")), INVALID, "expired route still valid");
+  NS_TEST_EXPECT_MSG_EQ (GetFlag (Ipv4Address ("10.0.0.2")), VALID, "route expired early");
+  NS_TEST_EXPECT_MSG_EQ (GetFlag (Ipv4Address ("10.0.0.3")), -1, "invalid route not deleted");
+}
+
+void
+AodvRtableExpiryTest::Check3 ()
+{
+  NS_TEST_EXPECT_MSG_EQ (GetFlag (Ipv4Address ("10.0.0.1")), -1, "invalid route not deleted");
+  NS_TEST_EXPECT_MSG_EQ (GetFlag (Ipv4Address ("10.0.0.2")), INVALID, "expired route still valid");
+  std::map<Ipv4Address, uint32_t> unreachable;
+  rtable.GetListOfDestinationWithNextHop (Ipv4Address ("10.0.0.1"), unreachable);
+  NS_TEST_EXPECT_MSG_EQ (unreachable.size (), 1, "unexpected number of routes");
+}
+
 /**
  * \ingroup aodv-test
  * \ingroup tests
@@ -653,15 +1095,22 @@ public:
   AodvTestSuite () : TestSuite ("routing-aodv", UNIT)
   {
     AddTestCase (new NeighborTest, TestCase::QUICK);
+    AddTestCase (new NeighborBatchTest, TestCase::QUICK);
     AddTestCase (new TypeHeaderTest, TestCase::QUICK);
+    AddTestCase (new WHCheckBatchHeaderTest, TestCase::QUICK);
+    AddTestCase (new WHCheckHeaderTest, TestCase::QUICK);
+    AddTestCase (new WHEndHeaderTest, TestCase::QUICK);
+    AddTestCase (new ForwardPrefixHeaderTest, TestCase::QUICK);
     AddTestCase (new RreqHeaderTest, TestCase::QUICK);
     AddTestCase (new RrepHeaderTest, TestCase::QUICK);
     AddTestCase (new RrepAckHeaderTest, TestCase::QUICK);
     AddTestCase (new RerrHeaderTest, TestCase::QUICK);
     AddTestCase (new QueueEntryTest, TestCase::QUICK);
     AddTestCase (new AodvRqueueTest, TestCase::QUICK);
+    AddTestCase (new AodvRqueueOrderTest, TestCase::QUICK);
     AddTestCase (new AodvRtableEntryTest, TestCase::QUICK);
     AddTestCase (new AodvRtableTest, TestCase::QUICK);
+    AddTestCase (new AodvRtableExpiryTest, TestCase::QUICK);
   }
 } g_aodvTestSuite; ///< the test suite
 
@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/aodv-wormhole-oracle.h"
+#include "ns3/aodv-wormhole-attack-helper.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-address-generator.h"
+
+namespace ns3 {
+namespace aodv {
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the lookups of the wormhole oracle
+ */
+class WormholeOracleTest : public TestCase
+{
+public:
+  WormholeOracleTest () : TestCase ("Wormhole oracle, lookups")
+  {
+  }
+  virtual void DoRun ();
+};
+
+void
+WormholeOracleTest::DoRun ()
+{
+  Ptr<WormholeOracle> oracle = CreateObject<WormholeOracle> ();
+  oracle->AddTunnel (Ipv4Address ("10.0.0.2"), Ipv4Address ("10.0.0.3"));
+  oracle->AddTunnel (Ipv4Address ("10.0.0.5"), Ipv4Address ("10.0.0.6"));
+  oracle->AddAlias (Ipv4Address ("10.1.2.1"), Ipv4Address ("10.0.0.2"));
+
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetNTunnels (), 2, "Tunnels");
+  NS_TEST_EXPECT_MSG_EQ (oracle->IsWormholeLink (Ipv4Address ("10.0.0.3"), Ipv4Address ("10.0.0.2")), true,
+                         "Tunnel");
+  NS_TEST_EXPECT_MSG_EQ (oracle->IsWormholeLink (Ipv4Address ("10.0.0.2"), Ipv4Address ("10.0.0.3")), true,
+                         "Tunnel, other direction");
+  NS_TEST_EXPECT_MSG_EQ (oracle->IsWormholeLink (Ipv4Address ("10.0.0.3"), Ipv4Address ("10.0.0.5")), false,
+                         "Ends of two tunnels");
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetPrimaryAddress (Ipv4Address ("10.1.2.1")), Ipv4Address ("10.0.0.2"),
+                         "Tunnel interface");
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetPrimaryAddress (Ipv4Address ("10.0.0.4")), Ipv4Address ("10.0.0.4"),
+                         "Other address");
+
+  oracle->Clear ();
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetNTunnels (), 0, "Cleared");
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetPrimaryAddress (Ipv4Address ("10.1.2.1")), Ipv4Address ("10.1.2.1"),
+                         "Cleared alias");
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Unit test for the placement of the tunnels by WormholeAttackHelper
+ */
+class WormholeAttackHelperTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param linkType the link type of the tunnels
+   */
+  WormholeAttackHelperTest (WormholeAttackHelper::LinkType linkType)
+    : TestCase (linkType == WormholeAttackHelper::POINT_TO_POINT ? "Wormhole attack helper, point to point"
+                                                                 : "Wormhole attack helper, out of band"),
+      m_linkType (linkType)
+  {
+  }
+  virtual void DoRun ();
+
+private:
+  WormholeAttackHelper::LinkType m_linkType; ///< link type of the tunnels
+};
+
+void
+WormholeAttackHelperTest::DoRun ()
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install (nodes);
+
+  Ptr<WormholeAttackHelper> wormhole = CreateObject<WormholeAttackHelper> ();
+  wormhole->SetAttribute ("Tunnels", UintegerValue (2));
+  wormhole->SetAttribute ("LinkType", EnumValue (m_linkType));
+  NodeContainer endpoints;
+  endpoints.Add (nodes.Get (1));
+  endpoints.Add (nodes.Get (2));
+  endpoints.Add (nodes.Get (3));
+  endpoints.Add (nodes.Get (4));
+  NetDeviceContainer tunnels = wormhole->Install (endpoints);
+  NS_TEST_ASSERT_MSG_EQ (tunnels.GetN (), 4, "Two devices per tunnel");
+  NS_TEST_EXPECT_MSG_EQ (wormhole->GetNTunnels (), 2, "Tunnels");
+  NS_TEST_EXPECT_MSG_EQ (tunnels.Get (0)->GetChannel (), tunnels.Get (1)->GetChannel (), "First tunnel");
+  NS_TEST_EXPECT_MSG_NE (tunnels.Get (1)->GetChannel (), tunnels.Get (2)->GetChannel (), "Separate tunnels");
+  if (m_linkType == WormholeAttackHelper::POINT_TO_POINT)
+    {
+      NS_TEST_EXPECT_MSG_NE (DynamicCast<PointToPointNetDevice> (tunnels.Get (0)), 0, "Point to point device");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_NE (DynamicCast<SimpleNetDevice> (tunnels.Get (0)), 0, "Out of band device");
+    }
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  address.Assign (devices);
+  Ipv4InterfaceContainer ifaces = wormhole->AssignAddresses ();
+  NS_TEST_ASSERT_MSG_EQ (ifaces.GetN (), 4, "Two interfaces per tunnel");
+  NS_TEST_EXPECT_MSG_EQ (ifaces.GetAddress (0), Ipv4Address ("10.1.2.1"), "First tunnel network");
+  NS_TEST_EXPECT_MSG_EQ (ifaces.GetAddress (3), Ipv4Address ("10.1.3.2"), "Second tunnel network");
+
+  Ptr<WormholeOracle> oracle = wormhole->GetOracle ();
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetNTunnels (), 2, "Registered tunnels");
+  NS_TEST_EXPECT_MSG_EQ (oracle->IsWormholeLink (Ipv4Address ("10.0.0.3"), Ipv4Address ("10.0.0.2")), true,
+                         "Nodes 1 and 2");
+  NS_TEST_EXPECT_MSG_EQ (oracle->IsWormholeLink (Ipv4Address ("10.0.0.2"), Ipv4Address ("10.0.0.3")), true,
+                         "Nodes 2 and 1");
+  NS_TEST_EXPECT_MSG_EQ (oracle->IsWormholeLink (Ipv4Address ("10.0.0.4"), Ipv4Address ("10.0.0.5")), true,
+                         "Nodes 3 and 4");
+  NS_TEST_EXPECT_MSG_EQ (oracle->IsWormholeLink (Ipv4Address ("10.0.0.5"), Ipv4Address ("10.0.0.4")), true,
+                         "Nodes 4 and 3");
+  NS_TEST_EXPECT_MSG_EQ (oracle->IsWormholeLink (Ipv4Address ("10.1.2.2"), Ipv4Address ("10.1.2.1")), false,
+                         "Tunnel interfaces are not node addresses");
+  NS_TEST_EXPECT_MSG_EQ (oracle->IsWormholeLink (Ipv4Address ("10.0.0.3"), Ipv4Address ("10.0.0.4")), false,
+                         "Nodes 2 and 3");
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetPrimaryAddress (Ipv4Address ("10.1.2.1")), Ipv4Address ("10.0.0.2"),
+                         "Tunnel interface of node 1");
+  NS_TEST_EXPECT_MSG_EQ (oracle->GetPrimaryAddress (Ipv4Address ("10.1.3.2")), Ipv4Address ("10.0.0.5"),
+                         "Tunnel interface of node 4");
+
+  NS_TEST_EXPECT_MSG_EQ (wormhole->AssignAddresses ().GetN (), 0, "Addresses assigned once");
+
+  Simulator::Destroy ();
+  Ipv4AddressGenerator::Reset ();
+}
+
+/**
+ * \ingroup aodv-test
+ * \ingroup tests
+ *
+ * \brief Wormhole attack test suite
+ */
+class WormholeAttackTestSuite : public TestSuite
+{
+public:
+  WormholeAttackTestSuite () : TestSuite ("aodv-wormhole-attack", UNIT)
+  {
+    AddTestCase (new WormholeOracleTest, TestCase::QUICK);
+    AddTestCase (new WormholeAttackHelperTest (WormholeAttackHelper::POINT_TO_POINT), TestCase::QUICK);
+    AddTestCase (new WormholeAttackHelperTest (WormholeAttackHelper::OUT_OF_BAND), TestCase::QUICK);
+  }
+} g_wormholeAttackTestSuite; ///< the test suite
+
+}  // namespace aodv
+}  // namespace ns3
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sys/time.h>
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/command-line.h"
+#include "ns3/make-event.h"
+#include "ns3/event-impl.h"
+
+/**
+ * \file
+ * \ingroup core-examples
+ * \ingroup events
+ * Benchmark of the event pool of EventImpl.
+ *
+ * Runs the same schedule/invoke workload twice: with the events of
+ * MakeEvent, allocated from the pool, and with an event class that
+ * overrides the pool with the global operator new and delete, as all
+ * events were allocated before the pool.  A third workload schedules
+ * and cancels events, which are recycled when the simulator drops them.
+ *
+ *     ./waf --run "bench-event-pool --events=10000000 --population=10000"
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** \returns The wall clock time, in seconds. */
+double
+Now (void)
+{
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+class Bench;
+
+/** An event allocated with the global operator new, as before the pool. */
+class UnpooledEvent : public EventImpl
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] bench The benchmark to notify.
+   */
+  UnpooledEvent (Bench *bench)
+    : m_bench (bench)
+  {
+  }
+  /**
+   * Allocate with the global operator new.
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void * operator new (std::size_t size)
+  {
+    return ::operator new (size);
+  }
+  /**
+   * Free with the global operator delete.
+   * \param [in] p The memory of the event.
+   */
+  static void operator delete (void *p)
+  {
+    ::operator delete (p);
+  }
+
+private:
+  virtual void Notify (void);
+  Bench *m_bench;  /**< The benchmark to notify. */
+};
+
+/** Keeps a population of pending events until a total is reached. */
+class Bench
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] total The number of events to invoke.
+   * \param [in] population The number of pending events.
+   * \param [in] pooled Whether the events come from MakeEvent.
+   */
+  Bench (uint64_t total, uint32_t population, bool pooled)
+    : m_total (total),
+      m_population (population),
+      m_pooled (pooled),
+      m_scheduled (0),
+      m_seed (1)
+  {
+  }
+  /** \returns The number of events per second of the run. */
+  double Run (void)
+  {
+    double start = Now ();
+    for (uint32_t i = 0; i < m_population; ++i)
+      {
+        ScheduleNext ();
+      }
+    Simulator::Run ();
+    double elapsed = Now () - start;
+    Simulator::Destroy ();
+    return m_scheduled / elapsed;
+  }
+  /** Invoked by each event, schedules the next one. */
+  void Cb (void)
+  {
+    if (m_scheduled < m_total)
+      {
+        ScheduleNext ();
+      }
+  }
+
+private:
+  /** Schedule an event at a pseudo-random delay below 1 us. */
+  void ScheduleNext (void)
+  {
+    m_seed = m_seed * 1103515245 + 12345;
+    Time delay = NanoSeconds ((m_seed >> 16) % 1000);
+    EventImpl *event = m_pooled ? MakeEvent (&Bench::Cb, this) : new UnpooledEvent (this);
+    Simulator::ScheduleWithContext (0, delay, event);
+    m_scheduled++;
+  }
+
+  uint64_t m_total;       /**< The number of events to invoke. */
+  uint32_t m_population;  /**< The number of pending events. */
+  bool m_pooled;          /**< Whether the events come from MakeEvent. */
+  uint64_t m_scheduled;   /**< The number of events scheduled. */
+  uint32_t m_seed;        /**< State of the delay generator. */
+};
+
+void
+UnpooledEvent::Notify (void)
+{
+  m_bench->Cb ();
+}
+
+/** Does nothing, the target of the canceled events. */
+void
+Nothing (void)
+{
+}
+
+/**
+ * Schedule and cancel events, the simulator drops them when it reaches
+ * their time.
+ * \param [in] total The number of events.
+ * \returns The number of events per second.
+ */
+double
+RunCancel (uint64_t total)
+{
+  double start = Now ();
+  for (uint64_t i = 0; i < total; ++i)
+    {
+      EventId id = Simulator::Schedule (NanoSeconds (i % 1000), &Nothing);
+      Simulator::Cancel (id);
+      if (i % 1000 == 999)
+        {
+          Simulator::Run ();
+        }
+    }
+  Simulator::Run ();
+  double elapsed = Now () - start;
+  Simulator::Destroy ();
+  return total / elapsed;
+}
+
+}  // unnamed namespace
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t events = 10000000;
+  uint32_t population = 10000;
+
+  CommandLine cmd;
+  cmd.AddValue ("events", "Number of events to invoke", events);
+  cmd.AddValue ("population", "Number of pending events", population);
+  cmd.Parse (argc, argv);
+
+  double unpooled = Bench (events, population, false).Run ();
+  double pooled = Bench (events, population, true).Run ();
+  double canceled = RunCancel (events);
+
+  std::cout << std::fixed << std::setprecision (3)
+            << "schedule/invoke, global new:  " << unpooled / 1e6 << " Mevents/s" << std::endl
+            << "schedule/invoke, event pool:  " << pooled / 1e6 << " Mevents/s ("
+            << std::setprecision (2) << pooled / unpooled << "x)" << std::endl
+            << std::setprecision (3)
+            << "schedule/cancel, event pool:  " << canceled / 1e6 << " Mevents/s" << std::endl;
+  return 0;
+}
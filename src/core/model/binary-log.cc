@@ -0,0 +1,488 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-log.h"
+#include "log.h"
+#include "simulator.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::BinaryLog implementation.
+ */
+
+namespace ns3 {
+
+namespace {
+
+/** The 8 bytes at the start of a dump. */
+const char MAGIC[8] = { 'N', 'S', '3', 'B', 'L', 'O', 'G', '1' };
+
+/** The ring buffer of one thread. */
+struct Ring
+{
+  std::vector<BinaryLogRecord> records;  //!< The records, a power of 2
+  uint64_t written;                      //!< Number of records ever written
+};
+
+/** The description of a call site. */
+struct SiteInfo
+{
+  std::string component;  //!< LogComponent name
+  std::string function;   //!< Function name
+  std::string format;     //!< Message
+  std::string file;       //!< Source file
+  int32_t line;           //!< Source line
+};
+
+/** The state shared by all the threads. */
+struct Registry
+{
+  std::mutex mutex;                                         //!< Guards the other fields
+  std::map<std::string, std::atomic<bool> *> components;    //!< Enabled flag per component
+  bool all;                                                 //!< Whether new components are enabled
+  std::vector<SiteInfo> sites;                              //!< The call sites
+  std::vector<Ring *> rings;                                //!< The rings of all the threads
+  uint32_t ringSize;                                        //!< Capacity of the new rings
+};
+
+/**
+ * \returns the registry, created on first use with the components of the
+ * NS_BINLOG environment variable enabled and never destroyed, so that
+ * events recorded during the static destruction stay valid
+ */
+Registry &
+GetRegistry (void)
+{
+  static Registry *registry = 0;
+  static std::once_flag once;
+  std::call_once (once, [] ()
+  {
+    registry = new Registry ();
+    registry->all = false;
+    registry->ringSize = 1 << 16;
+    const char *env = std::getenv ("NS_BINLOG");
+    std::string components = env == 0 ? "" : env;
+    std::string::size_type start = 0;
+    while (start < components.size ())
+      {
+        std::string::size_type end = components.find (':', start);
+        if (end == std::string::npos)
+          {
+            end = components.size ();
+          }
+        std::string name = components.substr (start, end - start);
+        if (name == "*")
+          {
+            registry->all = true;
+          }
+        else if (!name.empty ())
+          {
+            registry->components[name] = new std::atomic<bool> (true);
+          }
+        start = end + 1;
+      }
+  });
+  return *registry;
+}
+
+/** The ring of this thread, created by its first record. */
+thread_local Ring *t_ring = 0;
+
+/**
+ * Set the enabled flag of one or all components.
+ *
+ * \param [in] component The component name, or "*".
+ * \param [in] enabled The flag.
+ */
+void
+SetEnabled (const std::string &component, bool enabled)
+{
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  if (component == "*")
+    {
+      registry.all = enabled;
+      for (std::map<std::string, std::atomic<bool> *>::iterator i = registry.components.begin ();
+           i != registry.components.end (); ++i)
+        {
+          i->second->store (enabled);
+        }
+      return;
+    }
+  std::map<std::string, std::atomic<bool> *>::iterator i = registry.components.find (component);
+  if (i == registry.components.end ())
+    {
+      registry.components[component] = new std::atomic<bool> (enabled);
+    }
+  else
+    {
+      i->second->store (enabled);
+    }
+}
+
+/**
+ * Write a string with its length.
+ *
+ * \param [in] out The output.
+ * \param [in] s The string.
+ */
+void
+WriteString (std::ostream &out, const std::string &s)
+{
+  uint32_t size = s.size ();
+  out.write (reinterpret_cast<const char *> (&size), sizeof (size));
+  out.write (s.data (), size);
+}
+
+/**
+ * Read a string written by WriteString.
+ *
+ * \param [in] in The input.
+ * \param [out] s The string.
+ * \returns \c false on a read error
+ */
+bool
+ReadString (std::istream &in, std::string &s)
+{
+  uint32_t size = 0;
+  if (!in.read (reinterpret_cast<char *> (&size), sizeof (size)) || size > (1 << 20))
+    {
+      return false;
+    }
+  s.resize (size);
+  return size == 0 || static_cast<bool> (in.read (&s[0], size));
+}
+
+/**
+ * Read a value in host byte order.
+ *
+ * \param [in] in The input.
+ * \param [out] value The value.
+ * \returns \c false on a read error
+ */
+template <typename T>
+bool
+ReadValue (std::istream &in, T &value)
+{
+  return static_cast<bool> (in.read (reinterpret_cast<char *> (&value), sizeof (value)));
+}
+
+/**
+ * Print a time in seconds, like the NS_LOG time prefix.
+ *
+ * \param [in] out The output.
+ * \param [in] steps The time, in time steps.
+ * \param [in] stepsPerSecond The time resolution.
+ */
+void
+PrintTime (std::ostream &out, int64_t steps, int64_t stepsPerSecond)
+{
+  std::ios_base::fmtflags flags = out.flags ();
+  std::streamsize precision = out.precision ();
+  out << "+" << std::fixed << std::setprecision (9)
+      << static_cast<double> (steps) / static_cast<double> (stepsPerSecond) << "s";
+  out.flags (flags);
+  out.precision (precision);
+}
+
+/**
+ * Print an argument according to its type.
+ *
+ * \param [in] out The output.
+ * \param [in] type The type code.
+ * \param [in] value The value.
+ * \param [in] stepsPerSecond The time resolution.
+ */
+void
+PrintArg (std::ostream &out, uint8_t type, uint64_t value, int64_t stepsPerSecond)
+{
+  switch (type)
+    {
+    case BinaryLogArg::INT:
+      out << static_cast<int64_t> (value);
+      break;
+    case BinaryLogArg::UINT:
+      out << value;
+      break;
+    case BinaryLogArg::DOUBLE:
+      {
+        double d;
+        std::memcpy (&d, &value, sizeof (d));
+        out << d;
+      }
+      break;
+    case BinaryLogArg::BOOL:
+      out << (value != 0 ? "true" : "false");
+      break;
+    case BinaryLogArg::POINTER:
+      out << "0x" << std::hex << value << std::dec;
+      break;
+    case BinaryLogArg::TIME:
+      PrintTime (out, static_cast<int64_t> (value), stepsPerSecond);
+      break;
+    case BinaryLogArg::IPV4:
+      out << ((value >> 24) & 0xff) << "." << ((value >> 16) & 0xff) << "."
+          << ((value >> 8) & 0xff) << "." << (value & 0xff);
+      break;
+    default:
+      out << "?";
+      break;
+    }
+}
+
+} // unnamed namespace
+
+BinaryLog::Site::Site (const std::string &component, const char *function, const char *format,
+                       const char *file, int line)
+{
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  std::map<std::string, std::atomic<bool> *>::iterator i = registry.components.find (component);
+  if (i == registry.components.end ())
+    {
+      i = registry.components.insert (std::make_pair (component, new std::atomic<bool> (registry.all))).first;
+    }
+  m_enabled = i->second;
+  m_id = registry.sites.size ();
+  SiteInfo info = { component, function, format, file, line };
+  registry.sites.push_back (info);
+}
+
+void
+BinaryLog::Enable (const std::string &component)
+{
+  SetEnabled (component, true);
+}
+
+void
+BinaryLog::Disable (const std::string &component)
+{
+  SetEnabled (component, false);
+}
+
+void
+BinaryLog::SetRingSize (uint32_t records)
+{
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  uint32_t size = 1;
+  while (size < records && size < (1U << 31))
+    {
+      size <<= 1;
+    }
+  registry.ringSize = size;
+}
+
+BinaryLogRecord &
+BinaryLog::Next (uint32_t site)
+{
+  Ring *ring = t_ring;
+  if (ring == 0)
+    {
+      Registry &registry = GetRegistry ();
+      std::lock_guard<std::mutex> lock (registry.mutex);
+      ring = new Ring ();
+      ring->records.resize (registry.ringSize);
+      ring->written = 0;
+      registry.rings.push_back (ring);
+      t_ring = ring;
+    }
+  BinaryLogRecord &record = ring->records[ring->written & (ring->records.size () - 1)];
+  ring->written++;
+  // as for the NS_LOG prefixes, the simulator must not be created by a log
+  if (LogGetNodePrinter () != 0)
+    {
+      record.time = Simulator::Now ().GetTimeStep ();
+      record.context = Simulator::GetContext ();
+    }
+  else
+    {
+      record.time = 0;
+      record.context = Simulator::NO_CONTEXT;
+    }
+  record.site = site;
+  return record;
+}
+
+uint64_t
+BinaryLog::GetCount (void)
+{
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  uint64_t count = 0;
+  for (std::vector<Ring *>::const_iterator i = registry.rings.begin (); i != registry.rings.end (); ++i)
+    {
+      count += std::min<uint64_t> ((*i)->written, (*i)->records.size ());
+    }
+  return count;
+}
+
+void
+BinaryLog::Clear (void)
+{
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  for (std::vector<Ring *>::const_iterator i = registry.rings.begin (); i != registry.rings.end (); ++i)
+    {
+      (*i)->written = 0;
+    }
+}
+
+bool
+BinaryLog::Dump (const std::string &filename)
+{
+  Registry &registry = GetRegistry ();
+  std::lock_guard<std::mutex> lock (registry.mutex);
+  std::ofstream out (filename.c_str (), std::ios::binary);
+  if (!out.is_open ())
+    {
+      return false;
+    }
+  out.write (MAGIC, sizeof (MAGIC));
+  uint32_t recordSize = sizeof (BinaryLogRecord);
+  out.write (reinterpret_cast<const char *> (&recordSize), sizeof (recordSize));
+  int64_t stepsPerSecond = Seconds (1).GetTimeStep ();
+  out.write (reinterpret_cast<const char *> (&stepsPerSecond), sizeof (stepsPerSecond));
+  uint32_t nSites = registry.sites.size ();
+  out.write (reinterpret_cast<const char *> (&nSites), sizeof (nSites));
+  for (std::vector<SiteInfo>::const_iterator i = registry.sites.begin (); i != registry.sites.end (); ++i)
+    {
+      WriteString (out, i->component);
+      WriteString (out, i->function);
+      WriteString (out, i->format);
+      WriteString (out, i->file);
+      out.write (reinterpret_cast<const char *> (&i->line), sizeof (i->line));
+    }
+  uint32_t nRings = registry.rings.size ();
+  out.write (reinterpret_cast<const char *> (&nRings), sizeof (nRings));
+  for (std::vector<Ring *>::const_iterator i = registry.rings.begin (); i != registry.rings.end (); ++i)
+    {
+      const Ring &ring = **i;
+      uint64_t size = ring.records.size ();
+      uint64_t count = std::min (ring.written, size);
+      uint64_t dropped = ring.written - count;
+      out.write (reinterpret_cast<const char *> (&dropped), sizeof (dropped));
+      out.write (reinterpret_cast<const char *> (&count), sizeof (count));
+      // oldest first: the end of the ring, then its start
+      uint64_t first = ring.written % size;
+      if (dropped > 0)
+        {
+          out.write (reinterpret_cast<const char *> (&ring.records[first]), (size - first) * recordSize);
+        }
+      out.write (reinterpret_cast<const char *> (&ring.records[0]), (dropped > 0 ? first : count) * recordSize);
+    }
+  return static_cast<bool> (out);
+}
+
+bool
+BinaryLog::Decode (std::istream &in, std::ostream &out)
+{
+  char magic[sizeof (MAGIC)];
+  uint32_t recordSize = 0;
+  int64_t stepsPerSecond = 0;
+  uint32_t nSites = 0;
+  if (!in.read (magic, sizeof (magic)) || std::memcmp (magic, MAGIC, sizeof (MAGIC)) != 0
+      || !ReadValue (in, recordSize) || recordSize != sizeof (BinaryLogRecord)
+      || !ReadValue (in, stepsPerSecond) || stepsPerSecond <= 0
+      || !ReadValue (in, nSites))
+    {
+      return false;
+    }
+  std::vector<SiteInfo> sites (nSites);
+  for (uint32_t i = 0; i < nSites; i++)
+    {
+      if (!ReadString (in, sites[i].component) || !ReadString (in, sites[i].function)
+          || !ReadString (in, sites[i].format) || !ReadString (in, sites[i].file)
+          || !ReadValue (in, sites[i].line))
+        {
+          return false;
+        }
+    }
+  uint32_t nRings = 0;
+  if (!ReadValue (in, nRings))
+    {
+      return false;
+    }
+  std::vector<BinaryLogRecord> records;
+  for (uint32_t i = 0; i < nRings; i++)
+    {
+      uint64_t dropped = 0;
+      uint64_t count = 0;
+      if (!ReadValue (in, dropped) || !ReadValue (in, count))
+        {
+          return false;
+        }
+      if (dropped > 0)
+        {
+          out << "# thread " << i << ": " << dropped << " oldest records overwritten" << std::endl;
+        }
+      std::size_t first = records.size ();
+      records.resize (first + count);
+      if (count > 0 && !in.read (reinterpret_cast<char *> (&records[first]), count * recordSize))
+        {
+          return false;
+        }
+    }
+  // the threads of the multithreaded simulator run apart, merge them
+  std::stable_sort (records.begin (), records.end (),
+                    [] (const BinaryLogRecord &a, const BinaryLogRecord &b)
+  {
+    return a.time < b.time;
+  });
+  for (std::vector<BinaryLogRecord>::const_iterator r = records.begin (); r != records.end (); ++r)
+    {
+      if (r->site >= sites.size () || r->nArgs > BinaryLogRecord::MAX_ARGS)
+        {
+          return false;
+        }
+      const SiteInfo &site = sites[r->site];
+      PrintTime (out, r->time, stepsPerSecond);
+      if (r->context == Simulator::NO_CONTEXT)
+        {
+          out << " -1 ";
+        }
+      else
+        {
+          out << " " << r->context << " ";
+        }
+      out << site.component << ":" << site.function << ": ";
+      std::string::size_type start = 0;
+      for (uint32_t i = 0; i < r->nArgs; i++)
+        {
+          std::string::size_type placeholder = site.format.find ("{}", start);
+          if (placeholder == std::string::npos)
+            {
+              break;
+            }
+          out << site.format.substr (start, placeholder - start);
+          PrintArg (out, r->types[i], r->args[i], stepsPerSecond);
+          start = placeholder + 2;
+        }
+      out << site.format.substr (start) << std::endl;
+    }
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,330 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_BINARY_LOG_H
+#define NS3_BINARY_LOG_H
+
+#include "nstime.h"
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+/**
+ * \file
+ * \ingroup logging
+ * Binary event logging into per thread ring buffers.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup logging
+ * One argument of a binary log record: a type code and 8 bytes of value.
+ */
+struct BinaryLogArg
+{
+  /** The type codes, which select the formatting at decoding time. */
+  enum Type
+  {
+    NONE = 0,    //!< No argument
+    INT = 1,     //!< Signed integer
+    UINT = 2,    //!< Unsigned integer
+    DOUBLE = 3,  //!< Floating point number, the bits of a double
+    BOOL = 4,    //!< Boolean
+    POINTER = 5, //!< Address, printed in hexadecimal
+    TIME = 6,    //!< Time, in time steps
+    IPV4 = 7     //!< IPv4 address, host byte order
+  };
+  uint8_t type;   //!< The type code
+  uint64_t value; //!< The value
+};
+
+/**
+ * \ingroup logging
+ * One record of a binary log ring: 64 bytes, written in host byte order.
+ */
+struct BinaryLogRecord
+{
+  /** The maximum number of arguments of a record. */
+  static const uint32_t MAX_ARGS = 5;
+
+  int64_t time;              //!< Simulation time, in time steps
+  uint32_t context;          //!< Simulation context, usually the node id
+  uint32_t site;             //!< Index of the call site
+  uint8_t types[MAX_ARGS];   //!< Type code of each argument
+  uint8_t nArgs;             //!< Number of arguments
+  uint8_t padding[2];        //!< Unused
+  uint64_t args[MAX_ARGS];   //!< The arguments
+};
+
+/**
+ * \ingroup logging
+ * \brief Structured logging into per thread binary ring buffers.
+ *
+ * NS_BINLOG records an event: the simulation time and context, the call
+ * site and up to five numeric arguments, in a 64 byte record.  The text is
+ * only formatted when the log is decoded after the run, so that recording
+ * an event costs a few stores, in optimized builds as well, and recording
+ * for a disabled component costs a load and a branch.
+ *
+ * Each thread writes to its own ring buffer of RingSize records, without
+ * any lock; when the ring is full the oldest records are overwritten.  The
+ * rings outlive their threads, so that the records of the workers of the
+ * multithreaded simulator can be dumped after the run.
+ *
+ * The logging is enabled per LogComponent name, with Enable or the
+ * NS_BINLOG environment variable, a list of component names separated by
+ * colons ("*" for all).  Dump writes the call sites and the rings to a
+ * file, which Decode, or the decode-binary-log program, turns into one
+ * line of text per event, in time order:
+ *
+ * \code
+ *   +1.000000000s 3 AodvRoutingProtocol:RecvRequest: RREQ 1 from 10.0.0.2, hops 3
+ * \endcode
+ *
+ * Enable, Dump and Clear must not run concurrently with the recording
+ * threads, i.e. they must be called before or after Simulator::Run.
+ */
+class BinaryLog
+{
+public:
+  /** A call site of NS_BINLOG, registered on its first execution. */
+  class Site
+  {
+public:
+    /**
+     * Register a call site.
+     *
+     * \param [in] component The LogComponent name.
+     * \param [in] function The function name.
+     * \param [in] format The message, with a "{}" for each argument.
+     * \param [in] file The source file.
+     * \param [in] line The source line.
+     */
+    Site (const std::string &component, const char *function, const char *format,
+          const char *file, int line);
+    /** \returns \c true if the component of this site is enabled */
+    bool IsEnabled (void) const
+    {
+      return m_enabled->load (std::memory_order_relaxed);
+    }
+    /** \returns the index of this site */
+    uint32_t GetId (void) const
+    {
+      return m_id;
+    }
+
+private:
+    const std::atomic<bool> *m_enabled;  //!< Whether the component is enabled
+    uint32_t m_id;                       //!< Index of this site
+  };
+
+  /**
+   * Enable the recording of a component.
+   *
+   * \param [in] component The LogComponent name, or "*" for all.
+   */
+  static void Enable (const std::string &component);
+  /**
+   * Disable the recording of a component.
+   *
+   * \param [in] component The LogComponent name, or "*" for all.
+   */
+  static void Disable (const std::string &component);
+  /**
+   * Set the capacity of the rings created afterwards.
+   *
+   * \param [in] records The number of records, rounded up to a power of 2.
+   */
+  static void SetRingSize (uint32_t records);
+  /**
+   * Write the call sites and the records of all the threads.
+   *
+   * \param [in] filename The output file.
+   * \returns \c false if the file could not be written
+   */
+  static bool Dump (const std::string &filename);
+  /** Forget the records of all the threads. */
+  static void Clear (void);
+  /** \returns the number of records held by all the rings */
+  static uint64_t GetCount (void);
+  /**
+   * Decode a file written by Dump into text, one line per record, in
+   * time order.
+   *
+   * \param [in] in The dump.
+   * \param [in] out The text output.
+   * \returns \c false if \p in is not a valid dump
+   */
+  static bool Decode (std::istream &in, std::ostream &out);
+
+  /**
+   * Record an event.  Use NS_BINLOG instead.
+   *
+   * \param [in] site The index of the call site.
+   * \param [in] args The arguments.
+   */
+  template <typename... Args>
+  static void Record (uint32_t site, const Args &... args);
+
+private:
+  /**
+   * \param [in] site The index of the call site.
+   * \returns the next record of the ring of this thread, with the time,
+   * context and site filled in
+   */
+  static BinaryLogRecord &Next (uint32_t site);
+  /**
+   * Store the arguments from the \p i th one.
+   *
+   * \param [in] record The record.
+   * \param [in] i The index of the first argument.
+   * \param [in] arg The first argument.
+   * \param [in] args The other arguments.
+   */
+  template <typename T, typename... Args>
+  static void Store (BinaryLogRecord &record, uint32_t i, const T &arg, const Args &... args);
+  /** End of the arguments. */
+  static void Store (BinaryLogRecord &, uint32_t)
+  {
+  }
+};
+
+/**
+ * \ingroup logging
+ * \param [in] value A signed integer or enum.
+ * \returns the encoded value
+ */
+template <typename T>
+typename std::enable_if<std::is_enum<T>::value || (std::is_integral<T>::value && std::is_signed<T>::value),
+                        BinaryLogArg>::type
+BinaryLogEncode (T value)
+{
+  BinaryLogArg arg = { BinaryLogArg::INT, static_cast<uint64_t> (static_cast<int64_t> (value)) };
+  return arg;
+}
+/**
+ * \ingroup logging
+ * \param [in] value An unsigned integer.
+ * \returns the encoded value
+ */
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value
+                        && !std::is_same<T, bool>::value, BinaryLogArg>::type
+BinaryLogEncode (T value)
+{
+  BinaryLogArg arg = { BinaryLogArg::UINT, static_cast<uint64_t> (value) };
+  return arg;
+}
+/**
+ * \ingroup logging
+ * \param [in] value A floating point number.
+ * \returns the encoded value
+ */
+inline BinaryLogArg
+BinaryLogEncode (double value)
+{
+  BinaryLogArg arg = { BinaryLogArg::DOUBLE, 0 };
+  std::memcpy (&arg.value, &value, sizeof (value));
+  return arg;
+}
+/**
+ * \ingroup logging
+ * \param [in] value A boolean.
+ * \returns the encoded value
+ */
+inline BinaryLogArg
+BinaryLogEncode (bool value)
+{
+  BinaryLogArg arg = { BinaryLogArg::BOOL, value ? 1U : 0U };
+  return arg;
+}
+/**
+ * \ingroup logging
+ * \param [in] value A pointer, only its address is recorded.
+ * \returns the encoded value
+ */
+inline BinaryLogArg
+BinaryLogEncode (const void *value)
+{
+  BinaryLogArg arg = { BinaryLogArg::POINTER, reinterpret_cast<uintptr_t> (value) };
+  return arg;
+}
+/**
+ * \ingroup logging
+ * \param [in] value A time.
+ * \returns the encoded value
+ */
+inline BinaryLogArg
+BinaryLogEncode (const Time &value)
+{
+  BinaryLogArg arg = { BinaryLogArg::TIME, static_cast<uint64_t> (value.GetTimeStep ()) };
+  return arg;
+}
+
+template <typename T, typename... Args>
+void
+BinaryLog::Store (BinaryLogRecord &record, uint32_t i, const T &arg, const Args &... args)
+{
+  BinaryLogArg encoded = BinaryLogEncode (arg);
+  record.types[i] = encoded.type;
+  record.args[i] = encoded.value;
+  Store (record, i + 1, args...);
+}
+
+template <typename... Args>
+void
+BinaryLog::Record (uint32_t site, const Args &... args)
+{
+  static_assert (sizeof... (Args) <= BinaryLogRecord::MAX_ARGS, "too many arguments for a binary log record");
+  BinaryLogRecord &record = Next (site);
+  record.nArgs = sizeof... (Args);
+  Store (record, 0, args...);
+}
+
+} // namespace ns3
+
+/**
+ * \ingroup logging
+ *
+ * Record an event in the binary log, if the component of the file, as
+ * defined by NS_LOG_COMPONENT_DEFINE, is enabled with BinaryLog::Enable.
+ * Unlike NS_LOG, this macro is kept in optimized builds.
+ *
+ * \param [in] format The message, a string literal with a "{}" for each argument.
+ * \param [in] ... Up to five numbers, booleans, pointers, times or addresses.
+ *
+ * Typical usage looks like:
+ * \code
+ *   NS_BINLOG ("RREQ {} from {}, hops {}", id, origin, hopCount);
+ * \endcode
+ */
+#define NS_BINLOG(format, ...)                                          \
+  do                                                                    \
+    {                                                                   \
+      static const ns3::BinaryLog::Site ns3BinaryLogSite                \
+        (g_log.Name (), __FUNCTION__, format, __FILE__, __LINE__);      \
+      if (ns3BinaryLogSite.IsEnabled ())                                \
+        {                                                               \
+          ns3::BinaryLog::Record (ns3BinaryLogSite.GetId (), ## __VA_ARGS__); \
+        }                                                               \
+    }                                                                   \
+  while (false)
+
+#endif /* NS3_BINARY_LOG_H */
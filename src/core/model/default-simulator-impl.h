@@ -25,11 +25,11 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "system-mutex.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <atomic>
 
 /**
  * \file
@@ -95,18 +95,19 @@ private:
     uint64_t timestamp;
     /** The event implementation. */
     EventImpl *event;
+    /** The previously scheduled event with context. */
+    EventWithContext *next;
   };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * The events scheduled from a different thread, latest first.
+   *
+   * This is a lock-free multi-producer single-consumer stack: the other
+   * threads push with a compare and swap, the main thread takes the
+   * whole stack with an exchange, so neither ever blocks and there is no
+   * ABA problem.  The main thread only checks for a null head between
+   * two events.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  std::atomic<EventWithContext *> m_eventsWithContext;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -20,6 +20,9 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include <mutex>
+#include <new>
+#include <vector>
 
 /**
  * \file
@@ -31,6 +34,167 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Distance between two size classes of the event pool. */
+const std::size_t EVENT_POOL_GRANULARITY = 16;
+/** Number of size classes, larger events use the global operator new. */
+const std::size_t EVENT_POOL_CLASSES = 16;
+/** Size of the chunks the free lists are filled from. */
+const std::size_t EVENT_POOL_CHUNK = 4096;
+
+/** A free event, linked in the free list of its size class. */
+struct EventPoolBlock
+{
+  EventPoolBlock *next;  /**< Next free event of the size class. */
+};
+
+/** The free lists of one thread. */
+struct EventPoolCache
+{
+  EventPoolBlock *free[EVENT_POOL_CLASSES];  /**< Free list per size class. */
+  std::vector<void *> chunks;                /**< Chunks allocated for this cache. */
+  bool inUse;                                /**< Used by a running thread. */
+};
+
+/** Protects g_eventPoolCaches. */
+std::mutex g_eventPoolMutex;
+/**
+ * All the caches ever created.  Never deleted: events are freed as
+ * long as the process runs, possibly by another thread than the one
+ * that allocated them.
+ */
+std::vector<EventPoolCache *> *g_eventPoolCaches = 0;
+/** The cache of the current thread, null until its first event. */
+thread_local EventPoolCache *t_eventPoolCache = 0;
+
+/** Hands the cache of an exiting thread over to the next thread. */
+struct EventPoolReleaser
+{
+  ~EventPoolReleaser ()
+  {
+    std::lock_guard<std::mutex> lock (g_eventPoolMutex);
+    if (t_eventPoolCache != 0)
+      {
+        t_eventPoolCache->inUse = false;
+        t_eventPoolCache = 0;
+      }
+  }
+};
+/** Releases the cache of the thread when the thread exits. */
+thread_local EventPoolReleaser t_eventPoolReleaser;
+
+/**
+ * \returns The cache of the current thread, a cache left by an exited
+ * thread if any, a new one otherwise.
+ */
+EventPoolCache *
+AcquireEventPoolCache (void)
+{
+  std::lock_guard<std::mutex> lock (g_eventPoolMutex);
+  if (g_eventPoolCaches == 0)
+    {
+      g_eventPoolCaches = new std::vector<EventPoolCache *> ();
+    }
+  EventPoolCache *cache = 0;
+  for (std::size_t i = 0; i < g_eventPoolCaches->size () && cache == 0; ++i)
+    {
+      if (!(*g_eventPoolCaches)[i]->inUse)
+        {
+          cache = (*g_eventPoolCaches)[i];
+        }
+    }
+  if (cache == 0)
+    {
+      cache = new EventPoolCache ();
+      for (std::size_t i = 0; i < EVENT_POOL_CLASSES; ++i)
+        {
+          cache->free[i] = 0;
+        }
+      g_eventPoolCaches->push_back (cache);
+    }
+  cache->inUse = true;
+  t_eventPoolCache = cache;
+  // the first use of the releaser registers its destructor for this thread
+  (void) &t_eventPoolReleaser;
+  return cache;
+}
+
+/**
+ * Fill the free list of a size class with a new chunk.
+ *
+ * \param [in] cache The cache of the current thread.
+ * \param [in] sizeClass The size class.
+ * \returns The first free event of the size class.
+ */
+EventPoolBlock *
+RefillEventPool (EventPoolCache *cache, std::size_t sizeClass)
+{
+  std::size_t size = (sizeClass + 1) * EVENT_POOL_GRANULARITY;
+  char *chunk = static_cast<char *> (::operator new (EVENT_POOL_CHUNK));
+  cache->chunks.push_back (chunk);
+  EventPoolBlock *head = 0;
+  for (std::size_t offset = (EVENT_POOL_CHUNK / size - 1) * size; ; offset -= size)
+    {
+      EventPoolBlock *block = reinterpret_cast<EventPoolBlock *> (chunk + offset);
+      block->next = head;
+      head = block;
+      if (offset == 0)
+        {
+          break;
+        }
+    }
+  cache->free[sizeClass] = head;
+  return head;
+}
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULARITY;
+  if (sizeClass >= EVENT_POOL_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  EventPoolCache *cache = t_eventPoolCache;
+  if (cache == 0)
+    {
+      cache = AcquireEventPoolCache ();
+    }
+  EventPoolBlock *block = cache->free[sizeClass];
+  if (block == 0)
+    {
+      block = RefillEventPool (cache, sizeClass);
+    }
+  cache->free[sizeClass] = block->next;
+  return block;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULARITY;
+  if (sizeClass >= EVENT_POOL_CLASSES)
+    {
+      ::operator delete (p);
+      return;
+    }
+  EventPoolCache *cache = t_eventPoolCache;
+  if (cache == 0)
+    {
+      cache = AcquireEventPoolCache ();
+    }
+  EventPoolBlock *block = static_cast<EventPoolBlock *> (p);
+  block->next = cache->free[sizeClass];
+  cache->free[sizeClass] = block;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
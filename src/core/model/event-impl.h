@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,15 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are small, short-lived and created at a very high rate, so
+ * they are not allocated with the global operator new: EventImpl and all
+ * its subclasses are allocated from per-thread free lists of fixed
+ * size classes (16 bytes apart, up to 256 bytes), filled from 4 KiB
+ * chunks.  An event goes back to the free list of the thread that drops
+ * its last reference, once it has been invoked or cancelled and removed
+ * from the event list.  The chunks are kept for the lifetime of the
+ * process and reused by the next threads.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +76,21 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate an event from the free list of its size class.
+   *
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return an event to the free list of its size class.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,308 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/**
+ * \ingroup scheduler
+ * Compare (greater than) two events, to keep Bottom latest first.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a > \c b
+ */
+bool
+LaterEvent (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key > b.key;
+}
+
+} // unnamed namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMin (0),
+    m_topMax (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0),
+    m_bottomLimit (2 * BUCKET_THRESHOLD),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+LadderScheduler::Locate (uint64_t ts, uint32_t *bucket) const
+{
+  if (ts >= m_topStart)
+    {
+      return MAX_RUNGS;
+    }
+  // the rungs are ordered by decreasing current bucket
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      const Rung &rung = m_rungs[i];
+      if (ts >= rung.start + rung.current * rung.width)
+        {
+          *bucket = (ts - rung.start) / rung.width;
+          NS_ASSERT (*bucket < rung.nBuckets);
+          return i;
+        }
+    }
+  return MAX_RUNGS + 1;
+}
+
+void
+LadderScheduler::SpawnRung (Bucket &events, uint64_t start, uint64_t end)
+{
+  NS_LOG_FUNCTION (this << events.size () << start << end);
+  NS_ASSERT (m_nRungs < MAX_RUNGS && !events.empty () && end > start);
+  uint64_t span = end - start;
+  uint64_t n = events.size ();
+  Rung &rung = m_rungs[m_nRungs];
+  rung.start = start;
+  rung.width = (span + n - 1) / n;
+  rung.nBuckets = (span + rung.width - 1) / rung.width;
+  rung.current = 0;
+  if (rung.buckets.size () < rung.nBuckets)
+    {
+      rung.buckets.resize (rung.nBuckets);
+    }
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      rung.buckets[(i->key.m_ts - start) / rung.width].push_back (*i);
+    }
+  events.clear ();
+  m_nRungs++;
+}
+
+void
+LadderScheduler::FillBottom (Bucket &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  NS_ASSERT (m_bottom.empty ());
+  // swap the storage, so that neither the bucket nor Bottom loses its capacity
+  m_bottom.swap (events);
+  std::sort (m_bottom.begin (), m_bottom.end (), LaterEvent);
+  m_bottomLimit = std::max<uint32_t> (2 * BUCKET_THRESHOLD, 2 * m_bottom.size ());
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_bottom.empty ());
+  while (true)
+    {
+      if (m_nRungs == 0)
+        {
+          if (m_top.empty ())
+            {
+              return;
+            }
+          if (m_top.size () <= BUCKET_THRESHOLD || m_topMin == m_topMax)
+            {
+              m_topStart = m_topMax + 1;
+              FillBottom (m_top);
+              return;
+            }
+          SpawnRung (m_top, m_topMin, m_topMax + 1);
+          const Rung &rung = m_rungs[0];
+          m_topStart = rung.start + rung.nBuckets * rung.width;
+          continue;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.current < rung.nBuckets && rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      if (rung.current == rung.nBuckets)
+        {
+          m_nRungs--;
+          continue;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t end = rung.start + (rung.current + 1) * rung.width;
+      rung.current++;
+      if (bucket.size () <= BUCKET_THRESHOLD || m_nRungs == MAX_RUNGS || rung.width == 1)
+        {
+          FillBottom (bucket);
+          return;
+        }
+      uint64_t min = bucket.front ().key.m_ts;
+      uint64_t max = min;
+      for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+        {
+          min = std::min (min, i->key.m_ts);
+          max = std::max (max, i->key.m_ts);
+        }
+      if (min == max)
+        {
+          FillBottom (bucket);
+          return;
+        }
+      NS_LOG_LOGIC ("split bucket of " << bucket.size () << " events in rung " << m_nRungs);
+      SpawnRung (bucket, min, end);
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  if (m_size == 0)
+    {
+      // start over from the new event
+      m_nRungs = 0;
+      m_topStart = 0;
+    }
+  m_size++;
+  uint32_t bucket = 0;
+  uint32_t where = Locate (ev.key.m_ts, &bucket);
+  if (where == MAX_RUNGS)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ev.key.m_ts;
+          m_topMax = ev.key.m_ts;
+        }
+      m_topMin = std::min (m_topMin, ev.key.m_ts);
+      m_topMax = std::max (m_topMax, ev.key.m_ts);
+      m_top.push_back (ev);
+    }
+  else if (where < MAX_RUNGS)
+    {
+      m_rungs[where].buckets[bucket].push_back (ev);
+    }
+  else
+    {
+      m_bottom.insert (std::lower_bound (m_bottom.begin (), m_bottom.end (), ev, LaterEvent), ev);
+      if (m_bottom.size () > m_bottomLimit && m_nRungs < MAX_RUNGS
+          && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+        {
+          // too many near future events, spread them in a rung below the others
+          uint64_t end = m_topStart;
+          if (m_nRungs > 0)
+            {
+              const Rung &lowest = m_rungs[m_nRungs - 1];
+              end = lowest.start + lowest.current * lowest.width;
+            }
+          NS_LOG_LOGIC ("spread " << m_bottom.size () << " events of Bottom in rung " << m_nRungs);
+          SpawnRung (m_bottom, m_bottom.back ().key.m_ts, end);
+        }
+    }
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Scheduler::Event next = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_size--;
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+  return next;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint32_t bucket = 0;
+  uint32_t where = Locate (ev.key.m_ts, &bucket);
+  if (where > MAX_RUNGS)
+    {
+      Bucket::iterator i = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev, LaterEvent);
+      NS_ASSERT (i != m_bottom.end () && i->key.m_uid == ev.key.m_uid);
+      m_bottom.erase (i);
+    }
+  else
+    {
+      Bucket &events = where == MAX_RUNGS ? m_top : m_rungs[where].buckets[bucket];
+      Bucket::iterator i = events.begin ();
+      while (i != events.end () && i->key.m_uid != ev.key.m_uid)
+        {
+          ++i;
+        }
+      NS_ASSERT (i != events.end ());
+      *i = events.back ();
+      events.pop_back ();
+    }
+  m_size--;
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+}
+
+} // namespace ns3
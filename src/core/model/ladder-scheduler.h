@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue of
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh and
+ * Ian Li-Jin Thng (2005).  The events are kept in three tiers:
+ *
+ * - Top, an unsorted vector of the far future events, with all
+ *   timestamps at or after the top start;
+ * - the ladder, up to MAX_RUNGS rungs of buckets; each rung splits one
+ *   bucket of the rung above it in finer buckets, the events of a bucket
+ *   are unsorted;
+ * - Bottom, a short sorted vector of the earliest events, consumed from
+ *   its end.
+ *
+ * When Bottom runs dry, the first non-empty bucket of the lowest rung is
+ * sorted into Bottom if it holds at most BUCKET_THRESHOLD events, and is
+ * otherwise split into a new rung.  When the ladder is empty, Top is
+ * spread into the first rung.  Each event is thus moved a bounded number
+ * of times and the insertion and removal of the next event take amortized
+ * constant time, without the resizing stalls of the CalendarScheduler
+ * when the timestamps mix microsecond and second scales.
+ *
+ * The buckets are vectors whose storage is kept when a rung is emptied,
+ * so the steady state allocates no memory.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** A bucket: an unsorted vector of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** One rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;               /**< Timestamp of the first bucket. */
+    uint64_t width;               /**< Duration of a bucket. */
+    uint32_t nBuckets;            /**< Number of buckets in use. */
+    uint32_t current;             /**< First bucket not yet consumed. */
+    std::vector<Bucket> buckets;  /**< The buckets, may hold more than nBuckets. */
+  };
+
+  /** The maximum number of rungs. */
+  static const uint32_t MAX_RUNGS = 8;
+  /** The largest bucket sorted into Bottom instead of being split. */
+  static const uint32_t BUCKET_THRESHOLD = 50;
+
+  /**
+   * Find where an event of a given timestamp belongs.
+   *
+   * \param [in] ts The timestamp.
+   * \param [out] bucket The bucket index, if in the ladder.
+   * \returns The rung index, MAX_RUNGS for Top or MAX_RUNGS + 1 for Bottom.
+   */
+  uint32_t Locate (uint64_t ts, uint32_t *bucket) const;
+  /**
+   * Start a new rung covering [\p start, \p end) and spread events over it.
+   *
+   * \param [in] events The events, with timestamps in [\p start, \p end).
+   * \param [in] start The timestamp of the first bucket.
+   * \param [in] end The end of the range covered by the rung.
+   */
+  void SpawnRung (Bucket &events, uint64_t start, uint64_t end);
+  /**
+   * Sort events into Bottom, which must be empty.
+   *
+   * \param [in] events The events, emptied.
+   */
+  void FillBottom (Bucket &events);
+  /** Refill Bottom from the ladder or from Top when it is empty. */
+  void Refill (void);
+
+  Bucket m_top;             /**< The far future events, unsorted. */
+  uint64_t m_topStart;      /**< Events at or after this timestamp go to Top. */
+  uint64_t m_topMin;        /**< Lower bound of the timestamps in Top. */
+  uint64_t m_topMax;        /**< Upper bound of the timestamps in Top. */
+  std::vector<Rung> m_rungs;  /**< The rungs, may hold more than m_nRungs. */
+  uint32_t m_nRungs;        /**< Number of rungs in use. */
+  Bucket m_bottom;          /**< The earliest events, latest first. */
+  uint32_t m_bottomLimit;   /**< Bottom size above which it is spread into a rung. */
+  uint32_t m_size;          /**< Total number of events. */
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
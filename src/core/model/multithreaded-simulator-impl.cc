@@ -0,0 +1,644 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulator.h"
+#include "multithreaded-simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+
+#include "ptr.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// As in DefaultSimulatorImpl, logging is avoided in the event paths.
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+namespace {
+/**
+ * Partition run by the calling thread, -1 for the global partition
+ * (main thread outside of a parallel window).
+ */
+thread_local int32_t g_partition = -1;
+
+/**
+ * Wait until \p cond holds, spinning for a short while before yielding.
+ * \param [in] cond The condition.
+ */
+template <typename COND>
+void
+SpinWait (COND cond)
+{
+  uint32_t spins = 0;
+  while (!cond ())
+    {
+      if (++spins > 1000)
+        {
+          std::this_thread::yield ();
+        }
+    }
+}
+} // unnamed namespace
+
+MultithreadedSimulatorImpl *MultithreadedSimulatorImpl::s_running = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("MaxThreads",
+                   "Number of threads (and partitions); 0 uses the number of hardware threads.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_maxThreads),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Lookahead",
+                   "Length of a parallel window; must not exceed the smallest delay "
+                   "between events of contexts in different partitions.",
+                   TimeValue (TimeStep (1)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_lookahead),
+                   MakeTimeChecker (TimeStep (1)))
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_maxThreads (0),
+    m_lookahead (TimeStep (1)),
+    m_nPartitions (0),
+    m_stop (false),
+    m_windowEnd (0),
+    m_generation (0),
+    m_pending (0),
+    m_done (false),
+    m_inWindow (false)
+{
+  NS_LOG_FUNCTION (this);
+  // replaced by Simulator::SetImplementation
+  m_schedulerFactory.SetTypeId ("ns3::MapScheduler");
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  MergeOutboxes ();
+  for (std::vector<Partition>::iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      while (!p->events->IsEmpty ())
+        {
+          Scheduler::Event next = p->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      p->events = 0;
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  for (std::vector<Partition>::iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      while (!p->events->IsEmpty ())
+        {
+          scheduler->Insert (p->events->RemoveNext ());
+        }
+      p->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CreatePartitions (void)
+{
+  if (!m_partitions.empty ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_nPartitions = m_maxThreads;
+  if (m_nPartitions == 0)
+    {
+      m_nPartitions = std::max (1u, std::thread::hardware_concurrency ());
+    }
+  // the last partition holds the events without context
+  m_partitions.resize (m_nPartitions + 1);
+  for (uint32_t i = 0; i <= m_nPartitions; ++i)
+    {
+      Partition &p = m_partitions[i];
+      p.events = m_schedulerFactory.Create<Scheduler> ();
+      // uids are allocated from 4, as in DefaultSimulatorImpl.
+      p.uid = 4;
+      p.currentUid = 0;
+      p.currentTs = 0;
+      p.currentContext = Simulator::NO_CONTEXT;
+      p.eventCount = 0;
+      p.unscheduledEvents = 0;
+      p.outbox.resize (m_nPartitions + 1);
+      p.index = i;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetPartition (uint32_t context, uint32_t partition)
+{
+  NS_LOG_FUNCTION (this << context << partition);
+  CreatePartitions ();
+  NS_ASSERT_MSG (partition < m_nPartitions, "Partition " << partition << " out of range");
+  NS_ASSERT_MSG (context != Simulator::NO_CONTEXT, "Events without context are not partitioned");
+  if (context >= m_partitionOf.size ())
+    {
+      m_partitionOf.resize (context + 1, -1);
+    }
+  m_partitionOf[context] = partition;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  const_cast<MultithreadedSimulatorImpl *> (this)->CreatePartitions ();
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return m_nPartitions;
+    }
+  if (context < m_partitionOf.size () && m_partitionOf[context] >= 0)
+    {
+      return m_partitionOf[context];
+    }
+  return context % m_nPartitions;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  const_cast<MultithreadedSimulatorImpl *> (this)->CreatePartitions ();
+  return m_nPartitions;
+}
+
+bool
+MultithreadedSimulatorImpl::IsRemoteContext (uint32_t context)
+{
+  MultithreadedSimulatorImpl *impl = s_running;
+  if (impl == 0 || !impl->m_inWindow || g_partition < 0)
+    {
+      return false;
+    }
+  return impl->GetPartition (context) != static_cast<uint32_t> (g_partition);
+}
+
+MultithreadedSimulatorImpl::Partition &
+MultithreadedSimulatorImpl::GetPartitionOf (uint32_t context)
+{
+  return m_partitions[GetPartition (context)];
+}
+
+const MultithreadedSimulatorImpl::Partition &
+MultithreadedSimulatorImpl::GetPartitionOf (uint32_t context) const
+{
+  return m_partitions[GetPartition (context)];
+}
+
+MultithreadedSimulatorImpl::Partition &
+MultithreadedSimulatorImpl::GetCurrent (void) const
+{
+  MultithreadedSimulatorImpl *self = const_cast<MultithreadedSimulatorImpl *> (this);
+  self->CreatePartitions ();
+  return self->m_partitions[g_partition < 0 ? m_nPartitions : g_partition];
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+void
+MultithreadedSimulatorImpl::Insert (Partition &p, Scheduler::Event &ev)
+{
+  ev.key.m_uid = p.uid;
+  p.uid++;
+  p.unscheduledEvents++;
+  p.events->Insert (ev);
+}
+
+void
+MultithreadedSimulatorImpl::MergeOutboxes (void)
+{
+  // Serial: targets in index order, sources in index order, events in
+  // insertion order, so uids do not depend on the thread interleaving.
+  for (std::vector<Partition>::iterator target = m_partitions.begin (); target != m_partitions.end (); ++target)
+    {
+      for (std::vector<Partition>::iterator source = m_partitions.begin (); source != m_partitions.end (); ++source)
+        {
+          std::vector<Scheduler::Event> &box = source->outbox[target->index];
+          for (std::vector<Scheduler::Event>::iterator ev = box.begin (); ev != box.end (); ++ev)
+            {
+              Insert (*target, *ev);
+            }
+          box.clear ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow (Partition &p)
+{
+  while (!p.events->IsEmpty () && p.events->PeekNext ().key.m_ts < m_windowEnd)
+    {
+      Scheduler::Event next = p.events->RemoveNext ();
+      NS_ASSERT (next.key.m_ts >= p.currentTs);
+      p.unscheduledEvents--;
+      p.eventCount++;
+      p.currentTs = next.key.m_ts;
+      p.currentContext = next.key.m_context;
+      p.currentUid = next.key.m_uid;
+      next.impl->Invoke ();
+      next.impl->Unref ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessGlobalEvents (void)
+{
+  Partition &global = m_partitions[m_nPartitions];
+  uint64_t ts = global.events->PeekNext ().key.m_ts;
+  // events scheduled now by a global event run in the same step
+  while (!global.events->IsEmpty () && global.events->PeekNext ().key.m_ts == ts && !m_stop)
+    {
+      Scheduler::Event next = global.events->RemoveNext ();
+      global.unscheduledEvents--;
+      global.eventCount++;
+      global.currentTs = next.key.m_ts;
+      global.currentContext = next.key.m_context;
+      global.currentUid = next.key.m_uid;
+      next.impl->Invoke ();
+      next.impl->Unref ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::DoWork (uint32_t index)
+{
+  g_partition = index;
+  uint64_t generation = 0;
+  while (true)
+    {
+      SpinWait ([this, generation] () { return m_generation.load (std::memory_order_acquire) != generation; });
+      ++generation;
+      if (m_done.load (std::memory_order_acquire))
+        {
+          return;
+        }
+      ProcessWindow (m_partitions[index]);
+      m_pending.fetch_sub (1, std::memory_order_acq_rel);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunWindow (void)
+{
+  m_inWindow = true;
+  m_pending.store (m_threads.size (), std::memory_order_relaxed);
+  m_generation.fetch_add (1, std::memory_order_release);
+  g_partition = 0;
+  ProcessWindow (m_partitions[0]);
+  g_partition = -1;
+  SpinWait ([this] () { return m_pending.load (std::memory_order_acquire) == 0; });
+  m_inWindow = false;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition>::const_iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      if (!p->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  CreatePartitions ();
+  NS_ASSERT_MSG (s_running == 0, "Only one MultithreadedSimulatorImpl can run at a time");
+  s_running = this;
+  m_stop = false;
+  m_done = false;
+  for (uint32_t i = 1; i < m_nPartitions; ++i)
+    {
+      m_threads.push_back (std::thread (&MultithreadedSimulatorImpl::DoWork, this, i));
+    }
+
+  Partition &global = m_partitions[m_nPartitions];
+  uint64_t lookahead = m_lookahead.GetTimeStep ();
+  while (true)
+    {
+      MergeOutboxes ();
+      if (m_stop)
+        {
+          break;
+        }
+      uint64_t next = UINT64_MAX;
+      for (uint32_t i = 0; i < m_nPartitions; ++i)
+        {
+          if (!m_partitions[i].events->IsEmpty ())
+            {
+              next = std::min (next, m_partitions[i].events->PeekNext ().key.m_ts);
+            }
+        }
+      uint64_t nextGlobal = global.events->IsEmpty () ? UINT64_MAX : global.events->PeekNext ().key.m_ts;
+      if (next == UINT64_MAX && nextGlobal == UINT64_MAX)
+        {
+          break;
+        }
+      if (nextGlobal <= next)
+        {
+          ProcessGlobalEvents ();
+          continue;
+        }
+      m_windowEnd = std::min (next + lookahead, nextGlobal);
+      NS_LOG_LOGIC ("window [" << next << ", " << m_windowEnd << "[");
+      RunWindow ();
+    }
+
+  m_done.store (true, std::memory_order_release);
+  m_generation.fetch_add (1, std::memory_order_release);
+  for (std::vector<std::thread>::iterator t = m_threads.begin (); t != m_threads.end (); ++t)
+    {
+      t->join ();
+    }
+  m_threads.clear ();
+  s_running = 0;
+
+  // Outside of Run, Now () is the time reached by the simulation.
+  for (uint32_t i = 0; i < m_nPartitions; ++i)
+    {
+      global.currentTs = std::max (global.currentTs, m_partitions[i].currentTs);
+    }
+
+#ifdef NS3_BUILD_PROFILE_DEBUG
+  if (!m_stop)
+    {
+      // consistency test, as in DefaultSimulatorImpl
+      int unscheduled = 0;
+      for (std::vector<Partition>::const_iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+        {
+          unscheduled += p->unscheduledEvents;
+        }
+      NS_ASSERT (unscheduled == 0);
+    }
+#endif
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+  Partition &current = GetCurrent ();
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = current.currentTs + delay.GetTimeStep ();
+  ev.key.m_context = current.currentContext;
+  Insert (current, ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::ScheduleWithContext(): Negative delay");
+  Partition &current = GetCurrent ();
+  Partition &target = GetPartitionOf (context);
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = current.currentTs + delay.GetTimeStep ();
+  ev.key.m_context = context;
+  if (!m_inWindow || &target == &current)
+    {
+      Insert (target, ev);
+      return;
+    }
+  if (ev.key.m_ts < m_windowEnd)
+    {
+      NS_FATAL_ERROR ("Event for context " << context << " scheduled " << delay.As (Time::NS)
+                      << " ahead from context " << current.currentContext
+                      << " of another partition, below the lookahead " << m_lookahead.As (Time::NS));
+    }
+  current.outbox[target.index].push_back (ev);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  CriticalSection cs (m_destroyMutex);
+  EventId id (Ptr<EventImpl> (event, false), GetCurrent ().currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetCurrent ().currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrent ().currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition &p = GetPartitionOf (id.GetContext ());
+  NS_ASSERT_MSG (!m_inWindow || &p == &GetCurrent (), "Simulator::Remove of an event of another partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  p.events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  p.unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const Partition &p = GetPartitionOf (id.GetContext ());
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < p.currentTs
+      || (id.GetTs () == p.currentTs && id.GetUid () <= p.currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrent ().currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t count = 0;
+  for (std::vector<Partition>::const_iterator p = m_partitions.begin (); p != m_partitions.end (); ++p)
+    {
+      count += p->eventCount;
+    }
+  return count;
+}
+
+} // namespace ns3
@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "system-mutex.h"
+#include "nstime.h"
+
+#include "ptr.h"
+
+#include <atomic>
+#include <list>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Conservative parallel simulator running one process on several threads.
+ *
+ * Event contexts (node ids) are mapped onto partitions, one partition per
+ * thread.  Each partition owns its own event queue, clock and uid counter.
+ * Events without context (Simulator::NO_CONTEXT, e.g. Simulator::Stop or
+ * events scheduled from main ()) belong to a global queue which is run
+ * serially by the main thread.
+ *
+ * The simulation advances in windows.  With T the earliest pending event of
+ * all partitions, every partition runs its events with a timestamp in
+ * [T, T + Lookahead[ concurrently, bounded by the next global event.  An
+ * event scheduled for another partition is buffered in an outbox and merged
+ * into the target queue at the next barrier, in order of source partition
+ * and insertion, so that the result does not depend on thread scheduling.
+ * The Lookahead must therefore not exceed the smallest delay of any
+ * interaction between contexts of different partitions; for a wireless
+ * channel this is the minimum propagation delay between two devices.  A
+ * cross-partition event scheduled inside the current window aborts the
+ * simulation.
+ *
+ * The implementation is only built with the --enable-mtp configure option,
+ * which also makes the reference counts and the packet free lists thread
+ * safe (NS3_MTP).  Models which share state between nodes (global
+ * variables, shared trace sinks) must protect it themselves.  Results are
+ * deterministic for a given number of threads, but events of different
+ * contexts with the same timestamp may be ordered differently than with
+ * the DefaultSimulatorImpl.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * Assign a context to a partition.  Contexts which are not assigned
+   * explicitly belong to partition context % GetNPartitions ().  Contexts
+   * exchanging events with a delay shorter than the lookahead (for example
+   * the two ends of a wired link) must share a partition.  Must be called
+   * before any event of the context is scheduled.
+   *
+   * \param [in] context The context.
+   * \param [in] partition The partition, smaller than GetNPartitions ().
+   */
+  void SetPartition (uint32_t context, uint32_t partition);
+  /**
+   * \param [in] context The context.
+   * \return The partition of the context.
+   */
+  uint32_t GetPartition (uint32_t context) const;
+  /**
+   * \return The number of partitions, which is the number of threads.
+   */
+  uint32_t GetNPartitions (void) const;
+
+  /**
+   * Whether an event of \p context would run on another thread than the
+   * caller.  Models use this to decide whether an object passed to another
+   * context must be copied.
+   *
+   * \param [in] context The context.
+   * \return \c true if a MultithreadedSimulatorImpl is running a parallel
+   *         window and \p context belongs to another partition.
+   */
+  static bool IsRemoteContext (uint32_t context);
+
+private:
+  virtual void DoDispose (void);
+
+  /** Per thread part of the simulator state. */
+  struct Partition
+  {
+    /** The event priority queue. */
+    Ptr<Scheduler> events;
+    /** Next event unique id. */
+    uint32_t uid;
+    /** Unique id of the current event. */
+    uint32_t currentUid;
+    /** Timestamp of the current event. */
+    uint64_t currentTs;
+    /** Execution context of the current event. */
+    uint32_t currentContext;
+    /** The event count. */
+    uint64_t eventCount;
+    /** Number of events inserted but not yet run. */
+    int unscheduledEvents;
+    /** Events for other partitions, indexed by target partition. */
+    std::vector<std::vector<Scheduler::Event> > outbox;
+    /** Index of this partition. */
+    uint32_t index;
+  };
+
+  /** Create the partitions, if not done yet. */
+  void CreatePartitions (void);
+  /**
+   * \param [in] context The context.
+   * \return The partition running the events of \p context.
+   */
+  Partition & GetPartitionOf (uint32_t context);
+  /** \copydoc GetPartitionOf */
+  const Partition & GetPartitionOf (uint32_t context) const;
+  /** \return The partition of the calling thread. */
+  Partition & GetCurrent (void) const;
+  /**
+   * Insert an event into a partition queue.
+   * \param [in] p The partition.
+   * \param [in] ev The event, its uid is allocated here.
+   */
+  void Insert (Partition &p, Scheduler::Event &ev);
+  /** Merge the outboxes into the partition queues. */
+  void MergeOutboxes (void);
+  /**
+   * Run the events of a partition up to the end of the window.
+   * \param [in] p The partition.
+   */
+  void ProcessWindow (Partition &p);
+  /** Run the global events with the earliest timestamp. */
+  void ProcessGlobalEvents (void);
+  /**
+   * Worker thread body.
+   * \param [in] index The partition run by the thread.
+   */
+  void DoWork (uint32_t index);
+  /** Start a window on the workers and wait for its completion. */
+  void RunWindow (void);
+
+  /** Requested number of threads, 0 for the hardware concurrency. */
+  uint32_t m_maxThreads;
+  /** Lookahead. */
+  Time m_lookahead;
+  /** Scheduler factory used for every partition. */
+  ObjectFactory m_schedulerFactory;
+  /** Partitions running the events with a context, then the global one. */
+  std::vector<Partition> m_partitions;
+  /** Number of partitions with a context. */
+  uint32_t m_nPartitions;
+  /** Explicit context to partition map. */
+  std::vector<int32_t> m_partitionOf;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Mutex protecting m_destroyEvents. */
+  SystemMutex m_destroyMutex;
+  /** Flag calling for the end of the simulation. */
+  std::atomic<bool> m_stop;
+
+  /** Worker threads, one per partition except the first one. */
+  std::vector<std::thread> m_threads;
+  /** Exclusive end timestamp of the current window. */
+  uint64_t m_windowEnd;
+  /** Window counter, incremented to start a window on the workers. */
+  std::atomic<uint64_t> m_generation;
+  /** Number of workers still running the current window. */
+  std::atomic<uint32_t> m_pending;
+  /** Flag asking the workers to exit. */
+  std::atomic<bool> m_done;
+  /** Whether a parallel window is being run. */
+  bool m_inWindow;
+
+  /** The instance running a simulation, used by IsRemoteContext. */
+  static MultithreadedSimulatorImpl *s_running;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -26,8 +26,12 @@
 #include "default-deleter.h"
 #include "assert.h"
 #include "unused.h"
+#include "ns3/core-config.h"
 #include <stdint.h>
 #include <limits>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
 /**
  * \file
@@ -115,8 +119,7 @@ public:
    */
   inline void Unref (void) const
   {
-    m_count--;
-    if (m_count == 0)
+    if (--m_count == 0)
       {
         DELETER::Delete (static_cast<T*> (const_cast<SimpleRefCount *> (this)));
       }
@@ -139,9 +142,14 @@ private:
    *
    * \internal
    * Note we make this mutable so that the const methods can still
-   * change it.
+   * change it.  With the multithreaded simulator (NS3_MTP) objects
+   * such as packets are shared between threads, so the count is atomic.
    */
+#ifdef NS3_MTP
+  mutable std::atomic<uint32_t> m_count;
+#else
   mutable uint32_t m_count;
+#endif
 };
 
 } // namespace ns3
@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/binary-log.h"
+#include "ns3/simulator.h"
+#include "ns3/core-config.h"
+#include <fstream>
+#include <sstream>
+#ifdef HAVE_PTHREAD_H
+#include <thread>
+#endif
+
+/**
+ * \file
+ * \ingroup logging-tests
+ * BinaryLog test suite.
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BinaryLogTestSuite");
+
+namespace {
+
+/** Some events of each argument type. */
+void
+RecordEvents (void)
+{
+  NS_BINLOG ("no argument");
+  NS_BINLOG ("int {}, unsigned {}", -7, 42U);
+  NS_BINLOG ("double {} and {}", 0.5, true);
+  NS_BINLOG ("at {}, {} bytes", MilliSeconds (1500), static_cast<uint16_t> (512));
+}
+
+/**
+ * \param [in] i The index of the event.
+ */
+void
+RecordIndex (uint32_t i)
+{
+  NS_BINLOG ("event {}", i);
+}
+
+/**
+ * Dump the binary log and decode it.
+ *
+ * \param [in] filename The dump file.
+ * \param [out] text The decoded text.
+ * \returns \c true if both succeeded
+ */
+bool
+DumpAndDecode (const std::string &filename, std::string &text)
+{
+  if (!BinaryLog::Dump (filename))
+    {
+      return false;
+    }
+  std::ifstream in (filename.c_str (), std::ios::binary);
+  std::ostringstream out;
+  bool ok = BinaryLog::Decode (in, out);
+  text = out.str ();
+  return ok;
+}
+
+} // unnamed namespace
+
+/**
+ * \ingroup logging-tests
+ *
+ * Check the recording, the enabling per component and the decoding.
+ */
+class BinaryLogRecordTestCase : public TestCase
+{
+public:
+  BinaryLogRecordTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryLogRecordTestCase::BinaryLogRecordTestCase ()
+  : TestCase ("Check the recording and the decoding of the binary log")
+{
+}
+
+void
+BinaryLogRecordTestCase::DoRun (void)
+{
+  BinaryLog::Disable ("*");
+  BinaryLog::Clear ();
+  RecordEvents ();
+  NS_TEST_ASSERT_MSG_EQ (BinaryLog::GetCount (), 0, "events of a disabled component recorded");
+
+  BinaryLog::Enable ("SomeOtherComponent");
+  RecordEvents ();
+  NS_TEST_ASSERT_MSG_EQ (BinaryLog::GetCount (), 0, "events of another component recorded");
+
+  BinaryLog::Enable ("BinaryLogTestSuite");
+  Simulator::ScheduleWithContext (3, Seconds (2), &RecordEvents);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (BinaryLog::GetCount (), 4, "unexpected number of events");
+
+  std::string text;
+  NS_TEST_ASSERT_MSG_EQ (DumpAndDecode (CreateTempDirFilename ("record.binlog"), text), true,
+                         "dump or decoding failed");
+  NS_TEST_EXPECT_MSG_EQ (text,
+                         "+2.000000000s 3 BinaryLogTestSuite:RecordEvents: no argument\n"
+                         "+2.000000000s 3 BinaryLogTestSuite:RecordEvents: int -7, unsigned 42\n"
+                         "+2.000000000s 3 BinaryLogTestSuite:RecordEvents: double 0.5 and true\n"
+                         "+2.000000000s 3 BinaryLogTestSuite:RecordEvents: at +1.500000000s, 512 bytes\n",
+                         "unexpected decoded text");
+
+  // outside of a simulation
+  BinaryLog::Clear ();
+  RecordIndex (1);
+  NS_TEST_ASSERT_MSG_EQ (DumpAndDecode (CreateTempDirFilename ("outside.binlog"), text), true,
+                         "dump or decoding failed");
+  NS_TEST_EXPECT_MSG_EQ (text, "+0.000000000s -1 BinaryLogTestSuite:RecordIndex: event 1\n",
+                         "unexpected decoded text outside of a simulation");
+
+  BinaryLog::Disable ("BinaryLogTestSuite");
+  RecordIndex (2);
+  NS_TEST_EXPECT_MSG_EQ (BinaryLog::GetCount (), 1, "events recorded after Disable");
+
+  std::istringstream garbage ("not a binary log");
+  std::ostringstream out;
+  NS_TEST_EXPECT_MSG_EQ (BinaryLog::Decode (garbage, out), false, "invalid dump decoded");
+  BinaryLog::Clear ();
+}
+
+/**
+ * \ingroup logging-tests
+ *
+ * Check that a full ring keeps the newest records, oldest first, and that
+ * each thread writes to its own ring.
+ */
+class BinaryLogRingTestCase : public TestCase
+{
+public:
+  BinaryLogRingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryLogRingTestCase::BinaryLogRingTestCase ()
+  : TestCase ("Check the wrap around of the binary log rings")
+{
+}
+
+void
+BinaryLogRingTestCase::DoRun (void)
+{
+  BinaryLog::Enable ("BinaryLogTestSuite");
+  BinaryLog::Clear ();
+  // the rings hold 1 << 16 records by default
+  const uint32_t events = (1 << 16) + 10;
+  for (uint32_t i = 0; i < events; i++)
+    {
+      RecordIndex (i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (BinaryLog::GetCount (), 1 << 16, "unexpected number of events in a full ring");
+
+  std::string text;
+  NS_TEST_ASSERT_MSG_EQ (DumpAndDecode (CreateTempDirFilename ("ring.binlog"), text), true,
+                         "dump or decoding failed");
+  std::istringstream lines (text);
+  std::string line;
+  std::getline (lines, line);
+  NS_TEST_EXPECT_MSG_NE (line.find ("10 oldest records overwritten"), std::string::npos,
+                         "overwritten records not reported");
+  std::getline (lines, line);
+  NS_TEST_EXPECT_MSG_EQ (line, "+0.000000000s -1 BinaryLogTestSuite:RecordIndex: event 10",
+                         "unexpected oldest record");
+  std::string last;
+  while (std::getline (lines, line))
+    {
+      last = line;
+    }
+  std::ostringstream expected;
+  expected << "+0.000000000s -1 BinaryLogTestSuite:RecordIndex: event " << events - 1;
+  NS_TEST_EXPECT_MSG_EQ (last, expected.str (), "unexpected newest record");
+  BinaryLog::Clear ();
+
+#ifdef HAVE_PTHREAD_H
+  // a thread writes to its own ring, which outlives it
+  BinaryLog::SetRingSize (4);
+  std::thread thread ([] ()
+  {
+    for (uint32_t i = 0; i < 6; i++)
+      {
+        RecordIndex (i);
+      }
+  });
+  thread.join ();
+  BinaryLog::SetRingSize (1 << 16);
+  RecordIndex (100);
+  NS_TEST_EXPECT_MSG_EQ (BinaryLog::GetCount (), 4 + 1, "unexpected number of events of two threads");
+  BinaryLog::Clear ();
+#endif
+  BinaryLog::Disable ("BinaryLogTestSuite");
+}
+
+/**
+ * \ingroup logging-tests
+ *
+ * BinaryLog test suite.
+ */
+class BinaryLogTestSuite : public TestSuite
+{
+public:
+  BinaryLogTestSuite ();
+};
+
+BinaryLogTestSuite::BinaryLogTestSuite ()
+  : TestSuite ("binary-log", UNIT)
+{
+  AddTestCase (new BinaryLogRecordTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryLogRingTestCase, TestCase::QUICK);
+}
+
+static BinaryLogTestSuite binaryLogTestSuite;
@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief Exchange of events between contexts of different partitions.
+ *
+ * Every context relays a token to the next context with a delay of at
+ * least the lookahead.  The per-context history must be the same with the
+ * DefaultSimulatorImpl and with the MultithreadedSimulatorImpl.
+ */
+class MultithreadedSimulatorRelayTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorRelayTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /// Per context history: (time in ns, token)
+  typedef std::vector<std::vector<std::pair<int64_t, uint32_t> > > History;
+
+  /**
+   * Run the relay on an implementation.
+   * \param impl The simulator implementation.
+   * \return The per context history.
+   */
+  History RunRelay (Ptr<SimulatorImpl> impl);
+  /**
+   * Receive a token and relay it.
+   * \param token The token.
+   * \param hops The hops left.
+   */
+  void Relay (uint32_t token, uint32_t hops);
+  /// Stop event, records the stop time
+  void RecordStop (void);
+
+  /// Number of contexts
+  static const uint32_t N_CONTEXTS = 8;
+  /// Current history
+  History m_history;
+  /// Whether an event ran in the wrong context
+  bool m_badContext;
+};
+
+MultithreadedSimulatorRelayTestCase::MultithreadedSimulatorRelayTestCase ()
+  : TestCase ("Relay of events between partitions")
+{
+}
+
+void
+MultithreadedSimulatorRelayTestCase::Relay (uint32_t token, uint32_t hops)
+{
+  uint32_t context = Simulator::GetContext ();
+  if (context >= N_CONTEXTS)
+    {
+      m_badContext = true;
+      return;
+    }
+  m_history[context].push_back (std::make_pair (Simulator::Now ().GetNanoSeconds (), token));
+  if (hops == 0)
+    {
+      return;
+    }
+  // a local timer and a message to a neighbour, at or beyond the lookahead
+  Simulator::Schedule (MicroSeconds (100 + token), &MultithreadedSimulatorRelayTestCase::Relay, this,
+                       token + 1000, 0);
+  Simulator::ScheduleWithContext ((context + 1 + token % 3) % N_CONTEXTS, MilliSeconds (1) + MicroSeconds (token % 7),
+                                  &MultithreadedSimulatorRelayTestCase::Relay, this, token + 1, hops - 1);
+}
+
+void
+MultithreadedSimulatorRelayTestCase::RecordStop (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), Simulator::NO_CONTEXT, "Stop runs without context");
+}
+
+MultithreadedSimulatorRelayTestCase::History
+MultithreadedSimulatorRelayTestCase::RunRelay (Ptr<SimulatorImpl> impl)
+{
+  Simulator::Destroy ();
+  Simulator::SetImplementation (impl);
+  m_history.assign (N_CONTEXTS, std::vector<std::pair<int64_t, uint32_t> > ());
+  m_badContext = false;
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (10 * i), &MultithreadedSimulatorRelayTestCase::Relay,
+                                      this, 10 * i, 50);
+    }
+  Simulator::Schedule (MilliSeconds (30), &MultithreadedSimulatorRelayTestCase::RecordStop, this);
+  Simulator::Stop (MilliSeconds (40));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_badContext, false, "Events run in their context");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (40), "Stopped at the stop time");
+  Simulator::Destroy ();
+  return m_history;
+}
+
+void
+MultithreadedSimulatorRelayTestCase::DoRun (void)
+{
+  History reference = RunRelay (CreateObject<DefaultSimulatorImpl> ());
+
+  Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl> ();
+  impl->SetAttribute ("MaxThreads", UintegerValue (3));
+  impl->SetAttribute ("Lookahead", TimeValue (MilliSeconds (1)));
+  NS_TEST_EXPECT_MSG_EQ (impl->GetNPartitions (), 3, "One partition per thread");
+  impl->SetPartition (4, 0);
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (4), 0, "Explicit partition");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (5), 2, "Default partition");
+  History parallel = RunRelay (impl);
+
+  for (uint32_t i = 0; i < N_CONTEXTS; ++i)
+    {
+      // events of a context with the same timestamp may run in another order
+      std::sort (reference[i].begin (), reference[i].end ());
+      std::sort (parallel[i].begin (), parallel[i].end ());
+      NS_TEST_EXPECT_MSG_GT (reference[i].size (), 0, "Context " << i << " received events");
+      NS_TEST_ASSERT_MSG_EQ (parallel[i].size (), reference[i].size (), "Number of events of context " << i);
+      for (uint32_t j = 0; j < reference[i].size (); ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ (parallel[i][j].first, reference[i][j].first, "Time of event " << j << " of context " << i);
+          NS_TEST_EXPECT_MSG_EQ (parallel[i][j].second, reference[i][j].second, "Token of event " << j << " of context " << i);
+        }
+    }
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief Cancel, expiry and remote context queries.
+ */
+class MultithreadedSimulatorEventIdTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorEventIdTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /// Event which must not run
+  void Cancelled (void);
+  /// Check the event ids and the remote contexts from context 0
+  void Check (void);
+
+  /// Event cancelled by Check
+  EventId m_cancelled;
+  /// Whether the cancelled event ran
+  bool m_cancelledRan;
+  /// Whether Check ran
+  bool m_checked;
+};
+
+MultithreadedSimulatorEventIdTestCase::MultithreadedSimulatorEventIdTestCase ()
+  : TestCase ("Event ids and remote contexts")
+{
+}
+
+void
+MultithreadedSimulatorEventIdTestCase::Cancelled (void)
+{
+  m_cancelledRan = true;
+}
+
+void
+MultithreadedSimulatorEventIdTestCase::Check (void)
+{
+  m_checked = true;
+  NS_TEST_EXPECT_MSG_EQ (MultithreadedSimulatorImpl::IsRemoteContext (0), false, "Own context");
+  NS_TEST_EXPECT_MSG_EQ (MultithreadedSimulatorImpl::IsRemoteContext (1), true, "Context of the other partition");
+  NS_TEST_EXPECT_MSG_EQ (m_cancelled.IsExpired (), false, "Pending event");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetDelayLeft (m_cancelled), MilliSeconds (1), "Delay left");
+  m_cancelled.Cancel ();
+  NS_TEST_EXPECT_MSG_EQ (m_cancelled.IsExpired (), true, "Cancelled event");
+  EventId removed = Simulator::Schedule (MilliSeconds (2), &MultithreadedSimulatorEventIdTestCase::Cancelled, this);
+  Simulator::Remove (removed);
+}
+
+void
+MultithreadedSimulatorEventIdTestCase::DoRun (void)
+{
+  Simulator::Destroy ();
+  Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl> ();
+  impl->SetAttribute ("MaxThreads", UintegerValue (2));
+  Simulator::SetImplementation (impl);
+  m_cancelledRan = false;
+  m_checked = false;
+  NS_TEST_EXPECT_MSG_EQ (MultithreadedSimulatorImpl::IsRemoteContext (1), false, "Not running");
+  m_cancelled = Simulator::Schedule (MilliSeconds (2), &MultithreadedSimulatorEventIdTestCase::Cancelled, this);
+  Simulator::ScheduleWithContext (0, MilliSeconds (1), &MultithreadedSimulatorEventIdTestCase::Check, this);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_checked, true, "Check ran");
+  NS_TEST_EXPECT_MSG_EQ (m_cancelledRan, false, "Cancelled and removed events did not run");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventCount (), 2, "Executed events");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief MultithreadedSimulatorImpl test suite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator", UNIT)
+  {
+    AddTestCase (new MultithreadedSimulatorRelayTestCase, TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorEventIdTestCase, TestCase::QUICK);
+  }
+};
+
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite; //!< Static variable for test initialization
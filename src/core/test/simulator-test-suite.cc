@@ -19,10 +19,14 @@
  */
 #include "ns3/test.h"
 #include "ns3/simulator.h"
+#include "ns3/event-impl.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include <set>
 
 using namespace ns3;
 
@@ -461,6 +465,176 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+  /** An argument larger than the largest size class of the event pool. */
+  struct Large
+  {
+    uint8_t data[300];  /**< Payload. */
+  };
+private:
+  virtual void DoRun (void);
+  void Small (void);
+  void Medium (int a, double b, uint64_t c);
+  void Big (Large large);
+  uint32_t m_invoked;
+  uint8_t m_lastByte;
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that the events are recycled by the event pool")
+{
+}
+void
+SimulatorEventPoolTestCase::Small (void)
+{
+  m_invoked++;
+}
+void
+SimulatorEventPoolTestCase::Medium (int a, double b, uint64_t c)
+{
+  m_invoked++;
+}
+void
+SimulatorEventPoolTestCase::Big (Large large)
+{
+  m_invoked++;
+  m_lastByte = large.data[299];
+}
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  m_invoked = 0;
+  m_lastByte = 0;
+
+  // an invoked event is recycled for the next event of the same size
+  EventId id = Simulator::Schedule (Seconds (1), &SimulatorEventPoolTestCase::Small, this);
+  EventImpl *first = id.PeekEventImpl ();
+  id = EventId ();
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_invoked, 1, "Event should have run");
+  id = Simulator::Schedule (Seconds (1), &SimulatorEventPoolTestCase::Small, this);
+  NS_TEST_EXPECT_MSG_EQ (id.PeekEventImpl (), first, "Invoked event should have been recycled");
+
+  // so is a canceled event, once the simulator drops it
+  Simulator::Cancel (id);
+  id = EventId ();
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_invoked, 1, "Canceled event should not have run");
+  id = Simulator::Schedule (Seconds (1), &SimulatorEventPoolTestCase::Small, this);
+  NS_TEST_EXPECT_MSG_EQ (id.PeekEventImpl (), first, "Canceled event should have been recycled");
+
+  // events of another size class and events too large for the pool
+  EventId medium = Simulator::Schedule (Seconds (1), &SimulatorEventPoolTestCase::Medium, this, 1, 2.0, 3);
+  NS_TEST_EXPECT_MSG_NE (medium.PeekEventImpl (), first, "Pending events should not share memory");
+  Large large;
+  large.data[299] = 42;
+  Simulator::Schedule (Seconds (1), &SimulatorEventPoolTestCase::Big, this, large);
+  id = EventId ();
+  medium = EventId ();
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_invoked, 4, "All events should have run");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) m_lastByte, 42, "Large event should have kept its argument");
+
+  Simulator::Destroy ();
+}
+
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+private:
+  virtual void DoRun (void);
+  /**
+   * Draw a delay, microseconds most of the time and up to seconds
+   * otherwise, as the slot times and the routing timers of a wireless
+   * simulation.
+   * \returns The delay, in time steps.
+   */
+  uint64_t NextDelay (void);
+  ObjectFactory m_schedulerFactory;
+  Ptr<UniformRandomVariable> m_random;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that events are removed in order with " + schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+uint64_t
+SchedulerOrderTestCase::NextDelay (void)
+{
+  double u = m_random->GetValue ();
+  if (u < 0.05)
+    {
+      return 0;
+    }
+  if (u < 0.9)
+    {
+      return m_random->GetInteger (1, 100000);
+    }
+  return 1 + (uint64_t) m_random->GetValue (0, 20e9);
+}
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (7);
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  std::set<Scheduler::EventKey> reference;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+
+  // a population large enough to split buckets, then a random mix
+  for (uint32_t i = 0; i < 25000; ++i)
+    {
+      uint32_t action = m_random->GetInteger (0, 9);
+      if (i < 5000 || action < 5 || reference.empty ())
+        {
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key.m_ts = now + NextDelay ();
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          reference.insert (ev.key);
+        }
+      else if (action < 9)
+        {
+          Scheduler::Event ev = scheduler->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, reference.begin ()->m_uid, "Event removed out of order");
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_ts, reference.begin ()->m_ts, "Event removed out of order");
+          now = ev.key.m_ts;
+          reference.erase (reference.begin ());
+        }
+      else
+        {
+          // remove an arbitrary pending event, as Simulator::Remove does
+          std::set<Scheduler::EventKey>::iterator victim = reference.begin ();
+          std::advance (victim, m_random->GetInteger (0, reference.size () - 1));
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key = *victim;
+          scheduler->Remove (ev);
+          reference.erase (victim);
+        }
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), reference.empty (), "Wrong emptiness");
+      if (!reference.empty ())
+        {
+          NS_TEST_ASSERT_MSG_EQ (scheduler->PeekNext ().key.m_uid, reference.begin ()->m_uid, "Wrong next event");
+        }
+    }
+  while (!reference.empty ())
+    {
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, reference.begin ()->m_uid, "Event drained out of order");
+      reference.erase (reference.begin ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (scheduler->IsEmpty (), true, "Events left in the scheduler");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -477,5 +651,19 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
+
+    ObjectFactory schedulers[5];
+    schedulers[0].SetTypeId (ListScheduler::GetTypeId ());
+    schedulers[1].SetTypeId (MapScheduler::GetTypeId ());
+    schedulers[2].SetTypeId (HeapScheduler::GetTypeId ());
+    schedulers[3].SetTypeId (CalendarScheduler::GetTypeId ());
+    schedulers[4].SetTypeId (LadderScheduler::GetTypeId ());
+    for (uint32_t i = 0; i < 5; ++i)
+      {
+        AddTestCase (new SchedulerOrderTestCase (schedulers[i]), TestCase::QUICK);
+      }
   }
 } g_simulatorTestSuite;
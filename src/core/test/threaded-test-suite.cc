@@ -226,6 +226,64 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class ThreadedSimulatorOrderTestCase : public TestCase
+{
+public:
+  ThreadedSimulatorOrderTestCase ();
+  void Received (uint32_t seq);
+  void Poll (void);
+  void Inject (void);
+  virtual void DoRun (void);
+  static const uint32_t N = 10000;
+  uint32_t m_next;
+  bool m_inOrder;
+};
+
+ThreadedSimulatorOrderTestCase::ThreadedSimulatorOrderTestCase ()
+  : TestCase ("Events scheduled from another thread run in scheduling order")
+{
+}
+void
+ThreadedSimulatorOrderTestCase::Received (uint32_t seq)
+{
+  if (seq != m_next)
+    {
+      m_inOrder = false;
+    }
+  m_next++;
+}
+void
+ThreadedSimulatorOrderTestCase::Poll (void)
+{
+  if (m_next < N)
+    {
+      Simulator::Schedule (MicroSeconds (1), &ThreadedSimulatorOrderTestCase::Poll, this);
+    }
+}
+void
+ThreadedSimulatorOrderTestCase::Inject (void)
+{
+  for (uint32_t i = 0; i < N; ++i)
+    {
+      Simulator::ScheduleWithContext (i % 7, Seconds (0), &ThreadedSimulatorOrderTestCase::Received, this, i);
+    }
+}
+void
+ThreadedSimulatorOrderTestCase::DoRun (void)
+{
+  m_next = 0;
+  m_inOrder = true;
+  Simulator::Schedule (MicroSeconds (1), &ThreadedSimulatorOrderTestCase::Poll, this);
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&ThreadedSimulatorOrderTestCase::Inject, this));
+  thread->Start ();
+  Simulator::Run ();
+  thread->Join ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_next, N, "Lost events");
+  NS_TEST_EXPECT_MSG_EQ (m_inOrder, true, "Events reordered");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -242,7 +300,8 @@ public:
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -263,5 +322,6 @@ public:
               }
           }
       }
+    AddTestCase (new ThreadedSimulatorOrderTestCase (), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
@@ -87,7 +87,9 @@ AnimationInterface::AnimationInterface (const std::string fn)
     m_routingStopTime (Seconds (0)), 
     m_routingFileName (""),
     m_routingPollInterval (Seconds (5)), 
-    m_trackPackets (true)
+    m_trackPackets (true),
+    m_compress (false),
+    m_samplingThreshold (static_cast<uint64_t> (1) << 32)
 {
   initialized = true;
   StartAnimation ();
@@ -261,6 +263,49 @@ AnimationInterface::EnablePacketMetadata (bool enable)
      }
 }
 
+void
+AnimationInterface::EnableCompression (bool enable)
+{
+  if (enable == m_compress)
+    {
+      return;
+    }
+  // the constructor already opened the trace: start it again in the new format
+  StopAnimation (true);
+  std::remove (m_outputFileName.c_str ());
+  m_compress = enable;
+  m_outputFileName = enable ? m_originalFileName + ".gz" : m_originalFileName;
+  StartAnimation (true);
+}
+
+void
+AnimationInterface::SetPacketSampling (double fraction)
+{
+  NS_ASSERT_MSG (fraction >= 0 && fraction <= 1, "Sampling fraction out of [0, 1]: " << fraction);
+  m_samplingThreshold = static_cast<uint64_t> (fraction * 4294967296.0);
+}
+
+void
+AnimationInterface::SetPacketFilter (PacketFilterCallback filter)
+{
+  m_packetFilter = filter;
+}
+
+bool
+AnimationInterface::IsPacketTraced (Ptr<const Packet> p)
+{
+  if (m_samplingThreshold >> 32 == 0)
+    {
+      // Knuth multiplicative hash, so that consecutive uids are spread
+      uint32_t hash = static_cast<uint32_t> (p->GetUid () * 2654435761ULL);
+      if (hash >= m_samplingThreshold)
+        {
+          return false;
+        }
+    }
+  return m_packetFilter.IsNull () || m_packetFilter (p);
+}
+
 bool 
 AnimationInterface::IsInitialized ()
 {
@@ -784,6 +829,7 @@ AnimationInterface::DevTxTrace (std::string context,
 {
   NS_LOG_FUNCTION (this);
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
+  CHECK_PACKET_TRACED (p);
   NS_ASSERT (tx);
   NS_ASSERT (rx);
   Time now = Simulator::Now ();
@@ -807,6 +853,7 @@ AnimationInterface::GenericWirelessTxTrace (std::string context, Ptr<const Packe
 {
   NS_LOG_FUNCTION (this);
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
+  CHECK_PACKET_TRACED (p);
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   UpdatePosition (ndev);
@@ -837,6 +884,7 @@ AnimationInterface::GenericWirelessRxTrace (std::string context, Ptr<const Packe
 {
   NS_LOG_FUNCTION (this);
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
+  CHECK_PACKET_TRACED (p);
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   UpdatePosition (ndev);
@@ -878,6 +926,7 @@ AnimationInterface::WifiPhyRxBeginTrace (std::string context, Ptr<const Packet>
 {
   NS_LOG_FUNCTION (this);
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
+  CHECK_PACKET_TRACED (p);
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   UpdatePosition (ndev);
@@ -917,6 +966,7 @@ AnimationInterface::LrWpanPhyTxBeginTrace (std::string context,
 {
   NS_LOG_FUNCTION (this);
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
+  CHECK_PACKET_TRACED (p);
 
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
@@ -969,6 +1019,7 @@ AnimationInterface::LrWpanPhyRxBeginTrace (std::string context,
 {
   NS_LOG_FUNCTION (this);
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
+  CHECK_PACKET_TRACED (p);
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   Ptr <Node> n = ndev->GetNode ();
@@ -1004,6 +1055,7 @@ AnimationInterface::WavePhyRxBeginTrace (std::string context, Ptr<const Packet>
 {
   NS_LOG_FUNCTION (this);
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
+  CHECK_PACKET_TRACED (p);
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   UpdatePosition (ndev);
@@ -1088,6 +1140,10 @@ AnimationInterface::LteSpectrumPhyTxStart (std::string context, Ptr<const Packet
        ++i)
     {
       Ptr <Packet> p = *i;
+      if (!IsPacketTraced (p))
+        {
+          continue;
+        }
       ++gAnimUid;
       NS_LOG_INFO ("LteSpectrumPhyTxTrace for packet:" << gAnimUid);
       AnimPacketInfo pktInfo (ndev, Simulator::Now ());
@@ -1118,6 +1174,10 @@ AnimationInterface::LteSpectrumPhyRxStart (std::string context, Ptr<const Packet
        ++i)
     {
       Ptr <Packet> p = *i;
+      if (!IsPacketTraced (p))
+        {
+          continue;
+        }
       uint64_t animUid = GetAnimUidFromPacket (p);
       NS_LOG_INFO ("LteSpectrumPhyRxTrace for packet:" << gAnimUid);
       if (!IsPacketPending (animUid, AnimationInterface::LTE))
@@ -1136,6 +1196,7 @@ AnimationInterface::CsmaPhyTxBeginTrace (std::string context, Ptr<const Packet>
 {
   NS_LOG_FUNCTION (this);
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
+  CHECK_PACKET_TRACED (p);
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   UpdatePosition (ndev);
@@ -1154,6 +1215,7 @@ AnimationInterface::CsmaPhyTxEndTrace (std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this);
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
+  CHECK_PACKET_TRACED (p);
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   UpdatePosition (ndev);
@@ -1177,6 +1239,7 @@ AnimationInterface::CsmaPhyRxEndTrace (std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this);
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
+  CHECK_PACKET_TRACED (p);
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   UpdatePosition (ndev);
@@ -1200,6 +1263,7 @@ AnimationInterface::CsmaMacRxTrace (std::string context,
 {
   NS_LOG_FUNCTION (this);
   CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS;
+  CHECK_PACKET_TRACED (p);
   Ptr <NetDevice> ndev = GetNetDeviceFromContext (context);
   NS_ASSERT (ndev);
   uint64_t animUid = GetAnimUidFromPacket (p);
@@ -1441,7 +1505,18 @@ AnimationInterface::StopAnimation (bool onlyAnimation)
     {
       // Terminate the anim element
       WriteXmlClose ("anim");
-      std::fclose (m_f);
+      if (m_compress)
+        {
+          int status = pclose (m_f);
+          if (status == -1 || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+            {
+              NS_FATAL_ERROR ("gzip failed to write the output file:" << m_outputFileName.c_str ());
+            }
+        }
+      else
+        {
+          std::fclose (m_f);
+        }
       m_f = 0;
     }
   if (onlyAnimation)
@@ -2074,7 +2149,28 @@ AnimationInterface::SetOutputFile (const std::string& fn, bool routing)
 
   NS_LOG_INFO ("Creating new trace file:" << fn.c_str ());
   FILE * f = 0;
-  f = std::fopen (fn.c_str (), "w");
+  if (m_compress && !routing)
+    {
+      // an unwritable path only shows in the exit status of the shell otherwise
+      f = std::fopen (fn.c_str (), "w");
+      if (f)
+        {
+          std::fclose (f);
+          // single quote the file name, a quote in it is written '\''
+          std::string quoted = "'";
+          for (std::string::const_iterator c = fn.begin (); c != fn.end (); c++)
+            {
+              quoted += (*c == '\'') ? std::string ("'\\''") : std::string (1, *c);
+            }
+          quoted += "'";
+          std::string command = "gzip -c > " + quoted;
+          f = popen (command.c_str (), "w");
+        }
+    }
+  else
+    {
+      f = std::fopen (fn.c_str (), "w");
+    }
   if (!f)
     {
       NS_FATAL_ERROR ("Unable to open output file:" << fn.c_str ());
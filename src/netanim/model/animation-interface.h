@@ -52,6 +52,7 @@ namespace ns3 {
 #define NETANIM_VERSION "netanim-3.108"
 #define CHECK_STARTED_INTIMEWINDOW {if (!m_started || !IsInTimeWindow ()) return;}
 #define CHECK_STARTED_INTIMEWINDOW_TRACKPACKETS {if (!m_started || !IsInTimeWindow () || !m_trackPackets) return;}
+#define CHECK_PACKET_TRACED(p) {if (!IsPacketTraced (p)) return;}
 
 
 struct NodeSize;
@@ -387,6 +388,55 @@ public:
    */
   void EnablePacketMetadata (bool enable = true);
 
+  /**
+   *
+   * \brief Compress the trace file with gzip
+   * \param enable if true the trace is written through gzip to the file name
+   *        given to the constructor followed by ".gz"
+   *
+   * The trace file opened by the constructor is removed and the trace is
+   * started again, so this should be called right after the constructor.
+   * The trace is still written while the simulation runs.
+   *
+   * \returns none
+   */
+  void EnableCompression (bool enable = true);
+
+  /**
+   *
+   * \brief Trace only a fraction of the packets
+   * \param fraction the fraction of the packets to trace, between 0 and 1
+   *
+   * The packets are selected from their uid, so that a packet is traced on
+   * every hop or on none, and the same packets are selected in every run.
+   * No random variable is used.
+   *
+   * \returns none
+   */
+  void SetPacketSampling (double fraction);
+
+  /**
+   * Callback selecting the packets to trace
+   *
+   * \param [in] packet the packet
+   * \returns true if the packet should be traced
+   */
+  typedef Callback<bool, Ptr<const Packet> > PacketFilterCallback;
+
+  /**
+   *
+   * \brief Trace only the packets accepted by a filter
+   * \param filter the filter, applied to the packets selected by SetPacketSampling.
+   *        A null callback traces all of them.
+   *
+   * The filter must return the same result for a packet on transmission and
+   * on reception, for example by looking for a header in the packet metadata
+   * (see EnablePacketMetadata) to trace only routing control packets.
+   *
+   * \returns none
+   */
+  void SetPacketFilter (PacketFilterCallback filter);
+
   /**
    *
    * \brief Get trace file packet count (This used only for testing)
@@ -634,6 +684,9 @@ private:
   Time m_wifiPhyCountersPollInterval; ///< wifi Phy counters poll interval
   static Rectangle * userBoundary; ///< user boundary
   bool m_trackPackets; ///< track packets
+  bool m_compress; ///< compress the trace file with gzip
+  uint64_t m_samplingThreshold; ///< packets whose uid hash is below this value are traced
+  PacketFilterCallback m_packetFilter; ///< filter of the packets to trace
 
   // Counter ID
   uint32_t m_remainingEnergyCounterId; ///< remaining energy counter ID
@@ -800,6 +853,12 @@ private:
    */
   std::vector<std::string> GetIpv6Addresses (Ptr <NetDevice> nd);
 
+  /**
+   * Is packet traced function
+   * \param p the packet
+   * \returns true if the packet is selected by the sampling and the filter
+   */
+  bool IsPacketTraced (Ptr<const Packet> p);
   /**
    * Get netanim version function
    * \returns the net anim version string
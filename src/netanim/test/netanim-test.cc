@@ -253,6 +253,55 @@ AnimationRemainingEnergyTestCase::CheckLogic (void)
                             "Wrong remaining energy value was traced");
 }
 
+/**
+ * \ingroup netanim-test
+ * \ingroup tests
+ *
+ * \brief Animation Compression Test Case
+ */
+class AnimationCompressionTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor.
+   */
+  AnimationCompressionTestCase ();
+
+private:
+  virtual void
+  DoRun (void);
+};
+
+AnimationCompressionTestCase::AnimationCompressionTestCase () :
+  TestCase ("Verify the compressed trace of a file name with a quote")
+{
+}
+
+void
+AnimationCompressionTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+  AnimationInterface::SetConstantPosition (nodes.Get (0), 0, 10);
+  AnimationInterface *anim = new AnimationInterface ("netanim-test's.xml");
+  anim->EnableCompression (true);
+  Simulator::Stop (Seconds (1.0));
+  Simulator::Run ();
+  delete anim;
+  Simulator::Destroy ();
+
+  FILE * fp = fopen ("netanim-test's.xml.gz", "r");
+  NS_TEST_ASSERT_MSG_NE (fp, 0, "Compressed trace file was not created");
+  int magic0 = fgetc (fp);
+  int magic1 = fgetc (fp);
+  fclose (fp);
+  unlink ("netanim-test's.xml.gz");
+  NS_TEST_EXPECT_MSG_EQ (magic0, 0x1f, "gzip magic number");
+  NS_TEST_EXPECT_MSG_EQ (magic1, 0x8b, "gzip magic number");
+  fp = fopen ("netanim-test's.xml", "r");
+  NS_TEST_EXPECT_MSG_EQ (fp, 0, "Uncompressed trace file removed");
+}
+
 /**
  * \ingroup netanim-test
  * \ingroup tests
@@ -267,5 +316,6 @@ public:
   {
     AddTestCase (new AnimationInterfaceTestCase (), TestCase::QUICK);
     AddTestCase (new AnimationRemainingEnergyTestCase (), TestCase::QUICK);
+    AddTestCase (new AnimationCompressionTestCase (), TestCase::QUICK);
   }
 } g_animationInterfaceTestSuite; ///< the test suite
@@ -50,68 +50,24 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
- */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
-{
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
-}
+thread_local uint32_t Buffer::g_maxSize = 0;
 
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
   g_maxSize = std::max (g_maxSize, data->m_size);
   /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
+  if (data->m_size < g_maxSize)
     {
       Buffer::Deallocate (data);
     }
   else
     {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      FreeList::Put (data);
     }
 }
 
@@ -120,25 +76,17 @@ Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
   /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
-    {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
+  struct Buffer::Data *data;
+  while ((data = FreeList::Get ()) != 0)
     {
-      while (!g_freeList->empty ()) 
+      if (data->m_size >= dataSize) 
         {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
+          data->m_count = 1;
+          return data;
         }
+      Buffer::Deallocate (data);
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
+  data = Buffer::Allocate (dataSize);
   NS_ASSERT (data->m_count == 1);
   return data;
 }
@@ -24,7 +24,11 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "ns3/core-config.h"
+#include "thread-free-list.h"
 
+// The free list is per thread (see ThreadFreeList), so that it is safe
+// with the multithreaded simulator (NS3_MTP) and concurrent simulations.
 #define BUFFER_FREE_LIST 1
 
 namespace ns3 {
@@ -767,7 +771,7 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -791,16 +795,9 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  /// Container for buffer data, per thread
+  typedef ThreadFreeList<struct Buffer::Data, &Buffer::Deallocate> FreeList;
+  static thread_local uint32_t g_maxSize; //!< Max observed data size, per thread
 #endif
 };
 
@@ -18,13 +18,14 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "byte-tag-list.h"
+#include "thread-free-list.h"
 #include "ns3/log.h"
 #include <vector>
 #include <cstring>
 #include <limits>
 
+// Per thread, see BUFFER_FREE_LIST
 #define USE_FREE_LIST 1
-#define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max ())
 
 namespace ns3 {
@@ -49,27 +50,20 @@ struct ByteTagListData {
 /**
  * \ingroup packet
  *
- * \brief Container class for struct ByteTagListData
+ * \brief Free the memory of a struct ByteTagListData for good.
  *
- * Internal use only.
+ * \param data the data
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
+static void
+FreeByteTagListData (struct ByteTagListData *data)
 {
-public:
-  ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
-
-ByteTagListDataFreeList::~ByteTagListDataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (ByteTagListDataFreeList::iterator i = begin ();
-       i != end (); i++)
-    {
-      uint8_t *buffer = (uint8_t *)(*i);
-      delete [] buffer;
-    }
+  uint8_t *buffer = (uint8_t *)data;
+  delete [] buffer;
 }
+
+/// Container for struct ByteTagListData, per thread
+typedef ThreadFreeList<struct ByteTagListData, &FreeByteTagListData> ByteTagListDataFreeList;
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size (used for allocation), per thread
 #endif /* USE_FREE_LIST */
 
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
@@ -345,22 +339,19 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  struct ByteTagListData *data;
+  while ((data = ByteTagListDataFreeList::Get ()) != 0)
     {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
-      NS_ASSERT (data != 0);
       if (data->size >= size)
         {
           data->count = 1;
           data->dirty = 0;
           return data;
         }
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
+      FreeByteTagListData (data);
     }
   uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
-  struct ByteTagListData *data = (struct ByteTagListData *)buffer;
+  data = (struct ByteTagListData *)buffer;
   data->count = 1;
   data->size = size;
   data->dirty = 0;
@@ -379,15 +370,13 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
-          data->size < g_maxSize)
+      if (data->size < g_maxSize)
         {
-          uint8_t *buffer = (uint8_t *)data;
-          delete [] buffer;
+          FreeByteTagListData (data);
         }
       else
         {
-          g_freeList.push_back (data);
+          ByteTagListDataFreeList::Put (data);
         }
     }
 }
@@ -38,8 +38,6 @@ NS_LOG_COMPONENT_DEFINE ("Node");
 
 NS_OBJECT_ENSURE_REGISTERED (Node);
 
-std::vector<uint32_t> null_list;
-
 /**
  * \brief A global switch to enable all checksums for all protocols.
  */
@@ -79,24 +77,7 @@ Node::GetTypeId (void)
 
 Node::Node()
   : m_id (0),
-    m_sid (0),
-    RREQ_num(0),
-    RREP_num(0),
-    WHC_num(0),
-    WHE_num(0),
-    DC_num(0),
-    // DE_num(0),
-    // WHDC_num(0),
-    // WHDM_num(0),
-    NJC_num(0),
-    WHJC_num(0),
-    WHD_count(0),
-    DM_num(0),
-    Flag_Count_num(0),
-    send_ID(null_list),
-    recv_ID(null_list),
-    m_routing_time_count(0)
-
+    m_sid (0)
 {
   NS_LOG_FUNCTION (this);
   Construct ();
@@ -143,245 +124,6 @@ Node::GetSystemId (void) const
   return m_sid;
 }
 
-void
-Node::SetRREQ(int req)
-{
-    RREQ_num = req;
-}
-
-int
-Node::GetRREQ() const
-{
-    return RREQ_num;
-}
-
-void
-Node::SetRREP(int rep)
-{
-    RREP_num = rep;
-}
-
-int
-Node::GetRREP() const
-{
-    return RREP_num;
-}
-
-void
-Node::SetWHC(int whc)
-{
-    WHC_num = whc;
-}
-
-int
-Node::GetWHC() const
-{
-    return WHC_num;
-}
-
-void
-Node::SetWHE(int whe)
-{
-    WHE_num = whe;
-}
-
-int
-Node::GetWHE() const
-{
-    return WHE_num;
-}
-
-void
-Node::SetDetCount(int cou)
-{
-  DC_num = cou;
-}
-
-int
-Node::GetDetCount()
-{
-  return DC_num;
-}
-
-//検知率に関する関数
-
-//-----------------------------------------------------------------------------
-//通常ノードを判定した回数
-void 
-Node::Set_Nomal_Node_Judge_Count(int de)
-{
-    NJC_num = de;
-}
-
-int
-Node::Get_Nomal_Node_Judge_Count() const
-{
-    return NJC_num;
-}
-//------------------------------------------------------------------------------
-
-//----------------------------------------------------------------------------
-//WH攻撃を対象とした検知回数
-void
-Node::Set_WHJudge_Count(int whdc)
-{
-    WHJC_num = whdc;
-}
-
-int
-Node::Get_WHJudge_Count() const
-{
-    return WHJC_num;
-}
-//------------------------------------------------------------------------------
-
-//----------------------------------------------------------------------------
-//WH攻撃を正常であると検知した回数
-void
-Node::Set_WHDetection_miss_Count(int whd)
-{
-    WHD_count = whd;
-}
-
-int
-Node::Get_WHDetection_miss_Count() const
-{
-    return WHD_count;
-}
-//------------------------------------------------------------------------------
-
-//----------------------------------------------------------------------------
-//正常なリンクをWHリンクと誤検知した回数
-void
-Node::Set_Detection_miss_Count(int dm)
-{
-    DM_num = dm;
-}
-
-int
-Node::Get_Detecstion_miss_Count() const
-{
-    return DM_num;
-}
-//-------------------------------------------------------------------------------
-
-
-//------------------------------------------------------------------------------
-//経路作成時間を保持する変数
-void
-Node::Set_Routing_Time(Time t)
-{
-    m_routing_time.push_back(t);
-}
-
-std::vector<Time>
-Node::Get_Routing_Time() const
-{
-    return m_routing_time;
-}
-//------------------------------------------------------------------------------
-
-//------------------------------------------------------------------------------
-//経路作成時間を計測した回数
-void
-Node::Increment_Routing_Time_Count()
-{
-    m_routing_time_count++;
-}
-
-uint32_t
-Node::Get_Routing_Time_Count() const
-{
-    return m_routing_time_count;
-}
-//------------------------------------------------------------------------------
-
-// void 
-// Node::SetDetectionEnd(int de)
-// {
-//     DE_num = de;
-// }
-
-// int
-// Node::GetDetectionEnd() const
-// {
-//     return DE_num;
-// }
-
-// void
-// Node::SetWHDetection(int whdc)
-// {
-//     WHDC_num = whdc;
-// }
-
-// int
-// Node::GetWHDetection() const
-// {
-//     return WHDC_num;
-// }
-
-// void
-// Node::SetWHDetection_miss(int whdm)
-// {
-//     WHDM_num = whdm;
-// }
-
-// int
-// Node::GetWHDetection_miss() const
-// {
-//     return WHDM_num;
-// }
-
-// void
-// Node::SetDetection_miss(int dm)
-// {
-//     DM_num = dm;
-// }
-
-// int
-// Node::GetDetecstion_miss() const
-// {
-//     return DM_num;
-// }
-
-// void
-// Node::SetFlag_Count(int flag)
-// {
-//     Flag_Count_num = flag;
-// }
-
-// int
-// Node::GetFlag_Count() const
-// {
-//     return Flag_Count_num;
-// }
-
-//送信した検知メッセージのID
-void
-Node::AddSendID(uint32_t s_id)
-{
-  send_ID.push_back(s_id);
-}
-
-std::vector<uint32_t> 
-Node::GetSendID() const
-{
-  return send_ID;
-}
-
-//受信した検知メッセージのID
-void
-Node::AddRecvID(uint32_t r_id)
-{
-  recv_ID.push_back(r_id);
-}
-
-std::vector<uint32_t>
-Node::GetRecvID() const
-{
-  return recv_ID;
-}
-
 uint32_t
 Node::AddDevice (Ptr<NetDevice> device)
 {
@@ -99,99 +99,6 @@ public:
 
     std::string Getfile() const;
 
-    void SetRREQ(int req);
-
-    int GetRREQ() const;
-
-    void SetRREP(int rep);
-
-    int GetRREP() const;
-
-    void SetWHC(int whc);
-
-    int GetWHC() const;
-
-    void SetWHE(int whe);
-
-    int GetWHE() const;
-
-    void SetDetCount(int cou);
-
-    int GetDetCount();
-
-    /*
-      検知率に関するデータ取得用関数
-    */
-
-    //通常ノードを判定した回数
-    void Set_Nomal_Node_Judge_Count(int de);
-
-    //通常ノードを判定した回数を取得する関数
-    int Get_Nomal_Node_Judge_Count() const;
-
-    //WH攻撃を対象とした検知回数
-    void Set_WHJudge_Count(int whdc);
-    
-    int Get_WHJudge_Count() const;
-
-    //WH攻撃を正常に検知した回数
-    void Set_WHDetection_miss_Count(int whdm);
-
-    int Get_WHDetection_miss_Count() const;
-
-    //正常なリンクをWHリンクと誤検知した回数
-    void Set_Detection_miss_Count(int dm);
-
-    int Get_Detecstion_miss_Count() const;
-
-    //経路作成時間を保持する変数
-    void Set_Routing_Time(Time t);
-
-    std::vector<Time> Get_Routing_Time() const;
-
-    //経路作成時間を計測した回数
-    void Increment_Routing_Time_Count();
-
-    uint32_t Get_Routing_Time_Count() const;
-
-
-
-    // //すべての検知回数を保存する関数
-    // void SetDetectionEnd(int de);
-
-    // //すべての検知回数を参照する関数
-    // int GetDetectionEnd() const;
-
-    // //WH攻撃を対象とした検知回数
-    // void SetWHDetection(int whdc);
-    
-    // int GetWHDetection() const;
-
-    // //WH攻撃を正常であると検知した回数
-    // void SetWHDetection_miss(int whdm);
-
-    // int GetWHDetection_miss() const;
-
-    // //正常なリンクをWHリンクと誤検知した回数
-    // void SetDetection_miss(int dm);
-
-    // int GetDetecstion_miss() const;
-
-    // //WHを検知しようとした回数をカウントする変数
-    // void SetFlag_Count(int flag);
-
-    // int GetFlag_Count() const;
-
-    //送信したID
-    void AddSendID(uint32_t s_id);
-
-    std::vector<uint32_t> GetSendID() const;
-
-    //受信したID
-    void AddRecvID(uint32_t s_id);
-
-    std::vector<uint32_t> GetRecvID() const;
-
   /**
    * \brief Associate a NetDevice to this node.
    *
@@ -386,46 +293,6 @@ private:
   std::vector<Ptr<Application> > m_applications; //!< Applications associated to this node
   ProtocolHandlerList m_handlers; //!< Protocol handlers in the node
   DeviceAdditionListenerList m_deviceAdditionListeners; //!< Device addition listeners in the node
-
-  //追加部分
-  int RREQ_num;
-  int RREP_num;
-  int WHC_num;
-  int WHE_num;
-  int DC_num;
-
-  //検知率に関する変数
-     //通常ノードを判定した回数
-    int NJC_num;
-
-    //WH攻撃を対象とした検知回数
-    int WHJC_num;
-
-    //WH攻撃を正常に検知した回数
-    int WHD_count;
-
-    //正常なリンクをWHリンクと誤検知した回数
-    int DM_num;
-
-    //WHを検知しようとした回数をカウントする変数
-    int Flag_Count_num;
-
-    //正常にWH攻撃を検知した回数
-    int Detection_WH;
-
-    //WHを検知しようとした回数をカウントする変数
-    //int Flag_Count_num;
-
-    //送信した検知メッセージのID
-    std::vector<uint32_t> send_ID;
-    //受信した検知メッセージのID
-    std::vector<uint32_t> recv_ID;
-
-    //経路作成時間を保持する変数
-    std::vector<Time> m_routing_time;
-
-    //経路作成時間を計測した回数
-    uint32_t m_routing_time_count;
 };
 
 } // namespace ns3
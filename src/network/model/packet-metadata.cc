@@ -34,19 +34,8 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
-
-PacketMetadata::DataFreeList::~DataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (iterator i = begin (); i != end (); i++)
-    {
-      PacketMetadata::Deallocate (*i);
-    }
-  PacketMetadata::m_enable = false;
-}
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
 
 void 
 PacketMetadata::Enable (void)
@@ -575,10 +564,9 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  struct PacketMetadata::Data *data;
+  while ((data = DataFreeList::Get ()) != 0)
     {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
       if (data->m_size >= size) 
         {
           NS_LOG_LOGIC ("create found size="<<data->m_size);
@@ -601,16 +589,16 @@ PacketMetadata::Recycle (struct PacketMetadata::Data *data)
       PacketMetadata::Deallocate (data);
       return;
     } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
+  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<DataFreeList::GetLocalSize ());
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
-      data->m_size < m_maxSize) 
+  if (data->m_size < m_maxSize) 
     {
       PacketMetadata::Deallocate (data);
     } 
   else 
     {
-      m_freeList.push_back (data);
+      // once the free lists are destroyed at exit, Put deallocates directly
+      DataFreeList::Put (data);
     }
 }
 
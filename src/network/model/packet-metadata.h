@@ -27,6 +27,7 @@
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
 #include "buffer.h"
+#include "thread-free-list.h"
 
 namespace ns3 {
 
@@ -494,16 +495,6 @@ private:
     uint64_t packetUid;
   };
 
-  /**
-   * \brief Class to hold all the metadata
-   */
-  class DataFreeList : public std::vector<struct Data *>
-  {
-public:
-    ~DataFreeList ();
-  };
-
-  friend DataFreeList::~DataFreeList ();
   /// Friend class
   friend class ItemIterator;
 
@@ -661,7 +652,9 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  /// Container for the metadata data storage, per thread
+  typedef ThreadFreeList<struct PacketMetadata::Data, &PacketMetadata::Deallocate> DataFreeList;
+
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -672,8 +665,8 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size, per thread
+  static thread_local uint16_t m_chunkUid; //!< Chunk Uid, per thread
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -19,16 +19,61 @@
  */
 #include "packet.h"
 #include "ns3/assert.h"
+#include "ns3/abort.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include <string>
+#include <vector>
 #include <cstdarg>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+std::atomic<uint32_t> Packet::m_globalUid (0);
+
+// Keep the memory of the deleted packets in a free list, the packet test
+// suite checks that it is reused
+#define PACKET_FREE_LIST 1
+
+void
+Packet::FreeMemory (void *p)
+{
+  ::operator delete (p);
+}
+
+void *
+Packet::operator new (size_t size)
+{
+#ifdef PACKET_FREE_LIST
+  if (size == sizeof (Packet))
+    {
+      void *p = FreeList::Get ();
+      if (p != 0)
+        {
+          return p;
+        }
+    }
+#endif /* PACKET_FREE_LIST */
+  return ::operator new (size);
+}
+
+void
+Packet::operator delete (void *p, size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+#ifdef PACKET_FREE_LIST
+  if (size == sizeof (Packet))
+    {
+      FreeList::Put (p);
+      return;
+    }
+#endif /* PACKET_FREE_LIST */
+  ::operator delete (p);
+}
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -126,6 +171,45 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // Serialize covers the buffer, the metadata and the nix vector
+  std::vector<uint8_t> buffer (GetSerializedSize ());
+  Serialize (buffer.data (), buffer.size ());
+  Ptr<Packet> p = Ptr<Packet> (new Packet (buffer.data (), buffer.size (), true), false);
+
+  // but not the tags, which are copied one by one
+  PacketTagIterator pi = GetPacketTagIterator ();
+  while (pi.HasNext ())
+    {
+      PacketTagIterator::Item item = pi.Next ();
+      NS_ABORT_MSG_UNLESS (item.GetTypeId ().HasConstructor (),
+                           "Tag " << item.GetTypeId ().GetName () << " has no constructor and cannot be copied");
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT (tag != 0);
+      item.GetTag (*tag);
+      p->AddPacketTag (*tag);
+      delete tag;
+    }
+  ByteTagIterator bi = GetByteTagIterator ();
+  while (bi.HasNext ())
+    {
+      ByteTagIterator::Item item = bi.Next ();
+      NS_ABORT_MSG_UNLESS (item.GetTypeId ().HasConstructor (),
+                           "Tag " << item.GetTypeId ().GetName () << " has no constructor and cannot be copied");
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT (tag != 0);
+      item.GetTag (*tag);
+      p->AddByteTag (*tag, item.GetStart (), item.GetEnd ());
+      delete tag;
+    }
+  return p;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -136,10 +220,9 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid++, 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -178,10 +261,9 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid++, size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -204,10 +286,9 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid++, size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -34,6 +34,8 @@
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
 #include "ns3/deprecated.h"
+#include "thread-free-list.h"
+#include <atomic>
 
 namespace ns3 {
 
@@ -248,6 +250,26 @@ public:
    * \return the copied object
    */
   Packet &operator = (const Packet &o);
+  /**
+   * \brief Allocate a packet, reusing the memory of a deleted packet
+   * if any.
+   *
+   * Packets are created and deleted at a high rate, once per hop and
+   * per receiver, and all have the same size: the memory of the
+   * deleted packets is kept in a per thread free list, like the data of
+   * the buffers.  The free list is enabled by PACKET_FREE_LIST in
+   * packet.cc.
+   *
+   * \param size the size of the object
+   * \returns the memory of the packet
+   */
+  static void * operator new (size_t size);
+  /**
+   * \brief Keep the memory of a deleted packet in the free list.
+   * \param p the memory of the packet
+   * \param size the size of the object
+   */
+  static void operator delete (void *p, size_t size);
   /**
    * \brief Create a packet with a zero-filled payload.
    *
@@ -453,6 +475,19 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a deep copy of the packet.
+   *
+   * \returns a copy of the packet, tags included, which shares no
+   * dataset with the original packet.
+   *
+   * Unlike the COW copy returned by Copy, the two packets may then be
+   * used concurrently from different threads (see the multithreaded
+   * simulator).  The copy keeps the uid of the original packet.  Every
+   * tag of the packet must register a constructor in its TypeId.
+   */
+  Ptr<Packet> DeepCopy (void) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -787,7 +822,15 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
+
+  /**
+   * \brief Free the memory of a deleted packet for good.
+   * \param p the memory
+   */
+  static void FreeMemory (void *p);
+  /// Container for the memory of deleted packets, per thread
+  typedef ThreadFreeList<void, &Packet::FreeMemory> FreeList;
 };
 
 /**
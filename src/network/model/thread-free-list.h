@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef THREAD_FREE_LIST_H
+#define THREAD_FREE_LIST_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Free list of recycled objects, per thread, with a global overflow.
+ *
+ * The packet data structures (Buffer data, PacketMetadata data, byte
+ * tags, Packet objects) are recycled at a high rate.  Each thread keeps
+ * its own free list, used without any lock, so that the threads of the
+ * multithreaded simulator and independent simulations run on different
+ * threads of one process neither race nor contend.
+ *
+ * When the free list of a thread is full, a batch of objects moves to a
+ * global overflow list, guarded by a mutex; a thread whose free list is
+ * empty takes a batch from it before allocating.  The objects a thread
+ * holds when it exits move to the global list, the global list is freed
+ * at the end of the process.  Afterwards, the objects are freed at once.
+ *
+ * \tparam T \explicit The type of the objects.
+ * \tparam DELETE \explicit The function freeing an object for good.
+ */
+template <typename T, void (*DELETE)(T *)>
+class ThreadFreeList
+{
+public:
+  /** Capacity of the free list of a thread. */
+  static const std::size_t LOCAL_SIZE = 1000;
+  /** Objects moved at once between a thread and the global list. */
+  static const std::size_t BATCH_SIZE = 250;
+  /** Capacity of the global list. */
+  static const std::size_t GLOBAL_SIZE = 16 * LOCAL_SIZE;
+
+  /**
+   * Take an object from the free list.
+   *
+   * \returns the last object recycled by this thread, or an object of
+   * the global list, or null when both are empty
+   */
+  static T *Get (void);
+  /**
+   * Recycle an object, freed for good if all the lists are full.
+   *
+   * \param object the object
+   */
+  static void Put (T *object);
+  /**
+   * \returns the number of objects in the free list of this thread
+   */
+  static std::size_t GetLocalSize (void);
+  /**
+   * \returns the number of objects in the global list
+   */
+  static std::size_t GetGlobalSize (void);
+
+private:
+  /** The global list. */
+  struct Global
+  {
+    ~Global ();
+    std::mutex mutex;          //!< Guards the objects
+    std::vector<T *> objects;  //!< Objects not held by any thread
+  };
+  /** Moves the objects of a thread to the global list when it exits. */
+  struct Releaser
+  {
+    ~Releaser ();
+  };
+
+  /**
+   * \returns the free list of this thread, null once the thread has
+   * released it
+   */
+  static std::vector<T *> *GetLocal (void);
+  /** \returns the global list, constructed on first use */
+  static Global &GetGlobal (void);
+  /**
+   * Move objects to the global list, or free them if it is full.
+   *
+   * \param objects the objects to move
+   * \param n the number of objects to move, from the end
+   */
+  static void Spill (std::vector<T *> &objects, std::size_t n);
+
+  static thread_local std::vector<T *> *t_local;  //!< Free list of this thread
+  static thread_local bool t_released;            //!< Thread is exiting
+  static thread_local Releaser t_releaser;        //!< Releases t_local
+  static bool g_destroyed;                        //!< Global list freed
+};
+
+template <typename T, void (*DELETE)(T *)>
+thread_local std::vector<T *> *ThreadFreeList<T, DELETE>::t_local = 0;
+template <typename T, void (*DELETE)(T *)>
+thread_local bool ThreadFreeList<T, DELETE>::t_released = false;
+template <typename T, void (*DELETE)(T *)>
+thread_local typename ThreadFreeList<T, DELETE>::Releaser ThreadFreeList<T, DELETE>::t_releaser;
+template <typename T, void (*DELETE)(T *)>
+bool ThreadFreeList<T, DELETE>::g_destroyed = false;
+
+template <typename T, void (*DELETE)(T *)>
+ThreadFreeList<T, DELETE>::Global::~Global ()
+{
+  for (typename std::vector<T *>::iterator i = objects.begin (); i != objects.end (); ++i)
+    {
+      DELETE (*i);
+    }
+  objects.clear ();
+  g_destroyed = true;
+}
+
+template <typename T, void (*DELETE)(T *)>
+ThreadFreeList<T, DELETE>::Releaser::~Releaser ()
+{
+  if (t_local != 0)
+    {
+      Spill (*t_local, t_local->size ());
+      delete t_local;
+      t_local = 0;
+    }
+  t_released = true;
+}
+
+template <typename T, void (*DELETE)(T *)>
+std::vector<T *> *
+ThreadFreeList<T, DELETE>::GetLocal (void)
+{
+  if (t_local == 0 && !t_released)
+    {
+      t_local = new std::vector<T *> ();
+      t_local->reserve (LOCAL_SIZE);
+      // the first use of the releaser registers its destructor for this thread
+      (void) &t_releaser;
+    }
+  return t_local;
+}
+
+template <typename T, void (*DELETE)(T *)>
+typename ThreadFreeList<T, DELETE>::Global &
+ThreadFreeList<T, DELETE>::GetGlobal (void)
+{
+  static Global global;
+  return global;
+}
+
+template <typename T, void (*DELETE)(T *)>
+void
+ThreadFreeList<T, DELETE>::Spill (std::vector<T *> &objects, std::size_t n)
+{
+  std::size_t first = objects.size () - n;
+  if (!g_destroyed)
+    {
+      Global &global = GetGlobal ();
+      std::lock_guard<std::mutex> lock (global.mutex);
+      while (objects.size () > first && global.objects.size () < GLOBAL_SIZE)
+        {
+          global.objects.push_back (objects.back ());
+          objects.pop_back ();
+        }
+    }
+  while (objects.size () > first)
+    {
+      DELETE (objects.back ());
+      objects.pop_back ();
+    }
+}
+
+template <typename T, void (*DELETE)(T *)>
+T *
+ThreadFreeList<T, DELETE>::Get (void)
+{
+  std::vector<T *> *local = GetLocal ();
+  if (local != 0 && !local->empty ())
+    {
+      T *object = local->back ();
+      local->pop_back ();
+      return object;
+    }
+  if (g_destroyed)
+    {
+      return 0;
+    }
+  Global &global = GetGlobal ();
+  std::lock_guard<std::mutex> lock (global.mutex);
+  if (global.objects.empty ())
+    {
+      return 0;
+    }
+  T *object = global.objects.back ();
+  global.objects.pop_back ();
+  for (std::size_t i = 1; local != 0 && i < BATCH_SIZE && !global.objects.empty (); ++i)
+    {
+      local->push_back (global.objects.back ());
+      global.objects.pop_back ();
+    }
+  return object;
+}
+
+template <typename T, void (*DELETE)(T *)>
+void
+ThreadFreeList<T, DELETE>::Put (T *object)
+{
+  std::vector<T *> *local = GetLocal ();
+  if (local == 0)
+    {
+      std::vector<T *> objects (1, object);
+      Spill (objects, 1);
+      return;
+    }
+  if (local->size () >= LOCAL_SIZE)
+    {
+      Spill (*local, BATCH_SIZE);
+    }
+  local->push_back (object);
+}
+
+template <typename T, void (*DELETE)(T *)>
+std::size_t
+ThreadFreeList<T, DELETE>::GetLocalSize (void)
+{
+  return t_local == 0 ? 0 : t_local->size ();
+}
+
+template <typename T, void (*DELETE)(T *)>
+std::size_t
+ThreadFreeList<T, DELETE>::GetGlobalSize (void)
+{
+  if (g_destroyed)
+    {
+      return 0;
+    }
+  Global &global = GetGlobal ();
+  std::lock_guard<std::mutex> lock (global.mutex);
+  return global.objects.size ();
+}
+
+} // namespace ns3
+
+#endif /* THREAD_FREE_LIST_H */
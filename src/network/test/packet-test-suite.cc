@@ -21,6 +21,10 @@
 #include "ns3/packet-tag-list.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
+#include "ns3/system-thread.h"
+#include "ns3/thread-free-list.h"
+#include <atomic>
+#include <cstring>
 #include <limits>     // std:numeric_limits
 #include <string>
 #include <cstdarg>
@@ -1035,6 +1039,176 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet free list unit tests.
+ */
+class PacketFreeListTest : public TestCase
+{
+public:
+  PacketFreeListTest ();
+private:
+  void DoRun (void);
+};
+
+PacketFreeListTest::PacketFreeListTest ()
+  : TestCase ("Packet free list")
+{
+}
+
+void
+PacketFreeListTest::DoRun (void)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddPacketTag (ATestTag<1> ());
+  Ptr<Packet> copy = p->Copy ();
+  Packet *memory = PeekPointer (copy);
+  copy = 0;
+  Ptr<Packet> q = Create<Packet> (10);
+  NS_TEST_EXPECT_MSG_EQ (PeekPointer (q), memory, "Deleted packet not recycled");
+  // a recycled packet starts from scratch
+  NS_TEST_EXPECT_MSG_EQ (q->GetSize (), 10, "Wrong size");
+  NS_TEST_EXPECT_MSG_NE (q->GetUid (), p->GetUid (), "Uid reused");
+  ATestTag<1> tag;
+  NS_TEST_EXPECT_MSG_EQ (q->PeekPacketTag (tag), false, "Tag of the deleted packet");
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (tag), true, "Tag lost by the original");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Per thread free lists unit tests.
+ */
+class ThreadFreeListTest : public TestCase
+{
+public:
+  ThreadFreeListTest ();
+private:
+  void DoRun (void);
+  /**
+   * Free an object of the test list for good.
+   * \param object the object
+   */
+  static void Free (uint32_t *object);
+  /**
+   * Recycle objects, from another thread.
+   * \param n the number of objects
+   */
+  static void PutObjects (uint32_t n);
+  /**
+   * Release packets created by another thread, then create, copy,
+   * fragment and release packets, from another thread.
+   * \param packets the packets to release
+   * \param ok set to false on error
+   */
+  static void UsePackets (std::vector<Ptr<Packet> > *packets, bool *ok);
+
+  /// The free list under test
+  typedef ThreadFreeList<uint32_t, &ThreadFreeListTest::Free> TestList;
+  static std::atomic<uint32_t> g_freed; //!< Number of objects freed
+};
+
+std::atomic<uint32_t> ThreadFreeListTest::g_freed (0);
+
+ThreadFreeListTest::ThreadFreeListTest ()
+  : TestCase ("Per thread free lists")
+{
+}
+
+void
+ThreadFreeListTest::Free (uint32_t *object)
+{
+  delete object;
+  g_freed++;
+}
+
+void
+ThreadFreeListTest::PutObjects (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      TestList::Put (new uint32_t (i));
+    }
+}
+
+void
+ThreadFreeListTest::UsePackets (std::vector<Ptr<Packet> > *packets, bool *ok)
+{
+  packets->clear ();
+  uint8_t data[200];
+  for (uint32_t i = 0; i < sizeof (data); i++)
+    {
+      data[i] = i;
+    }
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      uint32_t size = 1 + i % sizeof (data);
+      Ptr<Packet> p = Create<Packet> (data, size);
+      p->AddHeader (ATestHeader<10> ());
+      p->AddPacketTag (ATestTag<1> ());
+      p->AddByteTag (ATestTag<2> ());
+      Ptr<Packet> copy = p->Copy ();
+      ATestHeader<10> header;
+      copy->RemoveHeader (header);
+      Ptr<Packet> fragment = copy->CreateFragment (0, (size + 1) / 2);
+      uint8_t out[200];
+      fragment->CopyData (out, fragment->GetSize ());
+      ATestTag<1> tag;
+      *ok = *ok && copy->GetSize () == size && fragment->GetSize () == (size + 1) / 2
+        && memcmp (out, data, fragment->GetSize ()) == 0
+        && copy->PeekPacketTag (tag) && p->GetSize () == size + 10;
+    }
+}
+
+void
+ThreadFreeListTest::DoRun (void)
+{
+  // the objects recycled by a thread move to the global list when it exits
+  uint32_t global = TestList::GetGlobalSize ();
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&ThreadFreeListTest::PutObjects, 1200));
+  thread->Start ();
+  thread->Join ();
+  NS_TEST_EXPECT_MSG_EQ (TestList::GetGlobalSize (), global + 1200, "Objects of the thread not released");
+  NS_TEST_EXPECT_MSG_EQ (g_freed.load (), 0, "Objects freed instead of recycled");
+  // and a batch of them is taken by the next thread which needs one
+  uint32_t *object = TestList::Get ();
+  NS_TEST_ASSERT_MSG_NE (object, 0, "No object taken from the global list");
+  NS_TEST_EXPECT_MSG_EQ (TestList::GetLocalSize (), TestList::BATCH_SIZE - 1, "Wrong batch");
+  NS_TEST_EXPECT_MSG_EQ (TestList::GetGlobalSize (), global + 1200 - TestList::BATCH_SIZE, "Wrong batch");
+  TestList::Put (object);
+
+  // packets created, copied and released concurrently, including packets
+  // created by another thread; the types are registered beforehand
+  ATestHeader<10>::GetTypeId ();
+  ATestTag<1>::GetTypeId ();
+  ATestTag<2>::GetTypeId ();
+  const uint32_t nThreads = 4;
+  std::vector<Ptr<Packet> > packets[nThreads];
+  bool ok[nThreads];
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      for (uint32_t j = 0; j < 500; j++)
+        {
+          packets[i].push_back (Create<Packet> (j));
+        }
+      ok[i] = true;
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&ThreadFreeListTest::UsePackets, &packets[i], &ok[i])));
+    }
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      threads[i]->Start ();
+    }
+  for (uint32_t i = 0; i < nThreads; i++)
+    {
+      threads[i]->Join ();
+      NS_TEST_EXPECT_MSG_EQ (ok[i], true, "Wrong packet in thread " << i);
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1226,8 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketFreeListTest, TestCase::QUICK);
+  AddTestCase (new ThreadFreeListTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -25,6 +25,7 @@
 #include <ostream>
 #include "ns3/address.h"
 #include "ns3/attribute-helper.h"
+#include "ns3/binary-log.h"
 
 namespace ns3 {
 
@@ -428,6 +429,19 @@ bool operator == (Ipv4Mask const &a, Ipv4Mask const &b);
  */
 bool operator != (Ipv4Mask const &a, Ipv4Mask const &b);
 
+/**
+ * \brief Encode an address for NS_BINLOG.
+ *
+ * \param address the address
+ * \returns the encoded address, printed in dotted notation when decoded
+ */
+inline BinaryLogArg
+BinaryLogEncode (Ipv4Address address)
+{
+  BinaryLogArg arg = { BinaryLogArg::IPV4, address.Get () };
+  return arg;
+}
+
 } // namespace ns3
 
 #endif /* IPV4_ADDRESS_H */
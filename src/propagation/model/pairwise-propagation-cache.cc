@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pairwise-propagation-cache.h"
+#include "propagation-loss-model.h"
+#include "propagation-delay-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/callback.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PairwisePropagationCache");
+
+PairwisePropagationCache::PairwisePropagationCache ()
+  : m_lastGeneration (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PairwisePropagationCache::~PairwisePropagationCache ()
+{
+  NS_LOG_FUNCTION (this);
+  Disconnect ();
+}
+
+void
+PairwisePropagationCache::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
+{
+  NS_LOG_FUNCTION (this << loss);
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  m_loss = loss;
+  for (uint32_t i = 0; i < m_generation.size (); i++)
+    {
+      Renew (i);
+    }
+}
+
+void
+PairwisePropagationCache::SetPropagationDelayModel (Ptr<PropagationDelayModel> delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  m_delay = delay;
+  for (uint32_t i = 0; i < m_generation.size (); i++)
+    {
+      Renew (i);
+    }
+}
+
+uint32_t
+PairwisePropagationCache::Add (Ptr<MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  uint32_t i = m_mobility.size ();
+  m_mobility.push_back (mobility);
+  m_generation.push_back (0);
+  Renew (i);
+  if (mobility != 0)
+    {
+      std::vector<uint32_t> &nodes = m_nodesByMobility[PeekPointer (mobility)];
+      if (nodes.empty ())
+        {
+          mobility->TraceConnectWithoutContext ("CourseChange",
+                                                MakeCallback (&PairwisePropagationCache::CourseChanged, this));
+        }
+      nodes.push_back (i);
+    }
+  // the entries are laid out for the former number of nodes
+  m_entries.clear ();
+  return i;
+}
+
+uint32_t
+PairwisePropagationCache::GetN (void) const
+{
+  return m_mobility.size ();
+}
+
+void
+PairwisePropagationCache::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  Disconnect ();
+  m_mobility.clear ();
+  m_generation.clear ();
+  m_entries.clear ();
+}
+
+void
+PairwisePropagationCache::Disconnect (void)
+{
+  for (std::unordered_map<const MobilityModel *, std::vector<uint32_t> >::const_iterator i = m_nodesByMobility.begin ();
+       i != m_nodesByMobility.end (); ++i)
+    {
+      m_mobility[i->second.front ()]->TraceDisconnectWithoutContext (
+        "CourseChange", MakeCallback (&PairwisePropagationCache::CourseChanged, this));
+    }
+  m_nodesByMobility.clear ();
+}
+
+void
+PairwisePropagationCache::Renew (uint32_t i)
+{
+  Ptr<MobilityModel> mobility = m_mobility[i];
+  if (mobility == 0 || mobility->GetVelocity ().GetLength () > 0)
+    {
+      m_generation[i] = 0;
+      return;
+    }
+  m_lastGeneration++;
+  if (m_lastGeneration == 0)
+    {
+      // after a wrap around, old entries could match again
+      m_entries.clear ();
+      m_lastGeneration++;
+    }
+  m_generation[i] = m_lastGeneration;
+}
+
+void
+PairwisePropagationCache::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  std::unordered_map<const MobilityModel *, std::vector<uint32_t> >::const_iterator it =
+    m_nodesByMobility.find (PeekPointer (mobility));
+  if (it == m_nodesByMobility.end ())
+    {
+      return;
+    }
+  for (std::vector<uint32_t>::const_iterator i = it->second.begin (); i != it->second.end (); ++i)
+    {
+      Renew (*i);
+    }
+}
+
+void
+PairwisePropagationCache::Invalidate (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  NS_ASSERT (i < m_generation.size ());
+  Renew (i);
+}
+
+PairwisePropagationCache::Entry *
+PairwisePropagationCache::Lookup (uint32_t a, uint32_t b)
+{
+  NS_ASSERT (a < m_generation.size () && b < m_generation.size ());
+  uint32_t generationA = m_generation[a];
+  uint32_t generationB = m_generation[b];
+  if (generationA == 0 || generationB == 0)
+    {
+      return 0;
+    }
+  std::size_t n = m_generation.size ();
+  if (m_entries.empty ())
+    {
+      NS_LOG_DEBUG ("allocate " << n << "x" << n << " entries");
+      Entry none = { 0, 0, -1, 0, 0 };
+      m_entries.assign (n * n, none);
+    }
+  Entry &entry = m_entries[a * n + b];
+  if (entry.generationA != generationA || entry.generationB != generationB)
+    {
+      entry.txPowerDbm = std::numeric_limits<double>::quiet_NaN ();
+      entry.delay = -1;
+      entry.generationA = generationA;
+      entry.generationB = generationB;
+    }
+  return &entry;
+}
+
+double
+PairwisePropagationCache::CalcRxPower (double txPowerDbm, uint32_t a, uint32_t b)
+{
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  Entry *entry = Lookup (a, b);
+  // NaN, the tx power of an empty entry, matches no tx power
+  if (entry != 0 && entry->txPowerDbm == txPowerDbm)
+    {
+      return entry->rxPowerDbm;
+    }
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, m_mobility[a], m_mobility[b]);
+  if (entry != 0)
+    {
+      entry->txPowerDbm = txPowerDbm;
+      entry->rxPowerDbm = rxPowerDbm;
+    }
+  return rxPowerDbm;
+}
+
+Time
+PairwisePropagationCache::GetDelay (uint32_t a, uint32_t b)
+{
+#ifdef NS3_MTP
+  CriticalSection cs (m_mutex);
+#endif
+  Entry *entry = Lookup (a, b);
+  if (entry != 0 && entry->delay >= 0)
+    {
+      return TimeStep (entry->delay);
+    }
+  Time delay = m_delay->GetDelay (m_mobility[a], m_mobility[b]);
+  if (entry != 0)
+    {
+      entry->delay = delay.GetTimeStep ();
+    }
+  return delay;
+}
+
+} // namespace ns3
@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PAIRWISE_PROPAGATION_CACHE_H
+#define PAIRWISE_PROPAGATION_CACHE_H
+
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/core-config.h"
+#ifdef NS3_MTP
+#include "ns3/system-mutex.h"
+#endif
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+class MobilityModel;
+class PropagationLossModel;
+class PropagationDelayModel;
+
+/**
+ * \ingroup propagation
+ * \brief Dense cache of the received power and propagation delay between
+ * every pair of nodes.
+ *
+ * The nodes are numbered in the order they are added, e.g. by the PHY
+ * index of a channel.  For every ordered pair, the cache keeps the last
+ * received power computed by a PropagationLossModel chain, along with the
+ * transmission power it was computed for, and the delay computed by a
+ * PropagationDelayModel, in a flat array of n x n entries allocated on
+ * the first lookup.
+ *
+ * The cache listens to the CourseChange trace of the mobility models.  A
+ * course change invalidates every entry of the node in constant time, by
+ * giving the node a new generation number which the entries no longer
+ * match.  The nodes moving with a non-zero velocity, or without a mobility
+ * model, are not cached, so that static and slowly moving scenarios
+ * compute each link once per course change.
+ *
+ * Only deterministic models may be cached: the draws of random models,
+ * e.g. Nakagami fading or RandomPropagationDelayModel, would be frozen.
+ */
+class PairwisePropagationCache
+{
+public:
+  PairwisePropagationCache ();
+  ~PairwisePropagationCache ();
+
+  /**
+   * Set the loss model, and forget the cached received powers.
+   *
+   * \param loss the propagation loss model, may be the head of a chain
+   */
+  void SetPropagationLossModel (Ptr<PropagationLossModel> loss);
+  /**
+   * Set the delay model, and forget the cached delays.
+   *
+   * \param delay the propagation delay model
+   */
+  void SetPropagationDelayModel (Ptr<PropagationDelayModel> delay);
+
+  /**
+   * Add a node and listen to the course changes of its mobility model.
+   *
+   * \param mobility the mobility model of the node, may be 0
+   * \return the index of the node
+   */
+  uint32_t Add (Ptr<MobilityModel> mobility);
+  /**
+   * \return the number of nodes
+   */
+  uint32_t GetN (void) const;
+  /**
+   * Remove all the nodes and the cached values.  The models are kept.
+   */
+  void Clear (void);
+
+  /**
+   * \param txPowerDbm the transmission power, in dBm
+   * \param a the index of the transmitter
+   * \param b the index of the receiver
+   * \return the received power, in dBm, as computed by the loss model
+   */
+  double CalcRxPower (double txPowerDbm, uint32_t a, uint32_t b);
+  /**
+   * \param a the index of the transmitter
+   * \param b the index of the receiver
+   * \return the propagation delay, as computed by the delay model
+   */
+  Time GetDelay (uint32_t a, uint32_t b);
+  /**
+   * Forget the cached values of a node, e.g. when it moved without
+   * notifying a course change.
+   *
+   * \param i the index of the node
+   */
+  void Invalidate (uint32_t i);
+
+private:
+  /**
+   * Copy constructor, not implemented: the trace sinks are bound to
+   * this object.
+   *
+   * \param o the object to copy
+   */
+  PairwisePropagationCache (const PairwisePropagationCache &o);
+  /**
+   * Assignment operator, not implemented.
+   *
+   * \param o the object to copy
+   * \return this object
+   */
+  PairwisePropagationCache &operator = (const PairwisePropagationCache &o);
+
+  /// Cached values of an ordered pair of nodes
+  struct Entry
+  {
+    double txPowerDbm;                 //!< Tx power of rxPowerDbm, NaN if unknown
+    double rxPowerDbm;                 //!< Received power (dBm)
+    int64_t delay;                     //!< Delay in time steps, negative if unknown
+    uint32_t generationA;              //!< Generation of the transmitter
+    uint32_t generationB;              //!< Generation of the receiver
+  };
+
+  /**
+   * \param a the index of the transmitter
+   * \param b the index of the receiver
+   * \return the entry of the pair, reset if outdated, or 0 if the pair is not cached
+   */
+  Entry *Lookup (uint32_t a, uint32_t b);
+  /**
+   * Give the node a new generation, or none if it moves.
+   *
+   * \param i the index of the node
+   */
+  void Renew (uint32_t i);
+  /**
+   * Invalidate the nodes of a mobility model.
+   *
+   * \param mobility the mobility model whose course changed
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+  /// Disconnect from the mobility models
+  void Disconnect (void);
+
+  Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
+  Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  std::vector<Ptr<MobilityModel> > m_mobility;  //!< Mobility model per node
+  std::vector<uint32_t> m_generation;  //!< Generation per node, 0 if not cached
+  uint32_t m_lastGeneration;           //!< Last generation given to a node
+  std::vector<Entry> m_entries;        //!< The n x n entries, row per transmitter
+  std::unordered_map<const MobilityModel *, std::vector<uint32_t> > m_nodesByMobility; //!< Node indices per mobility model
+#ifdef NS3_MTP
+  SystemMutex m_mutex;                 //!< Serializes the lookups of concurrent threads
+#endif
+};
+
+} // namespace ns3
+
+#endif /* PAIRWISE_PROPAGATION_CACHE_H */
@@ -82,6 +82,57 @@ PropagationLossModel::CalcRxPower (double txPowerDbm,
   return self;
 }
 
+void
+PropagationLossModel::CalcRxPowerBatch (double txPowerDbm,
+                                        Ptr<MobilityModel> a,
+                                        const std::vector<Ptr<MobilityModel> > &b,
+                                        std::vector<double> &rxPowerDbm) const
+{
+  std::size_t n = b.size ();
+  rxPowerDbm.assign (n, txPowerDbm);
+  if (n == 0)
+    {
+      return;
+    }
+  Vector source = a->GetPosition ();
+  BatchGeometry geometry;
+  geometry.sourceHeight = source.z;
+  geometry.height.resize (n);
+  geometry.distance.resize (n);
+  std::vector<double> dx (n);
+  std::vector<double> dy (n);
+  std::vector<double> dz (n);
+  for (std::size_t i = 0; i < n; i++)
+    {
+      Vector position = b[i]->GetPosition ();
+      dx[i] = position.x - source.x;
+      dy[i] = position.y - source.y;
+      dz[i] = position.z - source.z;
+      geometry.height[i] = position.z;
+    }
+  // same operations as MobilityModel::GetDistanceFrom
+  for (std::size_t i = 0; i < n; i++)
+    {
+      geometry.distance[i] = std::sqrt (dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]);
+    }
+  for (const PropagationLossModel *model = this; model != 0; model = PeekPointer (model->m_next))
+    {
+      model->DoCalcRxPowerBatch (a, b, geometry, &rxPowerDbm[0]);
+    }
+}
+
+void
+PropagationLossModel::DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                          const std::vector<Ptr<MobilityModel> > &b,
+                                          const BatchGeometry &geometry,
+                                          double *rxPowerDbm) const
+{
+  for (std::size_t i = 0; i < b.size (); i++)
+    {
+      rxPowerDbm[i] = DoCalcRxPower (rxPowerDbm[i], a, b[i]);
+    }
+}
+
 int64_t
 PropagationLossModel::AssignStreams (int64_t stream)
 {
@@ -271,6 +322,26 @@ FriisPropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm - std::max (lossDb, m_minLoss);
 }
 
+void
+FriisPropagationLossModel::DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                               const std::vector<Ptr<MobilityModel> > &b,
+                                               const BatchGeometry &geometry,
+                                               double *rxPowerDbm) const
+{
+  const double *distances = &geometry.distance[0];
+  std::size_t n = b.size ();
+  double numerator = m_lambda * m_lambda;
+  double minLoss = m_minLoss;
+  double systemLoss = m_systemLoss;
+  for (std::size_t i = 0; i < n; i++)
+    {
+      double distance = distances[i];
+      double denominator = 16 * M_PI * M_PI * distance * distance * systemLoss;
+      double lossDb = -10 * log10 (numerator / denominator);
+      rxPowerDbm[i] -= distance <= 0 ? minLoss : std::max (lossDb, minLoss);
+    }
+}
+
 int64_t
 FriisPropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -445,6 +516,37 @@ TwoRayGroundPropagationLossModel::DoCalcRxPower (double txPowerDbm,
     }
 }
 
+void
+TwoRayGroundPropagationLossModel::DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                                      const std::vector<Ptr<MobilityModel> > &b,
+                                                      const BatchGeometry &geometry,
+                                                      double *rxPowerDbm) const
+{
+  const double *distances = &geometry.distance[0];
+  const double *heights = &geometry.height[0];
+  std::size_t n = b.size ();
+  double lambda = m_lambda;
+  double systemLoss = m_systemLoss;
+  double minDistance = m_minDistance;
+  double txAntHeight = geometry.sourceHeight + m_heightAboveZ;
+  double heightAboveZ = m_heightAboveZ;
+  for (std::size_t i = 0; i < n; i++)
+    {
+      double distance = distances[i];
+      double rxAntHeight = heights[i] + heightAboveZ;
+      double dCross = (4 * M_PI * txAntHeight * rxAntHeight) / lambda;
+      // Friis within the crossover distance
+      double tmp = M_PI * distance;
+      double pr = 10 * std::log10 ((lambda * lambda) / (16 * tmp * tmp * systemLoss));
+      // Two-Ray beyond
+      tmp = txAntHeight * rxAntHeight;
+      double rayNumerator = tmp * tmp;
+      tmp = distance * distance;
+      double rayPr = 10 * std::log10 (rayNumerator / (tmp * tmp * systemLoss));
+      rxPowerDbm[i] += distance <= minDistance ? 0 : (distance <= dCross ? pr : rayPr);
+    }
+}
+
 int64_t
 TwoRayGroundPropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -534,6 +636,26 @@ LogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm + rxc;
 }
 
+void
+LogDistancePropagationLossModel::DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                                     const std::vector<Ptr<MobilityModel> > &b,
+                                                     const BatchGeometry &geometry,
+                                                     double *rxPowerDbm) const
+{
+  const double *distances = &geometry.distance[0];
+  std::size_t n = b.size ();
+  double exponent = m_exponent;
+  double referenceDistance = m_referenceDistance;
+  double referenceLoss = m_referenceLoss;
+  for (std::size_t i = 0; i < n; i++)
+    {
+      double distance = distances[i];
+      double pathLossDb = 10 * exponent * std::log10 (distance / referenceDistance);
+      double rxc = -referenceLoss - pathLossDb;
+      rxPowerDbm[i] += distance <= referenceDistance ? -referenceLoss : rxc;
+    }
+}
+
 int64_t
 LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -636,6 +758,54 @@ ThreeLogDistancePropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return txPowerDbm - pathLossDb;
 }
 
+void
+ThreeLogDistancePropagationLossModel::DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                                          const std::vector<Ptr<MobilityModel> > &b,
+                                                          const BatchGeometry &geometry,
+                                                          double *rxPowerDbm) const
+{
+  const double *distances = &geometry.distance[0];
+  std::size_t n = b.size ();
+  double distance0 = m_distance0;
+  double distance1 = m_distance1;
+  double distance2 = m_distance2;
+  double exponent0 = m_exponent0;
+  double exponent1 = m_exponent1;
+  double exponent2 = m_exponent2;
+  double referenceLoss = m_referenceLoss;
+  // losses at the field boundaries, as summed by DoCalcRxPower
+  double field1 = 10 * exponent0 * std::log10 (distance1 / distance0);
+  double field2 = 10 * exponent1 * std::log10 (distance2 / distance1);
+  for (std::size_t i = 0; i < n; i++)
+    {
+      double distance = distances[i];
+      double pathLossDb;
+      if (distance < distance0)
+        {
+          pathLossDb = 0;
+        }
+      else if (distance < distance1)
+        {
+          pathLossDb = referenceLoss
+            + 10 * exponent0 * std::log10 (distance / distance0);
+        }
+      else if (distance < distance2)
+        {
+          pathLossDb = referenceLoss
+            + field1
+            + 10 * exponent1 * std::log10 (distance / distance1);
+        }
+      else
+        {
+          pathLossDb = referenceLoss
+            + field1
+            + field2
+            + 10 * exponent2 * std::log10 (distance / distance2);
+        }
+      rxPowerDbm[i] -= pathLossDb;
+    }
+}
+
 int64_t
 ThreeLogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -749,6 +919,34 @@ NakagamiPropagationLossModel::DoCalcRxPower (double txPowerDbm,
   return resultPowerDbm;
 }
 
+void
+NakagamiPropagationLossModel::DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                                  const std::vector<Ptr<MobilityModel> > &b,
+                                                  const BatchGeometry &geometry,
+                                                  double *rxPowerDbm) const
+{
+  const double *distances = &geometry.distance[0];
+  std::size_t n = b.size ();
+  // the draws are made in the order of the destinations, as with DoCalcRxPower
+  for (std::size_t i = 0; i < n; i++)
+    {
+      double distance = distances[i];
+      double m = distance < m_distance1 ? m_m0 : (distance < m_distance2 ? m_m1 : m_m2);
+      double powerW = std::pow (10, (rxPowerDbm[i] - 30) / 10);
+      unsigned int int_m = static_cast<unsigned int>(std::floor (m));
+      double resultPowerW;
+      if (int_m == m)
+        {
+          resultPowerW = m_erlangRandomVariable->GetValue (int_m, powerW / m);
+        }
+      else
+        {
+          resultPowerW = m_gammaRandomVariable->GetValue (m, powerW / m);
+        }
+      rxPowerDbm[i] = 10 * std::log10 (resultPowerW) + 30;
+    }
+}
+
 int64_t
 NakagamiPropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -924,6 +1122,21 @@ RangePropagationLossModel::DoCalcRxPower (double txPowerDbm,
     }
 }
 
+void
+RangePropagationLossModel::DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                               const std::vector<Ptr<MobilityModel> > &b,
+                                               const BatchGeometry &geometry,
+                                               double *rxPowerDbm) const
+{
+  const double *distances = &geometry.distance[0];
+  std::size_t n = b.size ();
+  double range = m_range;
+  for (std::size_t i = 0; i < n; i++)
+    {
+      rxPowerDbm[i] = distances[i] <= range ? rxPowerDbm[i] : -1000;
+    }
+}
+
 int64_t
 RangePropagationLossModel::DoAssignStreams (int64_t stream)
 {
@@ -28,6 +28,7 @@
 #include "ns3/object.h"
 #include "ns3/random-variable-stream.h"
 #include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -93,6 +94,30 @@ public:
                       Ptr<MobilityModel> a,
                       Ptr<MobilityModel> b) const;
 
+  /**
+   * Returns the Rx Power from one source to many destinations, e.g. the
+   * receivers of a broadcast, taking into account all the
+   * PropagationLossModel(s) chained to the current one.
+   *
+   * The positions are read once and each model of the chain processes all
+   * the destinations in a single call.  The common models compute them in
+   * loops over arrays, free of virtual calls.  Except in
+   * RangePropagationLossModel, these loops call sqrt/log10/pow, which the
+   * compiler will not vectorize because they may set errno.  The results,
+   * and the draws of the random models, are the same as calling
+   * CalcRxPower for each destination in turn.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param a the mobility model of the source
+   * \param b the mobility models of the destinations
+   * \param rxPowerDbm resized to the number of destinations, the reception
+   *        powers after adding/multiplying propagation loss (in dBm)
+   */
+  void CalcRxPowerBatch (double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         const std::vector<Ptr<MobilityModel> > &b,
+                         std::vector<double> &rxPowerDbm) const;
+
   /**
    * If this loss model uses objects of type RandomVariableStream,
    * set the stream numbers to the integers starting with the offset
@@ -106,6 +131,15 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+protected:
+  /// The geometry of a batch of destinations, shared by the models of a chain
+  struct BatchGeometry
+  {
+    double sourceHeight;               //!< Height (z) of the source (m)
+    std::vector<double> height;        //!< Height (z) of each destination (m)
+    std::vector<double> distance;      //!< Distance from the source to each destination (m)
+  };
+
 private:
   /**
    * \brief Copy constructor
@@ -133,6 +167,20 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const = 0;
+  /**
+   * Applies the loss of this particular PropagationLossModel to a batch
+   * of destinations.  The default calls DoCalcRxPower for each of them.
+   *
+   * \param a the mobility model of the source
+   * \param b the mobility models of the destinations
+   * \param geometry the distances and heights of the destinations
+   * \param rxPowerDbm the powers from the previous model of the chain,
+   *        replaced by the powers after this model (in dBm)
+   */
+  virtual void DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                   const std::vector<Ptr<MobilityModel> > &b,
+                                   const BatchGeometry &geometry,
+                                   double *rxPowerDbm) const;
 
   /**
    * Subclasses must implement this; those not using random variables
@@ -321,6 +369,10 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                   const std::vector<Ptr<MobilityModel> > &b,
+                                   const BatchGeometry &geometry,
+                                   double *rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 
   /**
@@ -441,6 +493,10 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                   const std::vector<Ptr<MobilityModel> > &b,
+                                   const BatchGeometry &geometry,
+                                   double *rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 
   /**
@@ -529,6 +585,10 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                   const std::vector<Ptr<MobilityModel> > &b,
+                                   const BatchGeometry &geometry,
+                                   double *rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 
   /**
@@ -612,6 +672,10 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                   const std::vector<Ptr<MobilityModel> > &b,
+                                   const BatchGeometry &geometry,
+                                   double *rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 
   double m_distance0; //!< Beginning of the first (near) distance field
@@ -683,6 +747,10 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                   const std::vector<Ptr<MobilityModel> > &b,
+                                   const BatchGeometry &geometry,
+                                   double *rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 
   double m_distance1; //!< Distance1
@@ -851,6 +919,10 @@ private:
   virtual double DoCalcRxPower (double txPowerDbm,
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
+  virtual void DoCalcRxPowerBatch (Ptr<MobilityModel> a,
+                                   const std::vector<Ptr<MobilityModel> > &b,
+                                   const BatchGeometry &geometry,
+                                   double *rxPowerDbm) const;
   virtual int64_t DoAssignStreams (int64_t stream);
 private:
   double m_range; //!< Maximum Transmission Range (meters)
@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/pairwise-propagation-cache.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup propagation
+ *
+ * Loss model counting the evaluations of a LogDistance model.
+ */
+class CountingLossModel : public PropagationLossModel
+{
+public:
+  CountingLossModel ()
+    : m_model (CreateObject<LogDistancePropagationLossModel> ()),
+      m_count (0)
+  {
+  }
+  Ptr<PropagationLossModel> m_model; ///< The counted model
+  mutable uint32_t m_count;          ///< Number of evaluations
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+  {
+    m_count++;
+    return m_model->CalcRxPower (txPowerDbm, a, b);
+  }
+  virtual int64_t DoAssignStreams (int64_t stream)
+  {
+    return 0;
+  }
+};
+
+/**
+ * \ingroup propagation
+ *
+ * Check that the pairwise cache returns the values of the models, computes
+ * each static link once and recomputes it after a course change.
+ */
+class PairwisePropagationCacheTestCase : public TestCase
+{
+public:
+  PairwisePropagationCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PairwisePropagationCacheTestCase::PairwisePropagationCacheTestCase ()
+  : TestCase ("Check the values and the invalidation of the pairwise propagation cache")
+{
+}
+
+void
+PairwisePropagationCacheTestCase::DoRun (void)
+{
+  Ptr<CountingLossModel> loss = CreateObject<CountingLossModel> ();
+  Ptr<LogDistancePropagationLossModel> reference = CreateObject<LogDistancePropagationLossModel> ();
+  Ptr<ConstantSpeedPropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  std::vector<Ptr<MobilityModel> > mobility;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> m = CreateObject<ConstantPositionMobilityModel> ();
+      m->SetPosition (Vector (100.0 * i, 10.0 * i, 0));
+      mobility.push_back (m);
+    }
+  Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+  moving->SetPosition (Vector (0, 50, 0));
+  moving->SetVelocity (Vector (1, 0, 0));
+  mobility.push_back (moving);
+
+  PairwisePropagationCache cache;
+  cache.SetPropagationLossModel (loss);
+  cache.SetPropagationDelayModel (delay);
+  for (uint32_t i = 0; i < mobility.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (cache.Add (mobility[i]), i, "unexpected node index");
+    }
+  NS_TEST_ASSERT_MSG_EQ (cache.GetN (), 4, "unexpected number of nodes");
+
+  // every static pair is computed once, the moving node every time
+  for (uint32_t round = 0; round < 3; round++)
+    {
+      for (uint32_t a = 0; a < 3; a++)
+        {
+          for (uint32_t b = 0; b < 3; b++)
+            {
+              // the macros may evaluate their arguments more than once
+              double rxPowerDbm = cache.CalcRxPower (16, a, b);
+              NS_TEST_EXPECT_MSG_EQ_TOL (rxPowerDbm,
+                                         reference->CalcRxPower (16, mobility[a], mobility[b]), 1e-12,
+                                         "unexpected rx power from " << a << " to " << b);
+              NS_TEST_EXPECT_MSG_EQ (cache.GetDelay (a, b), delay->GetDelay (mobility[a], mobility[b]),
+                                     "unexpected delay from " << a << " to " << b);
+            }
+        }
+      double rxPowerDbm = cache.CalcRxPower (16, 0, 3);
+      NS_TEST_EXPECT_MSG_EQ_TOL (rxPowerDbm, reference->CalcRxPower (16, mobility[0], moving),
+                                 1e-12, "unexpected rx power to the moving node");
+    }
+  NS_TEST_EXPECT_MSG_EQ (loss->m_count, 9 + 3, "static links computed more than once");
+
+  // another tx power is recomputed
+  loss->m_count = 0;
+  double rxPowerDbm = cache.CalcRxPower (10, 0, 1);
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxPowerDbm, reference->CalcRxPower (10, mobility[0], mobility[1]),
+                             1e-12, "unexpected rx power for another tx power");
+  NS_TEST_EXPECT_MSG_EQ (loss->m_count, 1, "rx power not recomputed for another tx power");
+
+  // a course change of node 1 only invalidates its links
+  mobility[1]->SetPosition (Vector (500, 0, 0));
+  loss->m_count = 0;
+  for (uint32_t a = 0; a < 3; a++)
+    {
+      for (uint32_t b = 0; b < 3; b++)
+        {
+          rxPowerDbm = cache.CalcRxPower (16, a, b);
+          NS_TEST_EXPECT_MSG_EQ_TOL (rxPowerDbm,
+                                     reference->CalcRxPower (16, mobility[a], mobility[b]), 1e-12,
+                                     "unexpected rx power after a course change, from " << a << " to " << b);
+          NS_TEST_EXPECT_MSG_EQ (cache.GetDelay (a, b), delay->GetDelay (mobility[a], mobility[b]),
+                                 "unexpected delay after a course change, from " << a << " to " << b);
+        }
+    }
+  // the 5 links of node 1 are recomputed, the 4 others are still cached
+  NS_TEST_EXPECT_MSG_EQ (loss->m_count, 5, "unexpected number of evaluations after a course change");
+
+  // the moving node is cached once it stops
+  moving->SetVelocity (Vector (0, 0, 0));
+  loss->m_count = 0;
+  cache.CalcRxPower (10, 0, 3);
+  cache.CalcRxPower (10, 0, 3);
+  NS_TEST_EXPECT_MSG_EQ (loss->m_count, 1, "stopped node not cached");
+
+  // an explicit invalidation and a new loss model forget the values
+  cache.Invalidate (3);
+  cache.CalcRxPower (10, 0, 3);
+  NS_TEST_EXPECT_MSG_EQ (loss->m_count, 2, "invalidated node still cached");
+  cache.SetPropagationLossModel (reference);
+  cache.CalcRxPower (10, 0, 3);
+  NS_TEST_EXPECT_MSG_EQ (loss->m_count, 2, "former loss model still used");
+
+  cache.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (cache.GetN (), 0, "nodes left after Clear");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup propagation
+ *
+ * Pairwise propagation cache test suite
+ */
+class PairwisePropagationCacheTestSuite : public TestSuite
+{
+public:
+  PairwisePropagationCacheTestSuite ();
+};
+
+PairwisePropagationCacheTestSuite::PairwisePropagationCacheTestSuite ()
+  : TestSuite ("pairwise-propagation-cache", UNIT)
+{
+  AddTestCase (new PairwisePropagationCacheTestCase, TestCase::QUICK);
+}
+
+static PairwisePropagationCacheTestSuite pairwisePropagationCacheTestSuite;
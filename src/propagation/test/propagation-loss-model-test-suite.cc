@@ -436,6 +436,97 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class BatchPropagationLossModelTestCase : public TestCase
+{
+public:
+  BatchPropagationLossModelTestCase ();
+  virtual ~BatchPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check CalcRxPowerBatch against CalcRxPower, on two models built alike.
+   *
+   * \param name the name of the models
+   * \param batch the model computing in batch
+   * \param reference the model computing each destination
+   */
+  void Check (std::string name, Ptr<PropagationLossModel> batch, Ptr<PropagationLossModel> reference);
+
+  Ptr<MobilityModel> m_source;                    //!< The source
+  std::vector<Ptr<MobilityModel> > m_destinations; //!< The destinations
+};
+
+BatchPropagationLossModelTestCase::BatchPropagationLossModelTestCase ()
+  : TestCase ("Check that CalcRxPowerBatch gives the results of CalcRxPower")
+{
+}
+
+BatchPropagationLossModelTestCase::~BatchPropagationLossModelTestCase ()
+{
+}
+
+void
+BatchPropagationLossModelTestCase::Check (std::string name, Ptr<PropagationLossModel> batch,
+                                          Ptr<PropagationLossModel> reference)
+{
+  batch->AssignStreams (1);
+  reference->AssignStreams (1);
+  for (double txPowerDbm = 0; txPowerDbm <= 20; txPowerDbm += 10)
+    {
+      std::vector<double> rxPowerDbm;
+      batch->CalcRxPowerBatch (txPowerDbm, m_source, m_destinations, rxPowerDbm);
+      NS_TEST_ASSERT_MSG_EQ (rxPowerDbm.size (), m_destinations.size (), name << ": unexpected number of results");
+      for (uint32_t i = 0; i < m_destinations.size (); i++)
+        {
+          // the same operations in the same order, so exactly the same values
+          NS_TEST_EXPECT_MSG_EQ (rxPowerDbm[i], reference->CalcRxPower (txPowerDbm, m_source, m_destinations[i]),
+                                 name << ": unexpected rx power to destination " << i);
+        }
+    }
+}
+
+void
+BatchPropagationLossModelTestCase::DoRun (void)
+{
+  m_source = CreateObject<ConstantPositionMobilityModel> ();
+  m_source->SetPosition (Vector (0, 0, 1.5));
+  // from the same position to the far field, through all the distance fields
+  double distances[] = { 0, 0.1, 0.5, 1, 2, 10, 50, 99.9, 100, 150, 250, 450, 1000, 2500, 5000, 20000 };
+  for (uint32_t i = 0; i < sizeof (distances) / sizeof (distances[0]); i++)
+    {
+      Ptr<MobilityModel> destination = CreateObject<ConstantPositionMobilityModel> ();
+      destination->SetPosition (Vector (distances[i] * 0.6, distances[i] * 0.8, 1.5 + i % 3));
+      m_destinations.push_back (destination);
+    }
+
+  Check ("Friis", CreateObject<FriisPropagationLossModel> (), CreateObject<FriisPropagationLossModel> ());
+  Check ("TwoRayGround", CreateObject<TwoRayGroundPropagationLossModel> (), CreateObject<TwoRayGroundPropagationLossModel> ());
+  Check ("LogDistance", CreateObject<LogDistancePropagationLossModel> (), CreateObject<LogDistancePropagationLossModel> ());
+  Check ("ThreeLogDistance", CreateObject<ThreeLogDistancePropagationLossModel> (), CreateObject<ThreeLogDistancePropagationLossModel> ());
+  Check ("Nakagami", CreateObject<NakagamiPropagationLossModel> (), CreateObject<NakagamiPropagationLossModel> ());
+  Ptr<RangePropagationLossModel> batchRange = CreateObject<RangePropagationLossModel> ();
+  Ptr<RangePropagationLossModel> referenceRange = CreateObject<RangePropagationLossModel> ();
+  batchRange->SetAttribute ("MaxRange", DoubleValue (250));
+  referenceRange->SetAttribute ("MaxRange", DoubleValue (250));
+  Check ("Range", batchRange, referenceRange);
+  // models without a batch kernel go through DoCalcRxPower
+  Check ("Random", CreateObject<RandomPropagationLossModel> (), CreateObject<RandomPropagationLossModel> ());
+
+  // a chain mixing random and deterministic models
+  Ptr<PropagationLossModel> batch = CreateObject<LogDistancePropagationLossModel> ();
+  Ptr<PropagationLossModel> reference = CreateObject<LogDistancePropagationLossModel> ();
+  batch->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+  reference->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+  batch->GetNext ()->SetNext (CreateObject<RandomPropagationLossModel> ());
+  reference->GetNext ()->SetNext (CreateObject<RandomPropagationLossModel> ());
+  Check ("LogDistance+Nakagami+Random", batch, reference);
+
+  m_destinations.clear ();
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +541,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new BatchPropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
@@ -260,6 +260,25 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
         }
 
+      // the propagation gains of all the receivers of this model, in one pass
+      std::vector<double> propagationGainsDb;
+      if (txMobility && m_propagationLoss)
+        {
+          std::vector<Ptr<MobilityModel> > receiverMobilities;
+          for (auto rxPhyIterator = rxInfoIterator->second.m_rxPhys.begin ();
+               rxPhyIterator != rxInfoIterator->second.m_rxPhys.end ();
+               ++rxPhyIterator)
+            {
+              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+              if ((*rxPhyIterator) != txParams->txPhy && receiverMobility)
+                {
+                  receiverMobilities.push_back (receiverMobility);
+                }
+            }
+          m_propagationLoss->CalcRxPowerBatch (0, txMobility, receiverMobilities, propagationGainsDb);
+        }
+      std::vector<double>::const_iterator propagationGainDbIterator = propagationGainsDb.begin ();
+
       for (auto rxPhyIterator = rxInfoIterator->second.m_rxPhys.begin ();
            rxPhyIterator != rxInfoIterator->second.m_rxPhys.end ();
            ++rxPhyIterator)
@@ -299,7 +318,7 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                     }
                   if (m_propagationLoss)
                     {
-                      propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+                      propagationGainDb = *propagationGainDbIterator++;
                       NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
                       pathLossDb -= propagationGainDb;
                     }                    
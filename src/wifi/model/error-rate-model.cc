@@ -18,22 +18,60 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <vector>
+#include "ns3/boolean.h"
 #include "error-rate-model.h"
 #include "ns3/wifi-tx-vector.h"
+#include "wifi-utils.h"
 
 namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (ErrorRateModel);
 
+namespace {
+
+/// Key of a success rate table: model TypeId, mode, channel width, guard interval and NSS
+typedef std::tuple<uint16_t, uint32_t, uint16_t, uint16_t, uint8_t> TableKey;
+
+/// ln (-ln (1/2)), the table value of a success rate of 1/2 per bit
+const double LOG_LOG_2 = std::log (std::log (2.0));
+
+/// The success rate tables of this thread
+thread_local std::map<TableKey, std::vector<double> > t_tables;
+/// Key of the table last used by this thread
+thread_local TableKey t_lastKey;
+/// Table last used by this thread, null before the first lookup
+thread_local std::vector<double> *t_lastTable = 0;
+
+} // unnamed namespace
+
+const double ErrorRateModel::TABLE_MIN_DB = -20;
+const double ErrorRateModel::TABLE_MAX_DB = 50;
+const double ErrorRateModel::TABLE_STEP_DB = 0.01;
+
 TypeId ErrorRateModel::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::ErrorRateModel")
     .SetParent<Object> ()
     .SetGroupName ("Wifi")
+    .AddAttribute ("UseLookupTable",
+                   "If true, the chunk success rates of the OFDM modes are interpolated "
+                   "in tables computed on first use instead of being evaluated in closed form.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ErrorRateModel::m_useLookupTable),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
+ErrorRateModel::ErrorRateModel ()
+  : m_useLookupTable (false)
+{
+}
+
 double
 ErrorRateModel::CalculateSnr (WifiTxVector txVector, double ber) const
 {
@@ -58,4 +96,74 @@ ErrorRateModel::CalculateSnr (WifiTxVector txVector, double ber) const
   return low;
 }
 
+double
+ErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  if (m_useLookupTable)
+    {
+      WifiModulationClass modulation = mode.GetModulationClass ();
+      if (modulation == WIFI_MOD_CLASS_ERP_OFDM
+          || modulation == WIFI_MOD_CLASS_OFDM
+          || modulation == WIFI_MOD_CLASS_HT
+          || modulation == WIFI_MOD_CLASS_VHT
+          || modulation == WIFI_MOD_CLASS_HE)
+        {
+          return GetTableChunkSuccessRate (mode, txVector, snr, nbits);
+        }
+    }
+  return DoGetChunkSuccessRate (mode, txVector, snr, nbits);
+}
+
+double
+ErrorRateModel::GetTableChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  TableKey key (GetInstanceTypeId ().GetUid (), mode.GetUid (), txVector.GetChannelWidth (),
+                txVector.GetGuardInterval (), txVector.GetNss ());
+  if (t_lastTable == 0 || key != t_lastKey)
+    {
+      // successive chunks mostly share their mode, skip the map for them
+      t_lastTable = &t_tables[key];
+      t_lastKey = key;
+    }
+  std::vector<double> &table = *t_lastTable;
+  if (table.empty ())
+    {
+      uint32_t size = static_cast<uint32_t> (std::round ((TABLE_MAX_DB - TABLE_MIN_DB) / TABLE_STEP_DB)) + 1;
+      table.reserve (size);
+      for (uint32_t i = 0; i < size; i++)
+        {
+          double successRate = DoGetChunkSuccessRate (mode, txVector, DbToRatio (TABLE_MIN_DB + i * TABLE_STEP_DB), 1);
+          // -inf when the success rate is 1, +inf when it is 0
+          table.push_back (std::log (-std::log (successRate)));
+        }
+    }
+  double position = (RatioToDb (snr) - TABLE_MIN_DB) / TABLE_STEP_DB;
+  if (!(position >= 0) || position >= table.size () - 1 || nbits == 0)
+    {
+      return DoGetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  std::size_t i = static_cast<std::size_t> (position);
+  double low = table[i];
+  double high = table[i + 1];
+  if (std::isinf (low) && low == high)
+    {
+      // the error rate decreases with the SNR, so it is 0 or 1 in between
+      return low < 0 ? 1.0 : 0.0;
+    }
+  if (std::isinf (low) || std::isinf (high))
+    {
+      return DoGetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  if (low > LOG_LOG_2)
+    {
+      // below a success rate of 1/2 per bit, the success rate nears the point where
+      // the models cap the bit error rate to 1 and is interpolated linearly
+      double rateLow = std::exp (-std::exp (low));
+      double rateHigh = std::exp (-std::exp (high));
+      return std::pow (rateLow + (position - i) * (rateHigh - rateLow), static_cast<double> (nbits));
+    }
+  double value = low + (position - i) * (high - low);
+  return std::exp (-static_cast<double> (nbits) * std::exp (value));
+}
+
 } //namespace ns3
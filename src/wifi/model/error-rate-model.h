@@ -42,6 +42,8 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  ErrorRateModel ();
+
   /**
    * \param txVector a specific transmission vector including WifiMode
    * \param ber a target ber
@@ -51,7 +53,6 @@ public:
   double CalculateSnr (WifiTxVector txVector, double ber) const;
 
   /**
-   * A pure virtual method that must be implemented in the subclass.
    * This method returns the probability that the given 'chunk' of the
    * packet will be successfully received by the PHY.
    *
@@ -66,6 +67,25 @@ public:
    * to calculate the chunk error rate, and the txVector is used for
    * other information as needed.
    *
+   * With the UseLookupTable attribute, the success rate of the OFDM
+   * modes is interpolated in a table instead, see GetTableChunkSuccessRate.
+   *
+   * \param mode the Wi-Fi mode applicable to this chunk
+   * \param txVector TXVECTOR of the overall transmission
+   * \param snr the SNR of the chunk
+   * \param nbits the number of bits in this chunk
+   *
+   * \return probability of successfully receiving the chunk
+   */
+  double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+
+private:
+  /**
+   * A pure virtual method that must be implemented in the subclass.
+   * This method returns the probability that the given 'chunk' of the
+   * packet will be successfully received by the PHY.
+   *
    * \param mode the Wi-Fi mode applicable to this chunk
    * \param txVector TXVECTOR of the overall transmission
    * \param snr the SNR of the chunk
@@ -73,7 +93,37 @@ public:
    *
    * \return probability of successfully receiving the chunk
    */
-  virtual double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const = 0;
+  virtual double DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const = 0;
+  /**
+   * Return the chunk success rate interpolated in the table of the mode.
+   *
+   * The success rate of a chunk is (1 - pe)^nbits, where pe is the coded
+   * bit error rate at the given SNR.  The table holds ln (-ln (1 - pe))
+   * for SNRs from TABLE_MIN_DB to TABLE_MAX_DB dB by steps of TABLE_STEP_DB;
+   * it is computed with DoGetChunkSuccessRate on first use and shared by
+   * the models of the same type in the thread, which must therefore only
+   * depend on the mode, the channel width, the guard interval and the
+   * number of spatial streams.  Outside of the table, the success rate is
+   * computed by DoGetChunkSuccessRate.
+   *
+   * For the NIST and YANS models, the success rates of chunks of 24 bits
+   * or more are within 0.1% (or 1e-5 when lower than 1%) of the closed-form
+   * ones.
+   *
+   * \param mode the Wi-Fi mode applicable to this chunk
+   * \param txVector TXVECTOR of the overall transmission
+   * \param snr the SNR of the chunk
+   * \param nbits the number of bits in this chunk
+   *
+   * \return probability of successfully receiving the chunk
+   */
+  double GetTableChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+  static const double TABLE_MIN_DB;   //!< lowest SNR of the tables (dB)
+  static const double TABLE_MAX_DB;   //!< highest SNR of the tables (dB)
+  static const double TABLE_STEP_DB;  //!< SNR step of the tables (dB)
+
+  bool m_useLookupTable; //!< whether the OFDM success rates are interpolated in tables
 };
 
 } //namespace ns3
@@ -26,6 +26,7 @@
 #include "wifi-phy.h"
 #include "error-rate-model.h"
 #include "wifi-utils.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -122,6 +123,7 @@ InterferenceHelper::NiChange::GetEvent (void) const
 InterferenceHelper::InterferenceHelper ()
   : m_errorRateModel (0),
     m_numRxAntennas (1),
+    m_niStart (0),
     m_firstPower (0),
     m_rxing (false)
 {
@@ -208,14 +210,13 @@ InterferenceHelper::AppendEvent (Ptr<Event> event)
     {
       m_firstPower = previousPowerStart;
       // Always leave the first zero power noise event in the list
-      m_niChanges.erase (++(m_niChanges.begin ()),
-                         GetNextPosition (event->GetStartTime ()));
+      EraseNiChanges (GetNextPosition (event->GetStartTime ()));
     }
-  auto first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event));
-  auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event));
-  for (auto i = first; i != last; ++i)
+  std::size_t first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event));
+  std::size_t last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event));
+  for (std::size_t i = first; i != last; ++i)
     {
-      i->second.AddPower (event->GetRxPowerW ());
+      m_niChanges[i].second.AddPower (event->GetRxPowerW ());
     }
 }
 
@@ -238,19 +239,20 @@ double
 InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const
 {
   double noiseInterferenceW = m_firstPower;
-  auto it = m_niChanges.find (event->GetStartTime ());
+  auto it = FindPosition (event->GetStartTime ());
   for (; it != m_niChanges.end () && it->first < Simulator::Now (); ++it)
     {
       noiseInterferenceW = it->second.GetPower () - event->GetRxPowerW ();
     }
-  it = m_niChanges.find (event->GetStartTime ());
+  it = FindPosition (event->GetStartTime ());
   for (; it != m_niChanges.end () && it->second.GetEvent () != event; ++it);
-  ni->emplace (event->GetStartTime (), NiChange (0, event));
-  while (++it != m_niChanges.end () && it->second.GetEvent () != event)
+  ni->reserve (it < m_niChanges.end () ? m_niChanges.end () - it + 1 : 2);
+  ni->emplace_back (event->GetStartTime (), NiChange (0, event));
+  while (it != m_niChanges.end () && ++it != m_niChanges.end () && it->second.GetEvent () != event)
     {
-      ni->insert (*it);
+      ni->push_back (*it);
     }
-  ni->emplace (event->GetEndTime (), NiChange (0, event));
+  ni->emplace_back (event->GetEndTime (), NiChange (0, event));
   NS_ASSERT_MSG (noiseInterferenceW >= 0, "CalculateNoiseInterferenceW returns negative value " << noiseInterferenceW);
   return noiseInterferenceW;
 }
@@ -921,6 +923,7 @@ void
 InterferenceHelper::EraseEvents (void)
 {
   m_niChanges.clear ();
+  m_niStart = 0;
   // Always have a zero power noise event in the list
   AddNiChangeEvent (Time (0), NiChange (0.0, 0));
   m_rxing = false;
@@ -930,7 +933,16 @@ InterferenceHelper::EraseEvents (void)
 InterferenceHelper::NiChanges::const_iterator
 InterferenceHelper::GetNextPosition (Time moment) const
 {
-  return m_niChanges.upper_bound (moment);
+  return std::upper_bound (m_niChanges.begin () + m_niStart, m_niChanges.end (), moment,
+                           [] (Time t, const NiChanges::value_type &change) { return t < change.first; });
+}
+
+InterferenceHelper::NiChanges::const_iterator
+InterferenceHelper::FindPosition (Time moment) const
+{
+  auto it = std::lower_bound (m_niChanges.begin () + m_niStart, m_niChanges.end (), moment,
+                              [] (const NiChanges::value_type &change, Time t) { return change.first < t; });
+  return (it != m_niChanges.end () && it->first == moment) ? it : m_niChanges.end ();
 }
 
 InterferenceHelper::NiChanges::const_iterator
@@ -943,10 +955,35 @@ InterferenceHelper::GetPreviousPosition (Time moment) const
   return it;
 }
 
-InterferenceHelper::NiChanges::iterator
+std::size_t
 InterferenceHelper::AddNiChangeEvent (Time moment, NiChange change)
 {
-  return m_niChanges.insert (GetNextPosition (moment), std::make_pair (moment, change));
+  std::size_t index = GetNextPosition (moment) - m_niChanges.begin ();
+  m_niChanges.insert (m_niChanges.begin () + index, std::make_pair (moment, change));
+  return index;
+}
+
+void
+InterferenceHelper::EraseNiChanges (NiChanges::const_iterator next)
+{
+  std::size_t end = next - m_niChanges.begin ();
+  NS_ASSERT (end > m_niStart);
+  if (end == m_niStart + 1)
+    {
+      return;
+    }
+  // release the events at once, the slots are reclaimed later
+  for (std::size_t i = m_niStart + 1; i < end - 1; ++i)
+    {
+      m_niChanges[i].second = NiChange (0.0, 0);
+    }
+  m_niChanges[end - 1] = std::make_pair (Time (0), NiChange (0.0, 0));
+  m_niStart = end - 1;
+  if (m_niStart > m_niChanges.size () - m_niStart)
+    {
+      m_niChanges.erase (m_niChanges.begin (), m_niChanges.begin () + m_niStart);
+      m_niStart = 0;
+    }
 }
 
 void
@@ -962,7 +999,7 @@ InterferenceHelper::NotifyRxEnd ()
   NS_LOG_FUNCTION (this);
   m_rxing = false;
   //Update m_firstPower for frame capture
-  auto it = m_niChanges.find (Simulator::Now ());
+  auto it = FindPosition (Simulator::Now ());
   it--;
   m_firstPower = it->second.GetPower ();
 }
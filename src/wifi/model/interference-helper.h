@@ -23,7 +23,7 @@
 
 #include "ns3/nstime.h"
 #include "wifi-tx-vector.h"
-#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -265,9 +265,10 @@ private:
   };
 
   /**
-   * typedef for a multimap of NiChanges
+   * typedef for a time-sorted vector of NiChanges; NiChanges with the
+   * same time are kept in insertion order
    */
-  typedef std::multimap<Time, NiChange> NiChanges;
+  typedef std::vector<std::pair<Time, NiChange> > NiChanges;
 
   /**
    * Append the given Event.
@@ -342,8 +343,19 @@ private:
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel; ///< error rate model
   uint8_t m_numRxAntennas; /**< the number of RX antennas in the corresponding receiver */
-  /// Experimental: needed for energy duration calculation
+  /**
+   * Experimental: needed for energy duration calculation.
+   *
+   * The NiChanges are kept in a time sorted vector: the power of each
+   * NiChange is the running sum of the powers of the signals in the air
+   * since its time.  The NiChanges before m_niStart are expired, their
+   * slots are erased at once from the front when they outnumber the live
+   * ones.  A new NiChange is inserted in place, which moves the NiChanges
+   * after it: few of them, as a new signal usually ends after the others,
+   * but it is not a ring buffer and an insertion is linear in the worst case.
+   */
   NiChanges m_niChanges;
+  std::size_t m_niStart; ///< index of the zero power NiChange, the first live one
   double m_firstPower; ///< first power
   bool m_rxing; ///< flag whether it is in receiving state
 
@@ -355,12 +367,13 @@ private:
    */
   NiChanges::const_iterator GetNextPosition (Time moment) const;
   /**
-   * Returns an iterator to the first nichange that is later than moment
+   * Returns an iterator to the first nichange that is at moment
    *
-   * \param moment time to check from
-   * \returns an iterator to the list of NiChanges
+   * \param moment time to look for
+   * \returns an iterator to the list of NiChanges, the end of the list if
+   * no nichange is at moment
    */
-  //NiChanges::iterator GetNextPosition (Time moment);
+  NiChanges::const_iterator FindPosition (Time moment) const;
   /**
    * Returns an iterator to the last nichange that is before than moment
    *
@@ -371,13 +384,20 @@ private:
 
   /**
    * Add NiChange to the list at the appropriate position and
-   * return the iterator of the new event.
+   * return the index of the new event.
    *
    * \param moment
    * \param change
-   * \returns the iterator of the new event
+   * \returns the index of the new event in m_niChanges
+   */
+  std::size_t AddNiChangeEvent (Time moment, NiChange change);
+  /**
+   * Expire the NiChanges before a given one, except the zero power
+   * NiChange which moves in front of it.
+   *
+   * \param next the first NiChange to keep
    */
-  NiChanges::iterator AddNiChangeEvent (Time moment, NiChange change);
+  void EraseNiChanges (NiChanges::const_iterator next);
 };
 
 } //namespace ns3
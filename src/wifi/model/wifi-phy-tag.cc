@@ -27,6 +27,8 @@ WifiPhyTag::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::WifiPhyTag")
     .SetParent<Tag> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<WifiPhyTag> ()
   ;
   return tid;
 }
@@ -27,9 +27,17 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "yans-wifi-channel.h"
 #include "yans-wifi-phy.h"
 #include "wifi-utils.h"
+#ifdef NS3_MTP
+#include "ns3/multithreaded-simulator-impl.h"
+#endif
+#include <algorithm>
+#include <cmath>
 
 namespace ns3 {
 
@@ -52,11 +60,42 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("SpatialIndex",
+                   "If true, keep the PHY positions in a grid and only deliver packets to the PHYs "
+                   "within the cutoff range of the sender.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_spatialIndex),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxRange",
+                   "Cutoff range (m) used with SpatialIndex. If 0, the range is derived from the "
+                   "propagation loss model and RxPowerCutoff.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("RxPowerCutoff",
+                   "Received power (dBm) below which a PHY is not considered as a receiver, "
+                   "not even of interference, when SpatialIndex is enabled and MaxRange is 0.",
+                   DoubleValue (-101.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_rxPowerCutoffDbm),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("PairwiseCache",
+                   "If true, keep the received power and the delay of every pair of PHYs until "
+                   "either PHY changes course. Only valid with deterministic propagation models.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_pairwiseCache),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_spatialIndex (false),
+    m_maxRange (0.0),
+    m_rxPowerCutoffDbm (-101.0),
+    m_pairwiseCache (false),
+    m_indexBuilt (false),
+    m_cellSize (0.0),
+    m_cacheBuilt (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -64,6 +103,12 @@ YansWifiChannel::YansWifiChannel ()
 YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION (this);
+  for (std::map<const MobilityModel *, std::vector<uint32_t> >::const_iterator i = m_physByMobility.begin ();
+       i != m_physByMobility.end (); ++i)
+    {
+      m_index[i->second.front ()].mobility->TraceDisconnectWithoutContext (
+        "CourseChange", MakeCallback (&YansWifiChannel::CourseChanged, this));
+    }
   m_phyList.clear ();
 }
 
@@ -72,6 +117,9 @@ YansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss)
 {
   NS_LOG_FUNCTION (this << loss);
   m_loss = loss;
+  m_cutoffRange.clear ();
+  m_indexBuilt = false;
+  m_cacheBuilt = false;
 }
 
 void
@@ -79,6 +127,7 @@ YansWifiChannel::SetPropagationDelayModel (const Ptr<PropagationDelayModel> dela
 {
   NS_LOG_FUNCTION (this << delay);
   m_delay = delay;
+  m_cacheBuilt = false;
 }
 
 void
@@ -87,42 +136,320 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  // one copy for all the receivers, the caller may still modify its packet
+  packet = packet->Copy ();
+  uint32_t senderIndex = m_pairwiseCache ? GetCacheIndex (sender) : 0;
+  std::vector<uint32_t> candidates;
+  if (!m_spatialIndex || !GetCandidates (senderMobility, txPowerDbm, candidates))
+    {
+      candidates.resize (m_phyList.size ());
+      for (uint32_t i = 0; i < m_phyList.size (); i++)
+        {
+          candidates[i] = i;
+        }
+    }
+  std::vector<uint32_t> receivers;
+  receivers.reserve (candidates.size ());
+  for (std::vector<uint32_t>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
+    {
+      Ptr<YansWifiPhy> receiver = m_phyList[*i];
+      //For now don't account for inter channel interference nor channel bonding
+      if (receiver != sender && receiver->GetChannelNumber () == sender->GetChannelNumber ())
+        {
+          receivers.push_back (*i);
+        }
+    }
+
+  std::size_t n = receivers.size ();
+  std::vector<Time> delays (n);
+  std::vector<double> rxPowersDbm (n);
+  if (m_pairwiseCache)
+    {
+      for (std::size_t k = 0; k < n; k++)
+        {
+          delays[k] = m_cache.GetDelay (senderIndex, receivers[k]);
+          rxPowersDbm[k] = m_cache.CalcRxPower (txPowerDbm, senderIndex, receivers[k]);
+        }
+    }
+  else
+    {
+      // all the receivers in one pass of the loss models
+      std::vector<Ptr<MobilityModel> > receiverMobilities (n);
+      for (std::size_t k = 0; k < n; k++)
+        {
+          receiverMobilities[k] = m_phyList[receivers[k]]->GetMobility ();
+          delays[k] = m_delay->GetDelay (senderMobility, receiverMobilities[k]);
+        }
+      m_loss->CalcRxPowerBatch (txPowerDbm, senderMobility, receiverMobilities, rxPowersDbm);
+    }
+  for (std::size_t k = 0; k < n; k++)
+    {
+      SendTo (receivers[k], packet, rxPowersDbm[k], delays[k], duration);
+    }
+}
+
+void
+YansWifiChannel::SendTo (uint32_t index, Ptr<const Packet> packet, double rxPowerDbm,
+                         Time delay, Time duration) const
+{
+  Ptr<YansWifiPhy> receiver = m_phyList[index];
+  NS_LOG_DEBUG ("propagation: to=" << index << ", rxPower=" << rxPowerDbm << "dbm, delay=" << delay);
+  Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetNode ()->GetId ();
+    }
+#ifdef NS3_MTP
+  // A receiver running on another thread must not share the packet data
+  if (MultithreadedSimulatorImpl::IsRemoteContext (dstNode))
     {
-      if (sender != (*i))
+      Simulator::ScheduleWithContext (dstNode,
+                                      delay, &YansWifiChannel::Receive,
+                                      receiver, Ptr<const Packet> (packet->DeepCopy ()), rxPowerDbm, duration);
+      return;
+    }
+#endif
+
+  // the receivers share the packet until they accept it, see Receive
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive,
+                                  receiver, packet, rxPowerDbm, duration);
+}
+
+bool
+YansWifiChannel::GetCandidates (Ptr<MobilityModel> senderMobility, double txPowerDbm,
+                                std::vector<uint32_t> &candidates) const
+{
+#ifdef NS3_MTP
+  CriticalSection cs (m_indexMutex);
+#endif
+  double range = GetCutoffRange (txPowerDbm);
+  if (range < 0)
+    {
+      return false;
+    }
+  if (!m_indexBuilt)
+    {
+      m_cellSize = std::max (range, 1.0);
+      BuildIndex ();
+    }
+  Vector position = senderMobility->GetPosition ();
+  int64_t cx = static_cast<int64_t> (std::floor (position.x / m_cellSize));
+  int64_t cy = static_cast<int64_t> (std::floor (position.y / m_cellSize));
+  int64_t n = static_cast<int64_t> (std::ceil (range / m_cellSize));
+  for (int64_t x = cx - n; x <= cx + n; x++)
+    {
+      for (int64_t y = cy - n; y <= cy + n; y++)
         {
-          //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          std::unordered_map<uint64_t, std::vector<uint32_t> >::const_iterator cell =
+            m_grid.find (GetCellKey (x, y));
+          if (cell == m_grid.end ())
             {
               continue;
             }
+          for (std::vector<uint32_t>::const_iterator i = cell->second.begin (); i != cell->second.end (); i++)
+            {
+              if (m_index[*i].mobility->GetDistanceFrom (senderMobility) <= range)
+                {
+                  candidates.push_back (*i);
+                }
+            }
+        }
+    }
+  for (std::vector<uint32_t>::const_iterator i = m_mobile.begin (); i != m_mobile.end (); i++)
+    {
+      Ptr<MobilityModel> mobility = m_index[*i].mobility;
+      if (mobility == 0 || mobility->GetDistanceFrom (senderMobility) <= range)
+        {
+          candidates.push_back (*i);
+        }
+    }
+  // Keep the scheduling order of the default mode
+  std::sort (candidates.begin (), candidates.end ());
+  NS_LOG_DEBUG ("spatial index: " << candidates.size () << " of " << m_phyList.size ()
+                                  << " PHYs within " << range << "m");
+  return true;
+}
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
+double
+YansWifiChannel::GetCutoffRange (double txPowerDbm) const
+{
+  if (m_maxRange > 0)
+    {
+      return m_maxRange;
+    }
+  std::map<double, double>::const_iterator it = m_cutoffRange.find (txPowerDbm);
+  if (it != m_cutoffRange.end ())
+    {
+      return it->second;
+    }
+  // Search the distance at which the received power crosses the cutoff,
+  // assuming it decreases with distance.
+  Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (0, 0, 0));
+  double hi = 1.0;
+  double range = -1.0;
+  for (; hi <= 1e7; hi *= 2)
+    {
+      b->SetPosition (Vector (hi, 0, 0));
+      if (m_loss->CalcRxPower (txPowerDbm, a, b) < m_rxPowerCutoffDbm)
+        {
+          break;
+        }
+    }
+  if (hi <= 1e7)
+    {
+      double lo = hi / 2;
+      for (uint32_t i = 0; i < 50; i++)
+        {
+          double mid = (lo + hi) / 2;
+          b->SetPosition (Vector (mid, 0, 0));
+          if (m_loss->CalcRxPower (txPowerDbm, a, b) < m_rxPowerCutoffDbm)
             {
-              dstNode = 0xffffffff;
+              hi = mid;
             }
           else
             {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
+              lo = mid;
             }
+        }
+      range = hi;
+    }
+  NS_LOG_DEBUG ("cutoff range for txPower=" << txPowerDbm << "dbm: " << range << "m");
+  m_cutoffRange[txPowerDbm] = range;
+  return range;
+}
+
+uint64_t
+YansWifiChannel::GetCellKey (const Vector &position) const
+{
+  int64_t cx = static_cast<int64_t> (std::floor (position.x / m_cellSize));
+  int64_t cy = static_cast<int64_t> (std::floor (position.y / m_cellSize));
+  return GetCellKey (cx, cy);
+}
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
+uint64_t
+YansWifiChannel::GetCellKey (int64_t x, int64_t y)
+{
+  // shift the unsigned value, cells left of or below the origin are negative
+  return (static_cast<uint64_t> (static_cast<uint32_t> (x)) << 32) | static_cast<uint32_t> (y);
+}
+
+void
+YansWifiChannel::BuildIndex (void) const
+{
+  NS_LOG_FUNCTION (this << m_cellSize);
+  for (std::map<const MobilityModel *, std::vector<uint32_t> >::const_iterator i = m_physByMobility.begin ();
+       i != m_physByMobility.end (); ++i)
+    {
+      m_index[i->second.front ()].mobility->TraceDisconnectWithoutContext (
+        "CourseChange", MakeCallback (&YansWifiChannel::CourseChanged, this));
+    }
+  m_physByMobility.clear ();
+  m_grid.clear ();
+  m_mobile.clear ();
+  m_index.assign (m_phyList.size (), IndexEntry ());
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
+    {
+      Ptr<MobilityModel> mobility = m_phyList[i]->GetMobility ();
+      m_index[i].mobility = mobility;
+      if (mobility != 0)
+        {
+          std::vector<uint32_t> &phys = m_physByMobility[PeekPointer (mobility)];
+          if (phys.empty ())
+            {
+              mobility->TraceConnectWithoutContext ("CourseChange",
+                                                    MakeCallback (&YansWifiChannel::CourseChanged, this));
+            }
+          phys.push_back (i);
+        }
+      IndexPhy (i);
+    }
+  m_indexBuilt = true;
+}
+
+uint32_t
+YansWifiChannel::GetCacheIndex (Ptr<YansWifiPhy> sender) const
+{
+#ifdef NS3_MTP
+  CriticalSection cs (m_indexMutex);
+#endif
+  if (!m_cacheBuilt)
+    {
+      NS_LOG_DEBUG ("build the pairwise cache of " << m_phyList.size () << " PHYs");
+      m_cache.Clear ();
+      m_cache.SetPropagationLossModel (m_loss);
+      m_cache.SetPropagationDelayModel (m_delay);
+      m_phyIndex.clear ();
+      for (uint32_t i = 0; i < m_phyList.size (); i++)
+        {
+          m_cache.Add (m_phyList[i]->GetMobility ());
+          m_phyIndex[PeekPointer (m_phyList[i])] = i;
         }
+      m_cacheBuilt = true;
     }
+  std::unordered_map<const YansWifiPhy *, uint32_t>::const_iterator it = m_phyIndex.find (PeekPointer (sender));
+  NS_ASSERT (it != m_phyIndex.end ());
+  return it->second;
 }
 
 void
-YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<Packet> packet, double rxPowerDbm, Time duration)
+YansWifiChannel::IndexPhy (uint32_t index) const
+{
+  IndexEntry &entry = m_index[index];
+  Ptr<MobilityModel> mobility = entry.mobility;
+  if (mobility == 0 || mobility->GetVelocity ().GetLength () > 0)
+    {
+      entry.mobile = true;
+      m_mobile.push_back (index);
+    }
+  else
+    {
+      entry.mobile = false;
+      entry.cell = GetCellKey (mobility->GetPosition ());
+      m_grid[entry.cell].push_back (index);
+    }
+}
+
+void
+YansWifiChannel::UnindexPhy (uint32_t index) const
+{
+  const IndexEntry &entry = m_index[index];
+  std::vector<uint32_t> &list = entry.mobile ? m_mobile : m_grid[entry.cell];
+  list.erase (std::find (list.begin (), list.end (), index));
+  if (!entry.mobile && list.empty ())
+    {
+      m_grid.erase (entry.cell);
+    }
+}
+
+void
+YansWifiChannel::CourseChanged (Ptr<const MobilityModel> mobility) const
+{
+#ifdef NS3_MTP
+  CriticalSection cs (m_indexMutex);
+#endif
+  std::map<const MobilityModel *, std::vector<uint32_t> >::const_iterator it =
+    m_physByMobility.find (PeekPointer (mobility));
+  if (!m_indexBuilt || it == m_physByMobility.end ())
+    {
+      return;
+    }
+  for (std::vector<uint32_t>::const_iterator i = it->second.begin (); i != it->second.end (); i++)
+    {
+      UnindexPhy (*i);
+      IndexPhy (*i);
+    }
+}
+
+void
+YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<const Packet> packet, double rxPowerDbm, Time duration)
 {
   NS_LOG_FUNCTION (phy << packet << rxPowerDbm << duration.GetSeconds ());
   // Do no further processing if signal is too weak
@@ -132,7 +459,7 @@ YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<Packet> packet, double rxPow
       NS_LOG_INFO ("Received signal too weak to process: " << rxPowerDbm << " dBm");
       return;
     }
-  phy->StartReceivePreamble (packet, DbmToW (rxPowerDbm + phy->GetRxGain ()), duration);
+  phy->StartReceivePreamble (packet->Copy (), DbmToW (rxPowerDbm + phy->GetRxGain ()), duration);
 }
 
 std::size_t
@@ -152,6 +479,25 @@ YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
   m_phyList.push_back (phy);
+  m_indexBuilt = false;
+  m_cacheBuilt = false;
+}
+
+Time
+YansWifiChannel::GetMinDelay (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Time minDelay = Time::Max ();
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
+    {
+      Ptr<MobilityModel> a = m_phyList[i]->GetMobility ();
+      for (uint32_t j = i + 1; j < m_phyList.size (); j++)
+        {
+          Ptr<MobilityModel> b = m_phyList[j]->GetMobility ();
+          minDelay = std::min (minDelay, m_delay->GetDelay (a, b));
+        }
+    }
+  return minDelay;
 }
 
 int64_t
@@ -22,6 +22,15 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include "ns3/channel.h"
+#include "ns3/vector.h"
+#include "ns3/nstime.h"
+#include "ns3/core-config.h"
+#include "ns3/pairwise-propagation-cache.h"
+#ifdef NS3_MTP
+#include "ns3/system-mutex.h"
+#endif
+#include <map>
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -29,6 +38,7 @@ class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
+class MobilityModel;
 class Packet;
 class Time;
 
@@ -40,6 +50,28 @@ class Time;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * When the SpatialIndex attribute is enabled, the channel keeps the
+ * position of every PHY in a uniform grid, updated through the
+ * CourseChange trace of the MobilityModel, and Send only considers the
+ * PHYs within a cutoff range of the sender.  The range is either given by
+ * the MaxRange attribute or derived from the propagation loss model as the
+ * distance beyond which the received power falls below RxPowerCutoff.  The
+ * derivation assumes a deterministic loss which decreases with distance
+ * (e.g. Friis, LogDistance, ThreeLogDistance, TwoRayGround, Range); with
+ * random loss models MaxRange should be set instead.  Candidates are still
+ * visited in the order they were added to the channel.  The PHYs beyond
+ * the cutoff range receive nothing, not even the signal as interference,
+ * so even with a cutoff below the receivers' sensitivity the results can
+ * differ from the default mode, where such signals still add to the noise
+ * of concurrent receptions.
+ * PHYs that move with a non-zero velocity are not indexed and are
+ * considered for every transmission.
+ *
+ * When the PairwiseCache attribute is enabled, the received power and the
+ * delay of every pair of PHYs are kept in a PairwisePropagationCache and
+ * only computed again after a course change of either PHY.  This requires
+ * deterministic propagation loss and delay models.
  */
 class YansWifiChannel : public Channel
 {
@@ -97,6 +129,15 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * The smallest propagation delay between two PHYs of the channel at
+   * their current positions.  As long as the nodes do not get closer,
+   * this is a valid lookahead for the MultithreadedSimulatorImpl.
+   *
+   * \return the minimum delay, or Time::Max () if the channel has less than two PHYs
+   */
+  Time GetMinDelay (void) const;
+
 
 private:
   /**
@@ -109,16 +150,110 @@ private:
    * The method then calls the corresponding YansWifiPhy that the first
    * bit of the packet has arrived.
    *
+   * All the receivers of a transmission share the same packet, which is
+   * only copied here, for the receivers above their sensitivity, since
+   * the PHY strips its headers and tags.
+   *
    * \param receiver the device to which the packet is destined
-   * \param packet the packet being sent
+   * \param packet the packet being sent, shared with the other receivers
    * \param txPowerDbm the tx power associated to the packet being sent (dBm)
    * \param duration the transmission duration associated with the packet being sent
    */
-  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double txPowerDbm, Time duration);
+  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<const Packet> packet, double txPowerDbm, Time duration);
+
+  /**
+   * Schedule the reception of a packet by the PHY at \p index of the PHY list.
+   *
+   * \param index the index of the receiver in m_phyList
+   * \param packet the packet to send
+   * \param rxPowerDbm the rx power of the packet at the receiver, in dBm
+   * \param delay the propagation delay to the receiver
+   * \param duration the transmission duration associated with the packet
+   */
+  void SendTo (uint32_t index, Ptr<const Packet> packet, double rxPowerDbm,
+               Time delay, Time duration) const;
+  /**
+   * Collect the indices of the PHYs which may receive a transmission from
+   * \p senderMobility, sorted in PHY list order.
+   *
+   * \param senderMobility the mobility model of the sender
+   * \param txPowerDbm the tx power associated to the packet, in dBm
+   * \param candidates the vector filled with PHY list indices
+   * \return false if every PHY has to be considered
+   */
+  bool GetCandidates (Ptr<MobilityModel> senderMobility, double txPowerDbm,
+                      std::vector<uint32_t> &candidates) const;
+  /**
+   * \param txPowerDbm the tx power, in dBm
+   * \return the distance beyond which no PHY is reached, or a negative value if unbounded
+   */
+  double GetCutoffRange (double txPowerDbm) const;
+  /// (Re)build the spatial index from the current PHY positions
+  void BuildIndex (void) const;
+  /**
+   * \param sender a PHY of the channel
+   * \return the index of \p sender in m_phyList, after building the pairwise cache if needed
+   */
+  uint32_t GetCacheIndex (Ptr<YansWifiPhy> sender) const;
+  /**
+   * Move the PHYs using \p mobility to the grid cell of their new position.
+   *
+   * \param mobility the mobility model whose course changed
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility) const;
+  /**
+   * \param position a position
+   * \return the key of the grid cell containing \p position
+   */
+  uint64_t GetCellKey (const Vector &position) const;
+  /**
+   * \param x the column of a grid cell
+   * \param y the row of a grid cell
+   * \return the key of the grid cell
+   */
+  static uint64_t GetCellKey (int64_t x, int64_t y);
+  /**
+   * Place the PHY at \p index either in the grid or in the mobile list.
+   *
+   * \param index the index of the PHY in m_phyList
+   */
+  void IndexPhy (uint32_t index) const;
+  /**
+   * Remove the PHY at \p index from the grid or the mobile list.
+   *
+   * \param index the index of the PHY in m_phyList
+   */
+  void UnindexPhy (uint32_t index) const;
 
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+
+  bool m_spatialIndex;                 //!< Whether Send uses the spatial index
+  double m_maxRange;                   //!< Fixed cutoff range (m), 0 to derive it from the loss model
+  double m_rxPowerCutoffDbm;           //!< Rx power below which a PHY is not considered (dBm)
+  bool m_pairwiseCache;                //!< Whether Send uses the pairwise cache
+
+  /// Spatial index state of a PHY
+  struct IndexEntry
+  {
+    Ptr<MobilityModel> mobility;       //!< Mobility model of the PHY, 0 if none
+    uint64_t cell;                     //!< Grid cell key
+    bool mobile;                       //!< Whether the PHY is in m_mobile instead of the grid
+  };
+  mutable bool m_indexBuilt;                                     //!< Whether the index matches m_phyList
+  mutable double m_cellSize;                                     //!< Grid cell edge (m)
+  mutable std::vector<IndexEntry> m_index;                       //!< Index state, one per PHY
+  mutable std::unordered_map<uint64_t, std::vector<uint32_t> > m_grid; //!< PHY indices per grid cell
+  mutable std::vector<uint32_t> m_mobile;                        //!< Indices of moving or unlocated PHYs
+  mutable std::map<const MobilityModel *, std::vector<uint32_t> > m_physByMobility; //!< PHY indices per mobility model
+  mutable std::map<double, double> m_cutoffRange;                //!< Cached cutoff range per tx power
+  mutable bool m_cacheBuilt;                                     //!< Whether m_cache matches m_phyList
+  mutable PairwisePropagationCache m_cache;                      //!< Rx power and delay per pair of PHYs
+  mutable std::unordered_map<const YansWifiPhy *, uint32_t> m_phyIndex; //!< Index of the PHYs in m_phyList
+#ifdef NS3_MTP
+  mutable SystemMutex m_indexMutex;                              //!< Serializes the index updates of concurrent senders
+#endif
 };
 
 } //namespace ns3
@@ -21,6 +21,8 @@
 #include <cmath>
 #include "ns3/test.h"
 #include "ns3/nist-error-rate-model.h"
+#include "ns3/yans-error-rate-model.h"
+#include "ns3/boolean.h"
 #include "ns3/dsss-error-rate-model.h"
 #include "ns3/wifi-tx-vector.h"
 
@@ -291,6 +293,84 @@ WifiErrorRateModelsTestCaseNist::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (ps, 0.999, 0.001, "Not equal within tolerance");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Wifi Error Rate Models Test Case Lookup Table
+ *
+ * Check the success rates interpolated in the lookup tables against
+ * the closed-form ones of the NIST and YANS models.
+ */
+class WifiErrorRateModelsTestCaseLookupTable : public TestCase
+{
+public:
+  WifiErrorRateModelsTestCaseLookupTable ();
+  virtual ~WifiErrorRateModelsTestCaseLookupTable ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Compare the two modes of a model.
+   *
+   * \param analytic the model computing the closed-form success rates
+   * \param table the model interpolating them
+   */
+  void Compare (Ptr<ErrorRateModel> analytic, Ptr<ErrorRateModel> table);
+};
+
+WifiErrorRateModelsTestCaseLookupTable::WifiErrorRateModelsTestCaseLookupTable ()
+  : TestCase ("WifiErrorRateModel test case lookup table")
+{
+}
+
+WifiErrorRateModelsTestCaseLookupTable::~WifiErrorRateModelsTestCaseLookupTable ()
+{
+}
+
+void
+WifiErrorRateModelsTestCaseLookupTable::Compare (Ptr<ErrorRateModel> analytic, Ptr<ErrorRateModel> table)
+{
+  table->SetAttribute ("UseLookupTable", BooleanValue (true));
+  const char *modes[] = {"OfdmRate6Mbps", "OfdmRate9Mbps", "OfdmRate12Mbps", "OfdmRate18Mbps",
+                         "OfdmRate24Mbps", "OfdmRate36Mbps", "OfdmRate48Mbps", "OfdmRate54Mbps",
+                         "HtMcs0", "HtMcs3", "HtMcs7", "VhtMcs8", "HeMcs11"};
+  // from the 24 bits of the L-SIG to the largest A-MPDU
+  uint64_t sizes[] = {24, 24 * 8, 1500 * 8, 65535 * 8};
+  for (const char *name : modes)
+    {
+      WifiMode mode (name);
+      WifiTxVector txVector;
+      txVector.SetMode (mode);
+      txVector.SetChannelWidth (20);
+      txVector.SetNss (1);
+      txVector.SetGuardInterval (800);
+      for (uint64_t nbits : sizes)
+        {
+          for (double snrDb = -10; snrDb < 45; snrDb += 0.0373)
+            {
+              double snr = std::pow (10.0, snrDb / 10.0);
+              double expected = analytic->GetChunkSuccessRate (mode, txVector, snr, nbits);
+              double actual = table->GetChunkSuccessRate (mode, txVector, snr, nbits);
+              // relative error when the chunk may be received, absolute otherwise
+              double tolerance = std::max (1e-3 * expected, 1e-5);
+              if (std::abs (actual - expected) > tolerance)
+                {
+                  NS_TEST_ASSERT_MSG_EQ_TOL (actual, expected, tolerance, "Wrong success rate for " << name
+                                             << " " << nbits << " bits at " << snrDb << " dB");
+                }
+            }
+        }
+    }
+}
+
+void
+WifiErrorRateModelsTestCaseLookupTable::DoRun (void)
+{
+  Compare (CreateObject<NistErrorRateModel> (), CreateObject<NistErrorRateModel> ());
+  Compare (CreateObject<YansErrorRateModel> (), CreateObject<YansErrorRateModel> ());
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -308,6 +388,7 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite ()
 {
   AddTestCase (new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
+  AddTestCase (new WifiErrorRateModelsTestCaseLookupTable, TestCase::QUICK);
 }
 
 static WifiErrorRateModelsTestSuite wifiErrorRateModelsTestSuite; ///< the test suite
@@ -46,6 +46,8 @@
 #include "ns3/mgt-headers.h"
 #include "ns3/ht-configuration.h"
 #include "ns3/wifi-phy-header.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 
 using namespace ns3;
 
@@ -2174,6 +2176,127 @@ Bug2470TestCase::DoRun (void)
   // but before it does not enter RESET state. More tests should be written to verify all possible scenarios.
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that the spatial index of YansWifiChannel only skips
+ * receivers out of range and follows course changes.
+ *
+ * Node 0 broadcasts at 1 s and 2 s.  Node 1 is 30 m away, node 2 starts
+ * 2000 m away and moves to 40 m at 1.5 s.
+ */
+class YansWifiChannelSpatialIndexTest : public TestCase
+{
+public:
+  YansWifiChannelSpatialIndexTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Run one configuration and fill m_rxBegin
+   * \param spatialIndex whether the spatial index is enabled
+   * \param maxRange the MaxRange attribute of the channel
+   */
+  void RunSubtest (bool spatialIndex, double maxRange);
+  /**
+   * Callback when a PHY starts receiving a packet
+   * \param context the node id
+   * \param p the packet
+   */
+  void RxBegin (std::string context, Ptr<const Packet> p);
+  /**
+   * Send a broadcast packet
+   * \param device the sending device
+   */
+  void SendOne (Ptr<NetDevice> device);
+
+  std::vector<uint32_t> m_rxBegin; ///< Number of receptions started per node
+};
+
+YansWifiChannelSpatialIndexTest::YansWifiChannelSpatialIndexTest ()
+  : TestCase ("Test case for the YansWifiChannel spatial index")
+{
+}
+
+void
+YansWifiChannelSpatialIndexTest::RxBegin (std::string context, Ptr<const Packet> p)
+{
+  m_rxBegin[std::stoi (context)]++;
+}
+
+void
+YansWifiChannelSpatialIndexTest::SendOne (Ptr<NetDevice> device)
+{
+  device->Send (Create<Packet> (100), Mac48Address::GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelSpatialIndexTest::RunSubtest (bool spatialIndex, double maxRange)
+{
+  m_rxBegin.assign (3, 0);
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  Ptr<YansWifiChannel> yansChannel = channel.Create ();
+  yansChannel->SetAttribute ("SpatialIndex", BooleanValue (spatialIndex));
+  yansChannel->SetAttribute ("MaxRange", DoubleValue (maxRange));
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (yansChannel);
+
+  WifiHelper wifi;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager");
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  // node 1 in a grid cell of negative coordinates
+  positionAlloc->Add (Vector (-30.0, -10.0, 0.0));
+  positionAlloc->Add (Vector (2000.0, 0.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (devices.Get (i));
+      device->GetPhy ()->TraceConnect ("PhyRxBegin", std::to_string (i),
+                                       MakeCallback (&YansWifiChannelSpatialIndexTest::RxBegin, this));
+    }
+
+  Simulator::Schedule (Seconds (1.0), &YansWifiChannelSpatialIndexTest::SendOne, this, devices.Get (0));
+  Simulator::Schedule (Seconds (1.5), &MobilityModel::SetPosition,
+                       nodes.Get (2)->GetObject<MobilityModel> (), Vector (40.0, 0.0, 0.0));
+  Simulator::Schedule (Seconds (2.0), &YansWifiChannelSpatialIndexTest::SendOne, this, devices.Get (0));
+  Simulator::Stop (Seconds (3.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+YansWifiChannelSpatialIndexTest::DoRun (void)
+{
+  RunSubtest (false, 0.0);
+  std::vector<uint32_t> reference = m_rxBegin;
+  NS_TEST_ASSERT_MSG_EQ (reference[1], 2, "Node 1 receives both packets");
+  NS_TEST_ASSERT_MSG_EQ (reference[2], 1, "Node 2 only receives once it moved closer");
+
+  // Range derived from the loss model and the default RxPowerCutoff
+  RunSubtest (true, 0.0);
+  NS_TEST_EXPECT_MSG_EQ (m_rxBegin[1], reference[1], "Same receptions as without spatial index");
+  NS_TEST_EXPECT_MSG_EQ (m_rxBegin[2], reference[2], "Course change updated the spatial index");
+
+  // Fixed range shorter than the distance to node 1
+  RunSubtest (true, 20.0);
+  NS_TEST_EXPECT_MSG_EQ (m_rxBegin[1], 0, "Node 1 is beyond MaxRange");
+  NS_TEST_EXPECT_MSG_EQ (m_rxBegin[2], 0, "Node 2 is beyond MaxRange");
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -2201,6 +2324,7 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug2831TestCase, TestCase::QUICK); //Bug 2831
   AddTestCase (new StaWifiMacScanningTestCase, TestCase::QUICK); //Bug 2399
   AddTestCase (new Bug2470TestCase, TestCase::QUICK); //Bug 2470
+  AddTestCase (new YansWifiChannelSpatialIndexTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite
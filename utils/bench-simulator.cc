@@ -205,6 +205,7 @@ int main (int argc, char *argv[])
 
   bool schedCal  = false;
   bool schedHeap = false;
+  bool schedLadder = false;
   bool schedList = false;
   bool schedMap  = true;
 
@@ -221,9 +222,17 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "A trace of a real run is recorded from the function log of\n"
+             "the DefaultSimulatorImpl, for example (times in s):\n"
+             "  NS_LOG=DefaultSimulatorImpl=level_function ./waf --run aodv_WH_3 2>&1 \\\n"
+             "    | sed -n -e 's/.*:Schedule(0x[0-9a-f]*, \\([0-9]*\\),.*/\\1/p' \\\n"
+             "             -e 's/.*:ScheduleWithContext(0x[0-9a-f]*, [0-9]*, \\([0-9]*\\),.*/\\1/p' \\\n"
+             "    | awk '{ printf \"%.9f\\n\", $1 / 1e9 }' > aodv-events.txt");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
@@ -245,6 +254,10 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::HeapScheduler");
     }
+  if (schedLadder)
+    {
+      factory.SetTypeId ("ns3::LadderScheduler");
+    }
   if (schedList)
     {
       factory.SetTypeId ("ns3::ListScheduler");
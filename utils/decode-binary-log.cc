@@ -0,0 +1,50 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <iostream>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+/**
+ * Print a file written by BinaryLog::Dump as text, one line per event:
+ *
+ *   decode-binary-log --input=aodv.binlog > aodv.log
+ */
+int
+main (int argc, char *argv[])
+{
+  std::string input;
+  CommandLine cmd;
+  cmd.Usage ("Decode a binary log written by BinaryLog::Dump into text.");
+  cmd.AddValue ("input", "The binary log file", input);
+  cmd.Parse (argc, argv);
+
+  std::ifstream in (input.c_str (), std::ios::binary);
+  if (!in.is_open ())
+    {
+      std::cerr << "cannot open \"" << input << "\"" << std::endl;
+      return 1;
+    }
+  if (!BinaryLog::Decode (in, std::cout))
+    {
+      std::cerr << "\"" << input << "\" is not a valid binary log" << std::endl;
+      return 1;
+    }
+  return 0;
+}